@@ -0,0 +1,168 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <chrono>
+#include <cmath>
+#include <random>
+
+// Single-token decode latency of SelfAttention at growing context lengths: every step projects one token,
+// appends it to the KV cache and attends over all cached positions. The float32 row is a plain
+// implementation of the same computation with a float KV cache, which also runs with the weights of each
+// packed layer to report the error of all its outputs.
+
+using namespace tensorless;
+
+#define DIM 64
+#define HEADS 4
+#define MAX_CONTEXT 1024
+
+// small enough that sfloat9 projections of 64 lanes stay within its range instead of clipping
+inline double inputValue(int position, int lane) {
+    return std::sin(position*31+lane)*0.2;
+}
+
+class Float32Attention {
+private:
+    std::vector<float> weights;  // query, key, value and output projections
+    std::vector<float> keys;
+    std::vector<float> values;
+public:
+    Float32Attention(): weights(4*DIM*DIM) {
+        std::uniform_real_distribution<float> distribution(-1, 1);
+        for(auto& weight : weights)
+            weight = distribution(generator);
+    }
+
+    template <typename Layer>
+    Float32Attention(const Layer &layer): weights(4*DIM*DIM) {
+        for(int m=0;m<4;++m)
+            for(int out=0;out<DIM;++out)
+                for(int in=0;in<DIM;++in)
+                    weights[(m*DIM+out)*DIM+in] = layer.weight(m, out, in);
+    }
+
+    void reset() {
+        keys.clear();
+        values.clear();
+    }
+
+    double forward(const float *input, float *out) {
+        float projected[3][DIM];
+        for(int m=0;m<3;++m)
+            for(int out=0;out<DIM;++out) {
+                const float *row = &weights[(m*DIM+out)*DIM];
+                float sum = 0;
+                #pragma omp simd reduction(+:sum)
+                for(int in=0;in<DIM;++in)
+                    sum += row[in]*input[in];
+                projected[m][out] = sum;
+            }
+        keys.insert(keys.end(), projected[1], projected[1]+DIM);
+        values.insert(values.end(), projected[2], projected[2]+DIM);
+        int positions = keys.size()/DIM;
+        int headDim = DIM/HEADS;
+        float attended[DIM] = {0};
+        std::vector<float> scores(positions);
+        for(int h=0;h<HEADS;++h) {
+            float max = -INFINITY;
+            for(int t=0;t<positions;++t) {
+                float sum = 0;
+                for(int j=h*headDim;j<(h+1)*headDim;++j)
+                    sum += projected[0][j]*keys[t*DIM+j];
+                scores[t] = sum/std::sqrt((float)headDim);
+                max = std::max(max, scores[t]);
+            }
+            float total = 0;
+            for(int t=0;t<positions;++t) {
+                scores[t] = std::exp(scores[t]-max);
+                total += scores[t];
+            }
+            for(int t=0;t<positions;++t)
+                for(int j=h*headDim;j<(h+1)*headDim;++j)
+                    attended[j] += scores[t]/total*values[t*DIM+j];
+        }
+        double ret = 0;
+        for(int i=0;i<DIM;++i) {
+            const float *row = &weights[(3*DIM+i)*DIM];
+            float sum = 0;
+            #pragma omp simd reduction(+:sum)
+            for(int in=0;in<DIM;++in)
+                sum += row[in]*attended[in];
+            out[i] = sum;
+            ret += sum;
+        }
+        return ret;
+    }
+};
+
+// microseconds per token of the decode steps that grow the context from context/2 to context
+template <typename Model, typename Step>
+void report(const char *type, Model &model, Step step) {
+    model.reset();
+    double checksum = 0;
+    int position = 0;
+    for(int context=16;context<=MAX_CONTEXT;context*=4) {
+        while(position<context/2)
+            checksum += step(position++);
+        auto start = std::chrono::steady_clock::now();
+        while(position<context)
+            checksum += step(position++);
+        auto end = std::chrono::steady_clock::now();
+        double micros = std::chrono::duration<double, std::micro>(end - start).count()/(context-context/2);
+        printf("%-10s context %5d  %10.2f us/token\n", type, context, micros);
+    }
+    if(checksum==1234.5678) // keeps the computation from being optimized away
+        std::cout << "";
+}
+
+// relative RMS error of all outputs over the decode steps that grow the context from context/2 to context
+template <typename T>
+void accuracy(const char *type, SelfAttention<T, DIM, HEADS> &attention, const std::vector<T> &inputs) {
+    Float32Attention reference(attention);
+    attention.reset();
+    double error = 0;
+    double norm = 0;
+    int position = 0;
+    for(int context=16;context<=MAX_CONTEXT;context*=4) {
+        for(;position<context;++position) {
+            float input[DIM];
+            float expected[DIM];
+            for(int lane=0;lane<DIM;++lane)
+                input[lane] = inputs[position].get(lane);
+            reference.forward(input, expected);
+            T output = attention.forward(inputs[position]);
+            if(position<context/2)
+                continue;
+            for(int i=0;i<DIM;++i) {
+                error += (output.get(i)-expected[i])*(output.get(i)-expected[i]);
+                norm += expected[i]*expected[i];
+            }
+        }
+        printf("%-10s context %5d  %10.4f relative error\n", type, context, std::sqrt(error/norm));
+        error = 0;
+        norm = 0;
+    }
+}
+
+template <typename T>
+void benchmark(const char *type) {
+    SelfAttention<T, DIM, HEADS> attention;
+    std::vector<T> inputs(MAX_CONTEXT);
+    for(int position=0;position<MAX_CONTEXT;++position)
+        for(int lane=0;lane<DIM;++lane)
+            inputs[position].set(lane, inputValue(position, lane));
+    report(type, attention, [&](int position) {return attention.forward(inputs[position]).get(0);});
+    accuracy(type, attention, inputs);
+}
+
+int main() {
+    std::cout << "SelfAttention<" << DIM << " dims, " << HEADS << " heads>, " << ThreadPool::global().size() << " threads\n";
+    benchmark<sfloat9>("sfloat9");
+    benchmark<dfloat10>("dfloat10");
+    Float32Attention reference;
+    std::vector<float> inputs(MAX_CONTEXT*DIM);
+    for(int position=0;position<MAX_CONTEXT;++position)
+        for(int lane=0;lane<DIM;++lane)
+            inputs[position*DIM+lane] = inputValue(position, lane);
+    float out[DIM];
+    report("float32", reference, [&](int position) {return reference.forward(&inputs[position*DIM], out);});
+}
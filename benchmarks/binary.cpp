@@ -0,0 +1,53 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <cmath>
+#include <chrono>
+
+using namespace tensorless;
+typedef float8 floatX; // change this to benchmark different datatypes
+
+template <typename Layer>
+double timeForward(Layer &layer, const std::vector<floatX> &inputs, int repeats) {
+    double checksum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int r=0;r<repeats;++r)
+        for(const auto &input : inputs)
+            checksum += layer.forward(input).get(0);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    if(checksum==1234.5678) // keeps the computation from being optimized away
+        std::cout << "";
+    return elapsed.count();
+}
+
+int main() {
+    int repeats = 20;
+    std::vector<floatX> inputs;
+    for(int i=0;i<100;++i) {
+        floatX input;
+        for(int j=0;j<64;++j) 
+            input.set(j, std::sin(i+j)*0.5);
+        inputs.push_back(input);
+    }
+
+    Dense<floatX, 64, 128> dense;
+    BinaryDense<floatX, 64, 128> binary;
+    TernaryDense<floatX, 64, 128> ternary;
+    double denseTime = timeForward(dense, inputs, repeats);
+    double binaryTime = timeForward(binary, inputs, repeats);
+    double ternaryTime = timeForward(ternary, inputs, repeats);
+    std::cout << "Dense:        " << denseTime << " seconds\n";
+    std::cout << "BinaryDense:  " << binaryTime << " seconds (" << denseTime/binaryTime << "x)\n";
+    std::cout << "TernaryDense: " << ternaryTime << " seconds (" << denseTime/ternaryTime << "x)\n";
+
+    // binary layers can also be chained directly on sign masks, without converting through tensors
+    VECTOR signs = 0;
+    long N = 100000;
+    auto start = std::chrono::high_resolution_clock::now();
+    for(long i=0;i<N;++i)
+        signs = binary.forwardSigns(signs ^ (VECTOR)i);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << "BinaryDense on sign masks: " << elapsed.count()/N*inputs.size()*repeats << " seconds for the same number of samples"
+              << " (" << denseTime/(elapsed.count()/N*inputs.size()*repeats) << "x)" << (ANY(signs)?"":" ") << "\n";
+}
@@ -0,0 +1,116 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+using namespace tensorless;
+typedef float8 floatX; // change this to benchmark different datatypes
+
+// floatX with the hand-written copy constructor and self-checking assignment the packed types used to have,
+// which makes it non-trivially copyable
+class HandwrittenCopies {
+private:
+    floatX value;
+public:
+    HandwrittenCopies() {}
+    HandwrittenCopies(const floatX &value) : value(value) {}
+    HandwrittenCopies(const HandwrittenCopies &other) : value(other.value) {}
+    HandwrittenCopies& operator=(const HandwrittenCopies &other) {
+        if (this != &other)
+            value = other.value;
+        return *this;
+    }
+    const floatX& get() const {return value;}
+};
+
+// a floatX tensor with the same hand-written copies, so that layers can run on it; every operation still
+// returns a floatX, which is converted back through the hand-written constructor
+class HandwrittenTensor: public floatX {
+public:
+    HandwrittenTensor() {}
+    HandwrittenTensor(const floatX &value) : floatX(value) {}
+    HandwrittenTensor(const HandwrittenTensor &other) : floatX(other) {}
+    HandwrittenTensor& operator=(const HandwrittenTensor &other) {
+        if (this != &other)
+            floatX::operator=(other);
+        return *this;
+    }
+};
+
+template <typename T>
+double timeCopies(const std::vector<T> &source, int repeats) {
+    double checksum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int r=0;r<repeats;++r) {
+        std::vector<T> copy = source;
+        checksum += copy.size();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    if(checksum==1234.5678) // keeps the computation from being optimized away
+        std::cout << "";
+    return elapsed.count();
+}
+
+// growing a vector relocates its elements, which is a memmove only for trivially copyable types
+template <typename T>
+double timeGrowth(const floatX &element, int count, int repeats) {
+    double checksum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int r=0;r<repeats;++r) {
+        std::vector<T> grown;
+        for(int i=0;i<count;++i)
+            grown.push_back(element);
+        checksum += grown.size();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    if(checksum==1234.5678)
+        std::cout << "";
+    return elapsed.count();
+}
+
+// every layer call returns and assigns tensors by value
+template <typename T>
+double timeForward(int forwards) {
+    auto arch = Layered<T>()
+                .add(std::make_shared<Dense<T, 64, 64>>())
+                .add(std::make_shared<Dense<T, 64, 64>>());
+    T input;
+    for(int i=0;i<64;++i)
+        input.set(i, std::sin(i)*0.5);
+    double checksum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int i=0;i<forwards;++i)
+        checksum += arch.forward(input).get(0);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    if(checksum==1234.5678)
+        std::cout << "";
+    return elapsed.count()/forwards;
+}
+
+int main() {
+    int count = 4096;
+    int repeats = 2000;
+    std::cout << "Trivially copyable: " << std::is_trivially_copyable<floatX>::value << "\n";
+
+    floatX element = floatX::random();
+    std::vector<floatX> packed(count, element);
+    std::vector<HandwrittenCopies> handwritten(count, HandwrittenCopies(element));
+    double packedCopy = timeCopies(packed, repeats);
+    double handwrittenCopy = timeCopies(handwritten, repeats);
+    std::cout << "vector copy    trivial: " << packedCopy << " seconds, hand-written: " << handwrittenCopy
+              << " seconds (" << handwrittenCopy/packedCopy << "x)\n";
+
+    double packedGrowth = timeGrowth<floatX>(element, count, repeats/10);
+    double handwrittenGrowth = timeGrowth<HandwrittenCopies>(element, count, repeats/10);
+    std::cout << "vector growth  trivial: " << packedGrowth << " seconds, hand-written: " << handwrittenGrowth
+              << " seconds (" << handwrittenGrowth/packedGrowth << "x)\n";
+
+    double packedForward = timeForward<floatX>(2000);
+    double handwrittenForward = timeForward<HandwrittenTensor>(2000);
+    std::cout << "Layered::forward trivial: " << packedForward*1.E6 << " us, hand-written: " << handwrittenForward*1.E6
+              << " us per call (" << handwrittenForward/packedForward << "x)\n";
+}
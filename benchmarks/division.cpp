@@ -0,0 +1,47 @@
+#include "../tensorless/types/all.h"
+#include <cmath>
+#include <chrono>
+
+using namespace tensorless;
+typedef sfloat9 floatX; // change this to benchmark different datatypes
+
+int main() {
+    long N = 100000;
+
+    auto data1 = floatX::random();
+    auto data2 = floatX::random();
+    int size = data1.size();
+    std::cout<<"Data size "<<size<<"\n";
+
+    double res0 = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for(long i=0;i<N;++i) {
+        res0 += (data1/data2).sum();
+        res0 += data1.sqrt().sum();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << "Time taken for "<<N<<" cpu-parallel vector divisions and square roots: " << elapsed.count() << " seconds\n";
+
+    double res1 = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for(long i=0;i<N;++i) {
+        // unpack, compute and repack every lane
+        floatX quotient;
+        floatX root;
+        for(int j=0;j<size;++j) {
+            double divisor = data2.get(j);
+            double ratio = divisor==0 ? floatX::sup() : data1.get(j)/divisor;
+            quotient.set(j, std::max(floatX::inf(), std::min(floatX::sup(), ratio)));
+            double value = data1.get(j);
+            root.set(j, value<0 ? 0 : std::sqrt(value));
+        }
+        res1 += quotient.sum();
+        res1 += root.sum();
+    }
+    end = std::chrono::high_resolution_clock::now();
+    elapsed = end - start;
+    std::cout << "Time taken for "<<N<<" scalar unpack-compute-repack divisions and square roots: " << elapsed.count() << " seconds\n";
+
+    std::cout << res0/N/size<<" "<<res1/N/size<<"\n";
+}
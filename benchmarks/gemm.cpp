@@ -0,0 +1,85 @@
+#include "../tensorless/types/all.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <omp.h>
+
+// Matrix products C = A*B^T of ROWS x COLS matrices, in GOPS (two operations per multiply-add) for the
+// cache-blocked plane-pair GEMM and for a naive loop over packed operator* and sum(). Errors are the largest
+// absolute differences from the double-precision product of the stored values.
+
+using namespace tensorless;
+
+#define ROWS 256
+#define COLS 1024
+#define REPEATS 3
+
+template <typename T>
+std::vector<double> naive(const PackedMatrix<T> &a, const PackedMatrix<T> &b) {
+    std::vector<double> out((size_t)a.rows()*b.rows());
+    #pragma omp parallel for schedule(static)
+    for(int i=0;i<a.rows();++i)
+        for(int j=0;j<b.rows();++j) {
+            double sum = 0;
+            for(int k=0;k<a.blocks();++k)
+                sum += (a.block(i, k)*b.block(j, k)).sum();
+            out[(size_t)i*b.rows()+j] = sum;
+        }
+    return out;
+}
+
+template <typename T>
+std::vector<double> reference(const PackedMatrix<T> &a, const PackedMatrix<T> &b) {
+    std::vector<double> out((size_t)a.rows()*b.rows());
+    for(int i=0;i<a.rows();++i)
+        for(int j=0;j<b.rows();++j) {
+            double sum = 0;
+            for(int k=0;k<a.cols();++k)
+                sum += a.get(i, k)*b.get(j, k);
+            out[(size_t)i*b.rows()+j] = sum;
+        }
+    return out;
+}
+
+double maxError(const std::vector<double> &values, const std::vector<double> &expected) {
+    double ret = 0;
+    for(size_t i=0;i<values.size();++i)
+        ret = std::max(ret, std::abs(values[i]-expected[i]));
+    return ret;
+}
+
+template <typename Function>
+double bestSeconds(const Function &function, std::vector<double> &out) {
+    double best = INFINITY;
+    for(int repeat=0;repeat<REPEATS;++repeat) {
+        auto start = std::chrono::steady_clock::now();
+        out = function();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+    return best;
+}
+
+template <typename T>
+void benchmark(const char *type) {
+    PackedMatrix<T> a = PackedMatrix<T>::random(ROWS, COLS);
+    PackedMatrix<T> b = PackedMatrix<T>::random(ROWS, COLS);
+    std::vector<double> expected = reference(a, b);
+    std::vector<double> blocked, loop;
+    double blockedSeconds = bestSeconds([&]() {return gemm(a, b);}, blocked);
+    double loopSeconds = bestSeconds([&]() {return naive(a, b);}, loop);
+    double ops = 2.0*ROWS*ROWS*COLS;
+    printf("%-9s gemm %8.3f GOPS (error %.2e)   naive %8.3f GOPS (error %.2e)   %6.1fx\n", type,
+           ops/blockedSeconds/1.E9, maxError(blocked, expected), ops/loopSeconds/1.E9, maxError(loop, expected),
+           loopSeconds/blockedSeconds);
+}
+
+int main() {
+    std::cout << ROWS << "x" << COLS << " times " << COLS << "x" << ROWS << " on " << omp_get_max_threads() << " threads\n";
+    benchmark<int3>("int3");
+    benchmark<int5>("int5");
+    benchmark<sfloat5>("sfloat5");
+    benchmark<sfloat9>("sfloat9");
+    benchmark<dfloat6>("dfloat6");
+    benchmark<dfloat10>("dfloat10");
+}
@@ -0,0 +1,154 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include "../tensorless/types/fixed.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <omp.h>
+
+// End-to-end inference of DEPTH-layer relu MLPs of several widths. For every type this reports the model
+// footprint, the single-thread latency per sample (median over REPEATS passes), and the throughput when
+// samples are split among 1, 2, 4, ... up to OMP_NUM_THREADS threads, each running its own model replica.
+// The float32 row is a plain GEMV reference with a vectorizable inner loop.
+
+using namespace tensorless;
+
+#define DEPTH 3
+#define SAMPLES 256
+#define REPEATS 5
+
+inline double inputValue(int sample, int lane) {
+    return std::sin(sample*31+lane)*0.5;
+}
+
+template <typename T, int width>
+class TensorlessMLP {
+private:
+    Layered<T> model;
+    std::vector<T> inputs;
+public:
+    TensorlessMLP() {
+        for(int i=0;i<DEPTH;++i)
+            model.add(std::make_shared<Dense<T, width, width>>());
+        for(int sample=0;sample<SAMPLES;++sample) {
+            T input;
+            for(int lane=0;lane<width;++lane)
+                input.set(lane, inputValue(sample, lane));
+            inputs.push_back(input);
+        }
+    }
+
+    static size_t bytes() {
+        return DEPTH*sizeof(Dense<T, width, width>);
+    }
+
+    double forward(int sample) {
+        return model.forward(inputs[sample]).get(0);
+    }
+};
+
+template <int width>
+class Float32MLP {
+private:
+    std::vector<float> weights;
+    std::vector<float> biases;
+    std::vector<float> inputs;
+public:
+    Float32MLP(): weights(DEPTH*width*width), biases(DEPTH*width, 0), inputs(SAMPLES*width) {
+        std::uniform_real_distribution<float> distribution(-1, 1);
+        for(auto& weight : weights)
+            weight = distribution(generator);
+        for(int sample=0;sample<SAMPLES;++sample)
+            for(int lane=0;lane<width;++lane)
+                inputs[sample*width+lane] = inputValue(sample, lane);
+    }
+
+    static size_t bytes() {
+        return (DEPTH*width*width+DEPTH*width)*sizeof(float);
+    }
+
+    double forward(int sample) {
+        float activations[width];
+        float next[width];
+        std::copy(&inputs[sample*width], &inputs[sample*width]+width, activations);
+        for(int layer=0;layer<DEPTH;++layer) {
+            const float *layerWeights = &weights[layer*width*width];
+            for(int out=0;out<width;++out) {
+                const float *row = layerWeights+out*width;
+                float sum = biases[layer*width+out];
+                #pragma omp simd reduction(+:sum)
+                for(int in=0;in<width;++in)
+                    sum += row[in]*activations[in];
+                next[out] = sum>0 ? sum : 0;
+            }
+            std::copy(next, next+width, activations);
+        }
+        return activations[0];
+    }
+};
+
+// per-sample time on the calling core alone, so that Dense layers do not spread over the thread pool
+template <typename Model>
+double latency(Model &model, double &checksum) {
+    ThreadPool::Sequential sequential;
+    std::vector<double> times;
+    for(int repeat=0;repeat<REPEATS;++repeat) {
+        auto start = std::chrono::steady_clock::now();
+        for(int sample=0;sample<SAMPLES;++sample)
+            checksum += model.forward(sample);
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double>(end - start).count()/SAMPLES);
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size()/2];
+}
+
+// samples per second when REPEATS passes over the samples are split among threads
+template <typename Model>
+double throughput(int threads, double &checksum) {
+    std::vector<Model> replicas(threads);
+    double sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    #pragma omp parallel for num_threads(threads) schedule(static) reduction(+:sum)
+    for(int i=0;i<SAMPLES*REPEATS;++i)
+        sum += replicas[omp_get_thread_num()].forward(i%SAMPLES);
+    auto end = std::chrono::steady_clock::now();
+    checksum += sum;
+    return SAMPLES*REPEATS/std::chrono::duration<double>(end - start).count();
+}
+
+template <typename Model>
+void benchmark(const char *type, int width) {
+    double checksum = 0;
+    Model model;
+    double seconds = latency(model, checksum);
+    printf("%-16s width %3d  %8zu bytes  %9.2f us/sample  %10.0f samples/s per core\n",
+           type, width, Model::bytes(), seconds*1.E6, 1/seconds);
+    std::vector<int> threadCounts;
+    for(int threads=1;threads<omp_get_max_threads();threads*=2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(omp_get_max_threads());
+    for(int threads : threadCounts) {
+        double rate = throughput<Model>(threads, checksum);
+        printf("%-16s   %3d threads  %10.0f samples/s  %10.0f samples/s per core\n", "", threads, rate, rate/threads);
+    }
+    if(checksum==1234.5678) // keeps the computation from being optimized away
+        std::cout << "";
+}
+
+template <int width>
+void benchmarkWidth() {
+    benchmark<TensorlessMLP<float8, width>>("float8", width);
+    benchmark<TensorlessMLP<dfloat8, width>>("dfloat8", width);
+    benchmark<TensorlessMLP<sfloat9, width>>("sfloat9", width);
+    benchmark<TensorlessMLP<Fixed<float, 128>, width>>("Fixed<float,128>", width);
+    benchmark<Float32MLP<width>>("float32 GEMV", width);
+}
+
+int main() {
+    std::cout << DEPTH << "-layer MLPs, " << omp_get_max_threads() << " threads available (OMP_NUM_THREADS)\n";
+    benchmarkWidth<32>();
+    benchmarkWidth<64>();
+    benchmarkWidth<128>();
+}
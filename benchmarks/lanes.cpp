@@ -0,0 +1,71 @@
+#include "../tensorless/types/all.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+// Cross-lane movements of lanes.h against the get/set loops they replace, in nanoseconds per call.
+
+using namespace tensorless;
+typedef sfloat9 floatX; // change this to benchmark different datatypes
+
+#define REPEATS 20000
+
+double timeCall(const std::function<floatX(const floatX&)> &call, const floatX &input) {
+    floatX value = input;
+    double checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(int i=0;i<REPEATS;++i) {
+        value = call(value);
+        checksum += value.get(i%value.size());
+    }
+    auto end = std::chrono::steady_clock::now();
+    if(checksum==1234.5678) // keeps the computation from being optimized away
+        std::cout << "";
+    return std::chrono::duration<double, std::nano>(end - start).count()/REPEATS;
+}
+
+void compare(const char *name, const std::function<floatX(const floatX&)> &packed,
+             const std::function<floatX(const floatX&)> &loop, const floatX &input) {
+    double packedTime = timeCall(packed, input);
+    double loopTime = timeCall(loop, input);
+    printf("%-12s %9.1f ns packed %9.1f ns get/set (%.1fx)\n", name, packedTime, loopTime, loopTime/packedTime);
+}
+
+int main() {
+    floatX input = floatX::random();
+    int lanes = input.size();
+    std::vector<int> source(lanes);
+    for(int i=0;i<lanes;++i)
+        source[i] = i;
+    std::shuffle(source.begin(), source.end(), generator);
+    LanePermutation permutation(source);
+    std::cout << lanes << " lanes, random permutation in " << permutation.num_stages() << " delta swaps per plane\n";
+
+    compare("shift", [](const floatX &x) {return shift_lanes(x, 3);}, [lanes](const floatX &x) {
+        floatX ret;
+        for(int i=3;i<lanes;++i)
+            ret.set(i, x.get(i-3));
+        return ret;
+    }, input);
+    compare("rotate", [](const floatX &x) {return rotate_lanes(x, 5);}, [lanes](const floatX &x) {
+        floatX ret;
+        for(int i=0;i<lanes;++i)
+            ret.set(i, x.get((i-5+lanes)%lanes));
+        return ret;
+    }, input);
+    compare("reverse", [](const floatX &x) {return reverse_lanes(x);}, [lanes](const floatX &x) {
+        floatX ret;
+        for(int i=0;i<lanes;++i)
+            ret.set(i, x.get(lanes-1-i));
+        return ret;
+    }, input);
+    compare("splat", [](const floatX &x) {return splat_lane(x, 7);}, [](const floatX &x) {
+        return floatX::broadcast(x.get(7));
+    }, input);
+    compare("permute", [&permutation](const floatX &x) {return permutation(x);}, [&source, lanes](const floatX &x) {
+        floatX ret;
+        for(int i=0;i<lanes;++i)
+            ret.set(i, x.get(source[i]));
+        return ret;
+    }, input);
+}
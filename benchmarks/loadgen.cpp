@@ -0,0 +1,102 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include "../tensorless/serving/server.h"
+#include <cstring>
+#include <memory>
+#include <unistd.h>
+
+// Closed-loop load generator for the inference server of examples/server.cpp: each connection sends a request,
+// waits for its response and repeats, and the client reports throughput and p50/p99 round-trip latencies.
+// Without --socket it starts a server on a temporary socket in this process, so that batching settings can be
+// compared without a separate server.
+//   --socket PATH       server to load
+//   --connections N     concurrent clients (default 8)
+//   --seconds S         duration of the run
+//   --lanes N           values per request (default 64)
+//   --max-batch N, --max-wait-us N, --workers N   settings of the in-process server
+
+using namespace tensorless;
+typedef float8 TYPE;
+
+int main(int argc, char **argv) {
+    std::string socket;
+    int connections = 8, lanes = 64, workers = 0, maxBatch = 16, maxWait = 200;
+    double seconds = 2;
+    for(int i=1;i<argc;++i) {
+        if(!strcmp(argv[i], "--socket") && i+1<argc)
+            socket = argv[++i];
+        else if(!strcmp(argv[i], "--connections") && i+1<argc)
+            connections = std::max(1, atoi(argv[++i]));
+        else if(!strcmp(argv[i], "--seconds") && i+1<argc)
+            seconds = atof(argv[++i]);
+        else if(!strcmp(argv[i], "--lanes") && i+1<argc)
+            lanes = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "--workers") && i+1<argc)
+            workers = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "--max-batch") && i+1<argc)
+            maxBatch = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "--max-wait-us") && i+1<argc)
+            maxWait = atoi(argv[++i]);
+        else {
+            std::cerr << "usage: " << argv[0] << " [--socket PATH] [--connections N] [--seconds S] [--lanes N]"
+                      << " [--max-batch N] [--max-wait-us N] [--workers N]\n";
+            return 1;
+        }
+    }
+
+    std::unique_ptr<InferenceServer<TYPE>> server;
+    if(socket.empty()) {
+        socket = "/tmp/tensorless-loadgen-" + std::to_string(getpid()) + ".sock";
+        server.reset(new InferenceServer<TYPE>(socket, []() {
+            auto model = std::make_shared<Layered<TYPE>>();
+            model->add(std::make_shared<Dense<TYPE, 64, 64>>())
+                  .add(std::make_shared<Dense<TYPE, 64, 64>>())
+                  .add(std::make_shared<Dense<TYPE, 64, 64>>());
+            return std::static_pointer_cast<Neural<TYPE>>(model);
+        }, workers, maxBatch, maxWait));
+        server->start();
+        std::cout << "In-process server: max batch " << maxBatch << ", max wait " << maxWait << " us\n";
+    }
+
+    std::vector<std::vector<double>> latencies(connections);
+    std::atomic<int> failures(0);
+    auto start = std::chrono::steady_clock::now();
+    auto end = start+std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    std::vector<std::thread> clients;
+    for(int c=0;c<connections;++c)
+        clients.emplace_back([&, c]() {
+            int fd = connectSocket(socket);
+            if(fd<0) {
+                failures++;
+                return;
+            }
+            std::vector<float> request(lanes), response;
+            uint64_t id = 0, answered;
+            while(std::chrono::steady_clock::now()<end) {
+                for(int lane=0;lane<lanes;++lane)
+                    request[lane] = std::sin(id*31+lane+c)*0.5;
+                auto sent = std::chrono::steady_clock::now();
+                if(!writeMessage(fd, id, request) || !readMessage(fd, answered, response) || answered!=id) {
+                    failures++;
+                    break;
+                }
+                latencies[c].push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now()-sent).count());
+                id++;
+            }
+            ::close(fd);
+        });
+    for(auto& client : clients)
+        client.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+    std::vector<double> all;
+    for(auto& samples : latencies)
+        all.insert(all.end(), samples.begin(), samples.end());
+    printf("%d connections: %.0f requests/s, round trip p50 %.1f us, p99 %.1f us%s\n", connections, all.size()/elapsed,
+           quantile(all, 0.5), quantile(all, 0.99), failures ? " (some connections failed)" : "");
+    if(server) {
+        server->stop();
+        std::cout << "Server: " << server->stats().describe() << "\n";
+    }
+    return failures ? 1 : 0;
+}
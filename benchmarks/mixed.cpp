@@ -0,0 +1,41 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <cmath>
+#include <chrono>
+
+using namespace tensorless;
+typedef sfloat9 actX; // change these to benchmark different datatypes
+typedef sfloat5 weightX;
+
+template <typename Layer>
+double timeForward(Layer &layer, const std::vector<actX> &inputs, int repeats) {
+    double checksum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int r=0;r<repeats;++r)
+        for(const auto &input : inputs)
+            checksum += layer.forward(input).get(0);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    if(checksum==1234.5678) // keeps the computation from being optimized away
+        std::cout << "";
+    return elapsed.count();
+}
+
+int main() {
+    int repeats = 20;
+    std::vector<actX> inputs;
+    for(int i=0;i<100;++i) {
+        actX input;
+        for(int j=0;j<64;++j) 
+            input.set(j, std::sin(i+j)*0.5);
+        inputs.push_back(input);
+    }
+
+    Dense<actX, 64, 128> dense;
+    MixedDense<weightX, actX, 64, 128> mixed;
+    std::cout << dense << mixed;
+    double denseTime = timeForward(dense, inputs, repeats);
+    double mixedTime = timeForward(mixed, inputs, repeats);
+    std::cout << "Dense:      " << denseTime << " seconds\n";
+    std::cout << "MixedDense: " << mixedTime << " seconds (" << denseTime/mixedTime << "x)\n";
+}
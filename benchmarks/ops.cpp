@@ -0,0 +1,174 @@
+#include "../tensorless/types/all.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// Microbenchmarks of every packed typedef. Each operation runs in batches of BATCH calls; after WARMUP
+// untimed batches, REPETITIONS timed batches give the median and p99 cost per call and lanes processed
+// per nanosecond. Arguments:
+//   --json          print one JSON object per type and operation instead of a table
+//   --type NAME     only benchmark the typedef NAME
+//   --reps N        number of timed batches
+// Compile with -DBENCH_TYPE=sfloat9 to build the benchmark of a single type.
+
+using namespace tensorless;
+
+#define BATCH 256
+#define WARMUP 10
+#define REPETITIONS 101
+
+// hide values from the optimizer so that loop-invariant operations are not hoisted or removed
+template <typename T>
+inline void escape(T &value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+template <typename T, typename = void>
+struct hasTwosComplement : std::false_type {};
+template <typename T>
+struct hasTwosComplement<T, decltype(void(std::declval<const T&>().twosComplement()))> : std::true_type {};
+
+// types with per-lane or per-vector scales, whose additions first realign operands
+template <typename T>
+struct isScaled : std::false_type {};
+template <typename Number, typename Mantisa>
+struct isScaled<Floating<Number, Mantisa>> : std::true_type {};
+template <typename Number>
+struct isScaled<Dynamic<Number>> : std::true_type {};
+
+struct Options {
+    bool json = false;
+    std::string type;
+    int repetitions = REPETITIONS;
+};
+
+struct Result {
+    double median;
+    double p99;
+};
+
+Result measure(const std::function<void()> &batch, int repetitions) {
+    for(int i=0;i<WARMUP;++i)
+        batch();
+    std::vector<double> samples;
+    for(int i=0;i<repetitions;++i) {
+        auto start = std::chrono::steady_clock::now();
+        batch();
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(end - start).count()/BATCH);
+    }
+    std::sort(samples.begin(), samples.end());
+    Result result;
+    result.median = samples[samples.size()/2];
+    result.p99 = samples[std::min(samples.size()-1, (size_t)std::ceil(samples.size()*0.99)-1)];
+    return result;
+}
+
+void report(const Options &options, const char *type, const char *op, int lanes, const Result &result) {
+    if(options.json)
+        std::cout << "{\"type\": \"" << type << "\", \"op\": \"" << op << "\", \"lanes\": " << lanes
+                  << ", \"median_ns\": " << result.median << ", \"p99_ns\": " << result.p99
+                  << ", \"lanes_per_ns\": " << lanes/result.median << "}\n";
+    else
+        printf("%-9s %-15s %10.2f ns/op %10.2f ns p99 %8.2f lanes/ns\n",
+               type, op, result.median, result.p99, lanes/result.median);
+}
+
+template <typename T>
+void benchmark(const Options &options, const char *type) {
+    if(options.type.size() && options.type!=type)
+        return;
+    T a = T::random();
+    T b = T::random();
+    T mixed;  // magnitudes spread over several octaves so that additions with it realign exponents
+    for(int i=0;i<a.size();++i)
+        mixed.set(i, std::sin(i)*std::pow(2.0, -(i%4)));
+    T c;
+    double total = 0;
+    int lanes = a.size();
+    int reps = options.repetitions;
+
+    report(options, type, "add", lanes, measure([&]() {
+        for(int i=0;i<BATCH;++i) {escape(a); c = a+b; escape(c);}
+    }, reps));
+    report(options, type, "sub", lanes, measure([&]() {
+        for(int i=0;i<BATCH;++i) {escape(a); c = a-b; escape(c);}
+    }, reps));
+    report(options, type, "mul", lanes, measure([&]() {
+        for(int i=0;i<BATCH;++i) {escape(a); c = a*b; escape(c);}
+    }, reps));
+    report(options, type, "sum", lanes, measure([&]() {
+        for(int i=0;i<BATCH;++i) {escape(a); total += a.sum();}
+    }, reps));
+    report(options, type, "set", 1, measure([&]() {
+        for(int i=0;i<BATCH;++i) {c.set(i%lanes, 0.25); escape(c);}
+    }, reps));
+    report(options, type, "get", 1, measure([&]() {
+        for(int i=0;i<BATCH;++i) {escape(a); total += a.get(i%lanes);}
+    }, reps));
+    report(options, type, "broadcast", lanes, measure([&]() {
+        for(int i=0;i<BATCH;++i) {c = T::broadcast(0.25); escape(c);}
+    }, reps));
+    if constexpr(hasTwosComplement<T>::value)
+        report(options, type, "twosComplement", lanes, measure([&]() {
+            for(int i=0;i<BATCH;++i) {escape(a); c = a.twosComplement(); escape(c);}
+        }, reps));
+    if constexpr(isScaled<T>::value)
+        report(options, type, "realign", lanes, measure([&]() {
+            for(int i=0;i<BATCH;++i) {escape(a); c = a+mixed; escape(c);}
+        }, reps));
+    escape(total);
+}
+
+#define NAME(T) #T
+#define BENCHMARK(T) benchmark<T>(options, NAME(T))
+
+int main(int argc, char **argv) {
+    Options options;
+    for(int i=1;i<argc;++i) {
+        if(!strcmp(argv[i], "--json"))
+            options.json = true;
+        else if(!strcmp(argv[i], "--type") && i+1<argc)
+            options.type = argv[++i];
+        else if(!strcmp(argv[i], "--reps") && i+1<argc)
+            options.repetitions = std::max(1, atoi(argv[++i]));
+        else {
+            std::cerr << "usage: " << argv[0] << " [--json] [--type NAME] [--reps N]\n";
+            return 1;
+        }
+    }
+
+    #ifdef BENCH_TYPE
+    BENCHMARK(BENCH_TYPE);
+    #else
+    BENCHMARK(int3);
+    BENCHMARK(int4);
+    BENCHMARK(int5);
+    BENCHMARK(sfloat4);
+    BENCHMARK(sfloat5);
+    BENCHMARK(sfloat6);
+    BENCHMARK(sfloat7);
+    BENCHMARK(sfloat8);
+    BENCHMARK(sfloat9);
+    BENCHMARK(dfloat5);
+    BENCHMARK(dfloat6);
+    BENCHMARK(dfloat7);
+    BENCHMARK(dfloat8);
+    BENCHMARK(dfloat9);
+    BENCHMARK(dfloat10);
+    BENCHMARK(float7);
+    BENCHMARK(float8);
+    BENCHMARK(float9);
+    BENCHMARK(float10);
+    BENCHMARK(float11);
+    BENCHMARK(float12);
+    BENCHMARK(float13);
+    BENCHMARK(float14);
+    BENCHMARK(float15);
+    #endif
+}
@@ -0,0 +1,52 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <chrono>
+#include <memory>
+#include <omp.h>
+
+// Streaming inference through a deep and narrow relu MLP: samples per second of sequential Layered forward passes
+// against a Pipeline with 1, 2, 4, ... stages, up to OMP_NUM_THREADS (or TENSORLESS_THREADS).
+
+using namespace tensorless;
+typedef float8 floatX; // change this to benchmark different datatypes
+
+#define DEPTH 8
+#define WIDTH 64
+#define SAMPLES 512
+
+int main() {
+    auto model = Layered<floatX>();
+    for(int i=0;i<DEPTH;++i)
+        model.add(std::make_shared<Dense<floatX, WIDTH, WIDTH>>());
+    std::vector<floatX> inputs(SAMPLES);
+    for(int sample=0;sample<SAMPLES;++sample)
+        for(int lane=0;lane<WIDTH;++lane)
+            inputs[sample].set(lane, std::sin(sample*31+lane)*0.5);
+
+    std::vector<floatX> expected(SAMPLES);
+    auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool::Sequential sequential; // a single core, like each pipeline stage, so that speedups come from pipelining alone
+        for(int sample=0;sample<SAMPLES;++sample)
+            expected[sample] = model.forward(inputs[sample]);
+    }
+    double sequential = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    printf("sequential      %10.0f samples/s\n", SAMPLES/sequential);
+
+    int threads = ThreadPool::global().size();
+    for(int stages=1;;stages=std::min(2*stages, threads)) {
+        Pipeline<floatX> pipeline(model, stages);
+        pipeline.run(inputs); // warm up the stage threads
+        start = std::chrono::steady_clock::now();
+        std::vector<floatX> outputs = pipeline.run(inputs);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        int mismatches = 0;
+        for(int sample=0;sample<SAMPLES;++sample)
+            for(int lane=0;lane<WIDTH;++lane)
+                mismatches += outputs[sample].get(lane)!=expected[sample].get(lane);
+        printf("%2d stages       %10.0f samples/s  %6.2fx  (%d mismatching lanes)\n%s", pipeline.num_stages(),
+               SAMPLES/seconds, sequential/seconds, mismatches, pipeline.describe().c_str());
+        if(stages>=threads)
+            break;
+    }
+}
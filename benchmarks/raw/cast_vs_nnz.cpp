@@ -1,6 +1,6 @@
 #include <iostream>
 #include <chrono>
-#include "../tensorless/types/all.h"
+#include "../../tensorless/types/all.h"
 
 // Define the functions using #define
 #define INT_TO_BOOL(n) ((bool)(n))
@@ -0,0 +1,56 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <cmath>
+#include <chrono>
+
+using namespace tensorless;
+typedef dfloat9 floatX; // change this to benchmark different datatypes
+
+template <typename Layer>
+double timeForward(Layer &layer, const std::vector<floatX> &inputs, int repeats) {
+    double checksum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int r=0;r<repeats;++r)
+        for(const auto &input : inputs)
+            checksum += layer.forward(input).sum();
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    if(checksum==1234.5678) // keeps the computation from being optimized away
+        std::cout << "";
+    return elapsed.count();
+}
+
+void compare(const std::string &name, const std::vector<floatX> &inputs, int repeats) {
+    Dense<floatX, 64, 128> dense;
+    double denseTime = timeForward(dense, inputs, repeats);
+    std::cout << name << " inputs\n";
+    std::cout << "Dense: " << denseTime << " seconds\n";
+
+    for(double density : {1.0, 0.5, 0.2, 0.1, 0.05, 0.01}) {
+        SparseDense<floatX, 64, 128> sparse(density);
+        double sparseTime = timeForward(sparse, inputs, repeats);
+        std::cout << "SparseDense density " << density << " (" << sparse.num_rows() << " stored outputs): " 
+                  << sparseTime << " seconds (" << denseTime/sparseTime << "x)\n";
+    }
+}
+
+int main() {
+    int repeats = 20;
+    std::vector<floatX> sparseInputs;
+    std::vector<floatX> denseInputs;
+    for(int i=0;i<100;++i) {
+        floatX sparseInput;
+        floatX denseInput;
+        for(int j=0;j<64;++j) {
+            if((i*7+j*13)%10==0) // sparse features, 10% nonzero
+                sparseInput.set(j, std::sin(i+j)*0.5);
+            denseInput.set(j, std::sin(i+j)*0.5);
+        }
+        sparseInputs.push_back(sparseInput);
+        denseInputs.push_back(denseInput);
+    }
+
+    // sparse inputs skip the outputs they do not overlap, while dense inputs only gain from sparse weights
+    compare("Sparse", sparseInputs, repeats);
+    compare("Dense", denseInputs, repeats);
+}
@@ -0,0 +1,58 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+
+// Cost of telemetry on training steps of a DEPTH-layer relu MLP. This file is built twice, as benchmark_telemetry
+// and as benchmark_telemetry_counted with TELEMETRY defined; comparing the per-sample times of the two gives the
+// overhead of counting overflows, underflows, saturations and zero lanes.
+
+using namespace tensorless;
+
+#define DEPTH 3
+#define WIDTH 64
+#define SAMPLES 256
+#define REPEATS 5
+
+// median per-sample time of forward and backward passes on the calling core
+template <typename T>
+void benchmark(const char *type) {
+    ThreadPool::Sequential sequential;
+    Layered<T> model;
+    for(int i=0;i<DEPTH;++i)
+        model.add(std::make_shared<Dense<T, WIDTH, WIDTH>>());
+    std::vector<T> inputs(SAMPLES);
+    for(int sample=0;sample<SAMPLES;++sample)
+        for(int lane=0;lane<WIDTH;++lane)
+            inputs[sample].set(lane, std::sin(sample*31+lane)*0.5);
+    SGD<T> optimizer(0.001);
+    double checksum = 0;
+    std::vector<double> times;
+    for(int repeat=0;repeat<REPEATS;++repeat) {
+        auto start = std::chrono::steady_clock::now();
+        for(int sample=0;sample<SAMPLES;++sample) {
+            T output = model.forward(inputs[sample]);
+            checksum += output.get(0);
+            model.backward(inputs[sample]-output, optimizer);
+        }
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double>(end - start).count()/SAMPLES);
+    }
+    std::sort(times.begin(), times.end());
+    #ifdef TELEMETRY
+    const char *mode = "counted";
+    #else
+    const char *mode = "off";
+    #endif
+    printf("%-10s telemetry %-8s %9.2f us/sample\n", type, mode, times[times.size()/2]*1.E6);
+    if(checksum==1234.5678) // keeps the computation from being optimized away
+        std::cout << "";
+}
+
+int main() {
+    benchmark<sfloat9>("sfloat9");
+    benchmark<dfloat10>("dfloat10");
+    benchmark<float12>("float12");
+}
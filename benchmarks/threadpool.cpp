@@ -0,0 +1,71 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <omp.h>
+
+// Dispatch overhead of the persistent ThreadPool against an OpenMP fork/join, first for empty loops and then for
+// the per-output products of a 128-output layer, which take a few microseconds each. The last rows time Layered
+// forward passes, whose Dense layers use ThreadPool::global() (set its size with TENSORLESS_THREADS).
+
+using namespace tensorless;
+typedef float8 floatX; // change this to benchmark different datatypes
+
+#define OUTPUTS 128
+#define REPEATS 2000
+
+template <typename Function>
+double medianMicroseconds(const Function &function) {
+    std::vector<double> times;
+    for(int repeat=0;repeat<REPEATS;++repeat) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size()/2];
+}
+
+int main() {
+    int threads = omp_get_max_threads();
+    ThreadPool pool(threads);
+    std::cout << threads << " threads\n";
+
+    volatile int sink = 0;
+    double emptyPool = medianMicroseconds([&]() {
+        pool.parallelFor(0, OUTPUTS, [&](int begin, int end) {sink = begin;});
+    });
+    double emptyOpenMP = medianMicroseconds([&]() {
+        #pragma omp parallel for num_threads(threads)
+        for(int i=0;i<OUTPUTS;++i)
+            sink = i;
+    });
+    printf("empty loop       pool %8.2f us   OpenMP %8.2f us\n", emptyPool, emptyOpenMP);
+
+    floatX input = floatX::random();
+    std::vector<floatX> weights(OUTPUTS);
+    for(auto& weight : weights)
+        weight = floatX::random();
+    double sums[OUTPUTS];
+    auto products = [&](int begin, int end) {
+        for(int i=begin;i<end;++i)
+            sums[i] = (input*weights[i]).sum();
+    };
+    double sequential = medianMicroseconds([&]() {products(0, OUTPUTS);});
+    double layerPool = medianMicroseconds([&]() {pool.parallelFor(0, OUTPUTS, products);});
+    double layerOpenMP = medianMicroseconds([&]() {
+        #pragma omp parallel for num_threads(threads)
+        for(int i=0;i<OUTPUTS;++i)
+            products(i, i+1);
+    });
+    printf("layer products   pool %8.2f us   OpenMP %8.2f us   sequential %8.2f us\n", layerPool, layerOpenMP, sequential);
+
+    auto arch = Layered<floatX>()
+                .add(std::make_shared<Dense<floatX, OUTPUTS, OUTPUTS>>())
+                .add(std::make_shared<Dense<floatX, OUTPUTS, OUTPUTS>>());
+    double checksum = 0;
+    double forward = medianMicroseconds([&]() {checksum += arch.forward(input).get(0);});
+    printf("Layered forward  %8.2f us with %d pool threads (checksum %g)\n", forward, ThreadPool::global().size(), checksum);
+}
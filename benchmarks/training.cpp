@@ -0,0 +1,51 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <cmath>
+#include <chrono>
+
+using namespace tensorless;
+typedef dfloat9 floatX; // change this to benchmark different datatypes
+
+std::shared_ptr<Neural<floatX>> createModel() {
+    auto model = std::make_shared<Layered<floatX>>();
+    model->add(std::make_shared<Dense<floatX, 64, 64>>());
+    model->add(std::make_shared<Dense<floatX, 64, 64>>());
+    model->add(std::make_shared<Dense<floatX, 64, 8>>());
+    return model;
+}
+
+int main() {
+    int batchSize = 256;
+    int batches = 20;
+
+    std::vector<floatX> inputs;
+    std::vector<floatX> targets;
+    for(int i=0;i<batchSize;++i) {
+        floatX input;
+        floatX target;
+        for(int j=0;j<64;++j)
+            input.set(j, std::sin(i+j)*0.5);
+        for(int j=0;j<8;++j)
+            target.set(j, std::cos(i*j)*0.25+0.25);
+        inputs.push_back(input);
+        targets.push_back(target);
+    }
+    std::cout << "Batch size " << batchSize << ", " << omp_get_max_threads() << " available threads\n";
+
+    double baseline = 0;
+    for(int threads=1;threads<=omp_get_max_threads();threads*=2) {
+        SGD<floatX> optimizer(0.01);
+        Trainer<floatX> trainer(createModel, optimizer, threads);
+        double loss = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for(int batch=0;batch<batches;++batch)
+            loss = trainer.step(inputs, targets);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed = end - start;
+        double samplesPerSecond = batchSize*batches/elapsed.count();
+        if(threads==1)
+            baseline = samplesPerSecond;
+        std::cout << "Threads " << threads << ": " << samplesPerSecond << " samples/sec ("
+                  << samplesPerSecond/baseline << "x), last batch loss " << loss/batchSize << "\n";
+    }
+}
@@ -3,8 +3,8 @@
 
 int main() {
     // this test runs only on architectures that support int128
-    auto data1 = tensorless::int2().set(0, -1);
-    auto data2 = tensorless::int2().set(0, 2);
+    auto data1 = tensorless::int3().set(0, -1);
+    auto data2 = tensorless::int3().set(0, 2);
     std::cout << "data1         " << data1 <<"\n";
     std::cout << "data2         " << data2 <<"\n";
     std::cout << "-data2        " << data2.twosComplement() <<"\n";
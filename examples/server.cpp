@@ -0,0 +1,63 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include "../tensorless/serving/server.h"
+#include <csignal>
+#include <cstring>
+#include <memory>
+
+// Serves a relu MLP over a Unix domain socket until interrupted, printing batching and latency statistics.
+//   --socket PATH       socket to listen on (default /tmp/tensorless.sock)
+//   --workers N         model replicas answering batches in parallel (default: TENSORLESS_THREADS or OpenMP threads)
+//   --max-batch N       most requests answered together
+//   --max-wait-us N     longest wait for a batch to fill after its first request
+//   --report SECONDS    interval between statistics lines
+// Send requests with benchmarks/loadgen.cpp, e.g. ./benchmark_loadgen --socket /tmp/tensorless.sock
+
+using namespace tensorless;
+typedef float8 TYPE;
+
+std::atomic<bool> interrupted(false);
+
+int main(int argc, char **argv) {
+    std::string socket = "/tmp/tensorless.sock";
+    int workers = 0, maxBatch = 16, maxWait = 200;
+    double report = 5;
+    for(int i=1;i<argc;++i) {
+        if(!strcmp(argv[i], "--socket") && i+1<argc)
+            socket = argv[++i];
+        else if(!strcmp(argv[i], "--workers") && i+1<argc)
+            workers = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "--max-batch") && i+1<argc)
+            maxBatch = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "--max-wait-us") && i+1<argc)
+            maxWait = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "--report") && i+1<argc)
+            report = atof(argv[++i]);
+        else {
+            std::cerr << "usage: " << argv[0] << " [--socket PATH] [--workers N] [--max-batch N] [--max-wait-us N] [--report SECONDS]\n";
+            return 1;
+        }
+    }
+
+    InferenceServer<TYPE> server(socket, []() {
+        auto model = std::make_shared<Layered<TYPE>>();
+        model->add(std::make_shared<Dense<TYPE, 64, 64>>())
+              .add(std::make_shared<Dense<TYPE, 64, 64>>())
+              .add(std::make_shared<Dense<TYPE, 64, 64>>());
+        return std::static_pointer_cast<Neural<TYPE>>(model);
+    }, workers, maxBatch, maxWait);
+    signal(SIGINT, [](int) {interrupted.store(true);});
+    signal(SIGTERM, [](int) {interrupted.store(true);});
+    server.start();
+    std::cout << "Listening on " << socket << "\n";
+    auto last = std::chrono::steady_clock::now();
+    while(!interrupted.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if(std::chrono::duration<double>(std::chrono::steady_clock::now()-last).count()>=report) {
+            std::cout << server.stats().describe() << "\n";
+            last = std::chrono::steady_clock::now();
+        }
+    }
+    server.stop();
+    std::cout << server.stats().describe() << "\n";
+}
@@ -0,0 +1,194 @@
+# Copyright 2024 Emmanouil Krasanakis
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""ctypes bindings of libtensorless (tensorless/c/tensorless.h) without dependencies.
+
+Float inputs and outputs are any C-contiguous float32 buffers (numpy arrays, array.array('f'), memoryviews);
+writable ones are passed to the library without copies. Packed samples live in PackedBatch objects, whose aligned
+memory is handed to the library directly, so a batch can be packed once and run through forward repeatedly.
+
+    import tensorless
+    model = tensorless.Model("float8", inputs=64, widths=[64, 64, 16])
+    outputs = model(rows)  # rows: count x 64 float32 values, outputs: count x 16
+
+The library is looked up in TENSORLESS_LIBRARY, next to this file, in the build/ directory of the repository
+(as configured in the README) and then in the system paths.
+"""
+
+import ctypes
+import ctypes.util
+import os
+import sys
+from array import array
+
+ABI_VERSION = 1
+
+
+def _library_names():
+    if sys.platform == "win32":
+        return ["tensorless.dll"]
+    if sys.platform == "darwin":
+        return ["libtensorless.dylib"]
+    return ["libtensorless.so"]
+
+
+def _load():
+    candidates = []
+    if os.environ.get("TENSORLESS_LIBRARY"):
+        candidates.append(os.environ["TENSORLESS_LIBRARY"])
+    here = os.path.dirname(os.path.abspath(__file__))
+    for directory in [here, os.path.join(here, "..", "build")]:
+        candidates.extend(os.path.join(directory, name) for name in _library_names())
+    found = ctypes.util.find_library("tensorless")
+    if found:
+        candidates.append(found)
+    for candidate in candidates:
+        if os.path.exists(candidate) or candidate == found:
+            return ctypes.CDLL(candidate)
+    raise OSError("libtensorless not found; build it with CMake or set TENSORLESS_LIBRARY")
+
+
+_lib = _load()
+_model = ctypes.c_void_p
+_lib.tensorless_abi_version.restype = ctypes.c_int
+_lib.tensorless_last_error.restype = ctypes.c_char_p
+_lib.tensorless_create.restype = _model
+_lib.tensorless_create.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.POINTER(ctypes.c_int), ctypes.c_int, ctypes.c_ulonglong]
+_lib.tensorless_destroy.argtypes = [_model]
+_lib.tensorless_describe.restype = ctypes.c_char_p
+_lib.tensorless_describe.argtypes = [_model]
+_lib.tensorless_packed_bytes.restype = ctypes.c_size_t
+_lib.tensorless_packed_bytes.argtypes = [_model]
+_lib.tensorless_packed_alignment.restype = ctypes.c_size_t
+_lib.tensorless_packed_alignment.argtypes = [_model]
+_lib.tensorless_lanes.argtypes = [_model]
+_lib.tensorless_outputs.argtypes = [_model]
+_lib.tensorless_pack.argtypes = [_model, ctypes.c_void_p, ctypes.c_size_t, ctypes.c_size_t, ctypes.c_void_p]
+_lib.tensorless_forward.argtypes = [_model, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_size_t]
+_lib.tensorless_unpack.argtypes = [_model, ctypes.c_void_p, ctypes.c_size_t, ctypes.c_void_p, ctypes.c_size_t]
+if _lib.tensorless_abi_version() != ABI_VERSION:
+    raise OSError("libtensorless has ABI version %d, expected %d" % (_lib.tensorless_abi_version(), ABI_VERSION))
+
+
+def _check(status):
+    if status:
+        raise ValueError(_lib.tensorless_last_error().decode())
+
+
+def _address(buffer, writable):
+    """Address of a contiguous buffer and the object that keeps it alive; read-only buffers are copied."""
+    view = memoryview(buffer)
+    if not view.c_contiguous:
+        raise ValueError("buffers must be C-contiguous")
+    view = view.cast("B")
+    if view.readonly:
+        if writable:
+            raise ValueError("output buffers must be writable")
+        holder = (ctypes.c_char * len(view)).from_buffer_copy(view)
+    else:
+        holder = (ctypes.c_char * len(view)).from_buffer(view)
+    return ctypes.addressof(holder), holder
+
+
+def _rows(values, lanes):
+    """Number of rows of a float32 buffer with lanes values per row."""
+    view = memoryview(values)
+    if view.format != "f":
+        raise ValueError("values must be float32")
+    count, remainder = divmod(view.nbytes // 4, lanes)
+    if remainder:
+        raise ValueError("values must hold whole rows of %d lanes" % lanes)
+    return count
+
+
+class PackedBatch:
+    """count packed samples in aligned memory owned by Python."""
+
+    def __init__(self, model, count):
+        self.model = model
+        self.count = count
+        alignment = model.packed_alignment
+        self._memory = bytearray(count * model.packed_bytes + alignment)
+        base = ctypes.addressof((ctypes.c_char * len(self._memory)).from_buffer(self._memory))
+        self._offset = (-base) % alignment
+        self._view = (ctypes.c_char * (count * model.packed_bytes)).from_buffer(self._memory, self._offset)
+
+    @property
+    def address(self):
+        return ctypes.addressof(self._view)
+
+    def __len__(self):
+        return self.count
+
+
+class Model:
+    """Stack of relu Dense layers over one packed type (float8, float12, dfloat8 or sfloat9).
+
+    Forward calls on one model from several threads run one at a time; use one model per thread to run them in
+    parallel."""
+
+    def __init__(self, type="float8", inputs=64, widths=(64,), seed=0):
+        widths = list(widths)
+        self.inputs = inputs
+        self._handle = _lib.tensorless_create(type.encode(), inputs, (ctypes.c_int * len(widths))(*widths), len(widths), seed)
+        if not self._handle:
+            raise ValueError(_lib.tensorless_last_error().decode())
+        self.packed_bytes = _lib.tensorless_packed_bytes(self._handle)
+        self.packed_alignment = _lib.tensorless_packed_alignment(self._handle)
+        self.lanes = _lib.tensorless_lanes(self._handle)
+        self.outputs = _lib.tensorless_outputs(self._handle)
+
+    def __del__(self):
+        if getattr(self, "_handle", None):
+            _lib.tensorless_destroy(self._handle)
+            self._handle = None
+
+    def __repr__(self):
+        return _lib.tensorless_describe(self._handle).decode()
+
+    def pack(self, values, out=None):
+        """Packs rows of self.inputs float32 values."""
+        count = _rows(values, self.inputs)
+        out = out if out is not None else PackedBatch(self, count)
+        address, holder = _address(values, writable=False)
+        _check(_lib.tensorless_pack(self._handle, address, count, self.inputs, out.address))
+        return out
+
+    def forward(self, packed, out=None):
+        """Runs packed samples through the model; out may be packed itself."""
+        out = out if out is not None else PackedBatch(self, packed.count)
+        if out.count < packed.count:
+            raise ValueError("the output batch is too small")
+        _check(_lib.tensorless_forward(self._handle, packed.address, out.address, packed.count))
+        return out
+
+    def unpack(self, packed, out=None, lanes=None):
+        """float32 rows of the first lanes (default: the model's outputs) of packed samples, as a numpy array if
+        numpy is available and as an array.array otherwise, or written into out."""
+        lanes = lanes or self.outputs
+        if out is None:
+            try:
+                import numpy
+                out = numpy.empty((packed.count, lanes), dtype=numpy.float32)
+            except ImportError:
+                out = array("f", bytes(4 * packed.count * lanes))
+        if _rows(out, lanes) < packed.count:
+            raise ValueError("the output buffer is too small")
+        address, holder = _address(out, writable=True)
+        _check(_lib.tensorless_unpack(self._handle, packed.address, packed.count, address, lanes))
+        return out
+
+    def __call__(self, values):
+        packed = self.pack(values)
+        return self.unpack(self.forward(packed, out=packed))
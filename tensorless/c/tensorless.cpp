@@ -0,0 +1,209 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "tensorless.h"
+#include "../types/all.h"
+#include "../layers/all.h"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+using namespace tensorless;
+
+namespace {
+
+thread_local std::string lastError;
+
+template <typename Function>
+int guarded(const Function &function) {
+    try {
+        function();
+        return 0;
+    }
+    catch(const std::exception &error) {
+        lastError = error.what();
+    }
+    catch(...) {
+        lastError = "unknown error";
+    }
+    return -1;
+}
+
+}
+
+struct tensorless_model {
+    std::string description;
+    int outputs = 0;
+    virtual ~tensorless_model() {}
+    virtual size_t bytes() const = 0;
+    virtual size_t alignment() const = 0;
+    virtual int lanes() const = 0;
+    virtual void pack(const float *values, size_t count, size_t lanes, void *packed) const = 0;
+    virtual void forward(const void *in, void *out, size_t count) = 0;
+    virtual void unpack(const void *packed, size_t count, float *values, size_t lanes) const = 0;
+};
+
+namespace {
+
+// packed samples live in caller memory; the types are trivially copyable, so they are read and written in place
+template <typename Tensor>
+class Model: public tensorless_model {
+private:
+    Layered<Tensor> layered;
+    std::mutex forwardMutex; // layers keep their last input for backward, so forward calls cannot overlap
+
+    void check(const void *packed) const {
+        if(!packed || reinterpret_cast<std::uintptr_t>(packed)%alignof(Tensor))
+            throw std::logic_error("packed buffers must be aligned to "+std::to_string(alignof(Tensor))+" bytes");
+    }
+
+    void checkLanes(size_t count) const {
+        if(count>(size_t)lanes())
+            throw std::logic_error("at most "+std::to_string(lanes())+" lanes fit in a packed sample");
+    }
+
+    // Dense layers read every lane, so their input count only labels describe(); layers are instantiated square,
+    // one per power-of-two width, because a template per (inputs, outputs) pair would multiply compile times
+    template <int width>
+    std::shared_ptr<Neural<Tensor>> dense(int outputs) {
+        if(outputs==width)
+            return std::make_shared<Dense<Tensor, width, width>>();
+        if constexpr(width>1)
+            return dense<width/2>(outputs);
+        throw std::logic_error("layer widths must be powers of two up to 128");
+    }
+
+public:
+    Model(int inputs, const int *widths, int layers) {
+        checkLanes(inputs);
+        if(layers<1 || !widths)
+            throw std::logic_error("a model needs at least one layer");
+        for(int i=0;i<layers;++i)
+            layered.add(dense<128>(widths[i]));
+        outputs = widths[layers-1];
+        description = layered.describe();
+    }
+
+    size_t bytes() const {return sizeof(Tensor);}
+    size_t alignment() const {return alignof(Tensor);}
+    int lanes() const {return Tensor().size();}
+
+    void pack(const float *values, size_t count, size_t lanes, void *packed) const {
+        check(packed);
+        checkLanes(lanes);
+        Tensor *samples = static_cast<Tensor*>(packed);
+        for(size_t i=0;i<count;++i) {
+            Tensor sample;
+            for(size_t lane=0;lane<lanes;++lane)
+                if(values[i*lanes+lane])
+                    sample.set(lane, values[i*lanes+lane]);
+            new (samples+i) Tensor(sample);
+        }
+    }
+
+    void forward(const void *in, void *out, size_t count) {
+        check(in);
+        check(out);
+        const Tensor *inputs = static_cast<const Tensor*>(in);
+        Tensor *outputs = static_cast<Tensor*>(out);
+        std::lock_guard<std::mutex> lock(forwardMutex);
+        for(size_t i=0;i<count;++i)
+            outputs[i] = layered.forward(inputs[i]);
+    }
+
+    void unpack(const void *packed, size_t count, float *values, size_t lanes) const {
+        check(packed);
+        checkLanes(lanes);
+        const Tensor *samples = static_cast<const Tensor*>(packed);
+        for(size_t i=0;i<count;++i)
+            for(size_t lane=0;lane<lanes;++lane)
+                values[i*lanes+lane] = samples[i].get(lane);
+    }
+};
+
+}
+
+extern "C" {
+
+int tensorless_abi_version(void) {
+    return TENSORLESS_ABI_VERSION;
+}
+
+const char* tensorless_last_error(void) {
+    return lastError.c_str();
+}
+
+tensorless_model* tensorless_create(const char *type, int inputs, const int *widths, int layers, unsigned long long seed) {
+    tensorless_model *model = nullptr;
+    guarded([&]() {
+        std::string name = type ? type : "";
+        generator.seed(seed);
+        if(name=="float8")
+            model = new Model<float8>(inputs, widths, layers);
+        else if(name=="float12")
+            model = new Model<float12>(inputs, widths, layers);
+        else if(name=="dfloat8")
+            model = new Model<dfloat8>(inputs, widths, layers);
+        else if(name=="sfloat9")
+            model = new Model<sfloat9>(inputs, widths, layers);
+        else
+            throw std::logic_error("unknown type "+name+" (expected float8, float12, dfloat8 or sfloat9)");
+    });
+    return model;
+}
+
+void tensorless_destroy(tensorless_model *model) {
+    delete model;
+}
+
+const char* tensorless_describe(const tensorless_model *model) {
+    return model->description.c_str();
+}
+
+size_t tensorless_packed_bytes(const tensorless_model *model) {
+    return model->bytes();
+}
+
+size_t tensorless_packed_alignment(const tensorless_model *model) {
+    return model->alignment();
+}
+
+int tensorless_lanes(const tensorless_model *model) {
+    return model->lanes();
+}
+
+int tensorless_outputs(const tensorless_model *model) {
+    return model->outputs;
+}
+
+int tensorless_pack(const tensorless_model *model, const float *values, size_t count, size_t lanes, void *packed) {
+    return guarded([&]() {model->pack(values, count, lanes, packed);});
+}
+
+int tensorless_forward(tensorless_model *model, const void *in, void *out, size_t count) {
+    return guarded([&]() {model->forward(in, out, count);});
+}
+
+int tensorless_unpack(const tensorless_model *model, const void *packed, size_t count, float *values, size_t lanes) {
+    return guarded([&]() {model->unpack(packed, count, values, lanes);});
+}
+
+}
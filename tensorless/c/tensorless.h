@@ -0,0 +1,85 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef TENSORLESS_C_H
+#define TENSORLESS_C_H
+
+/*
+C interface of libtensorless, for languages that cannot instantiate the C++ templates. A model is a stack of
+relu Dense layers over one packed type. Samples move through caller-owned buffers without copies: pack converts
+float rows into packed samples of tensorless_packed_bytes() each, forward reads and writes packed buffers in
+place, and unpack converts packed samples back to floats. Packed buffers must be aligned to
+tensorless_packed_alignment(). Functions that can fail return 0 on success and -1 otherwise, with the reason in
+tensorless_last_error(). The interface only grows within an ABI version.
+*/
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define TENSORLESS_API __declspec(dllexport)
+#else
+#define TENSORLESS_API __attribute__((visibility("default")))
+#endif
+
+#define TENSORLESS_ABI_VERSION 1
+
+typedef struct tensorless_model tensorless_model;
+
+TENSORLESS_API int tensorless_abi_version(void);
+
+/* message of the last failure on the calling thread */
+TENSORLESS_API const char* tensorless_last_error(void);
+
+/* type is one of float8, float12, dfloat8, sfloat9; widths holds the outputs of each layer, which must be powers of
+   two up to the lanes of one packed sample (128); weights are initialized randomly from seed; returns NULL on failure.
+   inputs is only checked against the lanes of a packed sample: every layer reads all lanes (pack zeroes the unused
+   ones), so tensorless_describe() lists each layer with as many inputs as outputs */
+TENSORLESS_API tensorless_model* tensorless_create(const char *type, int inputs, const int *widths, int layers, unsigned long long seed);
+
+TENSORLESS_API void tensorless_destroy(tensorless_model *model);
+
+/* layer summary, valid until the model is destroyed */
+TENSORLESS_API const char* tensorless_describe(const tensorless_model *model);
+
+TENSORLESS_API size_t tensorless_packed_bytes(const tensorless_model *model);
+
+TENSORLESS_API size_t tensorless_packed_alignment(const tensorless_model *model);
+
+/* lanes of each packed sample */
+TENSORLESS_API int tensorless_lanes(const tensorless_model *model);
+
+TENSORLESS_API int tensorless_outputs(const tensorless_model *model);
+
+/* packs count rows of lanes floats (row-major, lanes at most tensorless_lanes) into packed */
+TENSORLESS_API int tensorless_pack(const tensorless_model *model, const float *values, size_t count, size_t lanes, void *packed);
+
+/* runs count packed samples through the model; in and out may be the same buffer. Calls on the same model from
+   several threads are safe but run one at a time, so parallel callers should create one model each */
+TENSORLESS_API int tensorless_forward(tensorless_model *model, const void *in, void *out, size_t count);
+
+/* writes the first lanes values of count packed samples as row-major floats */
+TENSORLESS_API int tensorless_unpack(const tensorless_model *model, const void *packed, size_t count, float *values, size_t lanes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* TENSORLESS_C_H */
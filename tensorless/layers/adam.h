@@ -0,0 +1,109 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef TENSORLESS_ADAM_H
+#define TENSORLESS_ADAM_H
+
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include "neural.h"
+#include "../types/all.h"
+#include <cmath>
+
+namespace tensorless {
+
+// first and second moments are kept per parameter in the parameter's own packed type, damped by (1-beta) like the
+// scalar path; they are stored bias-corrected, so that the first gradients enter at full weight instead of being
+// scaled below the packed resolution, and the weight of each new gradient decays towards (1-beta) over the steps.
+// Steps do not change when all gradients are multiplied by a constant, so moments are kept for gradients times a
+// power of two that brings the largest lane seen to [0.5,1), where squares neither saturate nor vanish; when larger
+// gradients arrive, the power decreases and the moments are rescaled with it.
+// State is keyed by the parameter's address and remembers the value it last wrote there, so a parameter whose
+// storage moved or was overwritten restarts from fresh moments instead of inheriting another parameter's
+template <typename Tensor>
+class Adam: public Optimizer<Tensor> {
+    struct Moments {
+        Tensor first;
+        Tensor second;
+        Tensor last;
+        double gradScale = 0;
+        double scalarFirst = 0;
+        double scalarSecond = 0;
+        double scalarLast = 0;
+        int steps = 0;
+    };
+    double lr;
+    double beta1;
+    double beta2;
+    double eps;
+    std::unordered_map<const void*, Moments> moments;
+public:
+    Adam(double lr=0.001, double beta1=0.9, double beta2=0.999, double eps=1.E-8) : lr(lr), beta1(beta1), beta2(beta2), eps(eps) {}
+    virtual void update(Tensor &param, const Tensor &grads, double lr_mult=1) {
+        Moments &state = moments[&param];
+        if(state.steps && ~(param==state.last))
+            state = Moments();
+        state.steps++;
+        Tensor negated = Tensor()-grads;
+        double peak = std::max(grads.get(grads.argmax()), negated.get(negated.argmax()));
+        if(peak>0) {
+            double gradScale = std::ldexp(1.0, -std::ilogb(peak)-1);
+            if(state.gradScale && gradScale<state.gradScale) {
+                double ratio = gradScale/state.gradScale;
+                state.first = state.first.scale(ratio);
+                state.second = state.second.scale(ratio*ratio);
+            }
+            if(!state.gradScale || gradScale<state.gradScale)
+                state.gradScale = gradScale;
+        }
+        Tensor scaled = state.gradScale ? grads.scale(state.gradScale) : Tensor();
+        double firstWeight = (1-beta1)/(1-std::pow(beta1, state.steps));
+        double secondWeight = (1-beta2)/(1-std::pow(beta2, state.steps));
+        state.first = state.first.scale(1-firstWeight) + scaled.scale(firstWeight);
+        state.second = state.second.scale(1-secondWeight) + (scaled*scaled).scale(secondWeight);
+        Tensor denominator = state.second.sqrt() + Tensor::broadcast(eps*state.gradScale);
+        Tensor step = state.first/denominator;
+        // eps may be below the tensor's resolution, so lanes that never saw a gradient are skipped explicitly
+        step = step.merge(Tensor(), ~(denominator==Tensor()));
+        param = param + step.scale(lr_mult*lr);
+        state.last = param;
+    }
+    virtual void update(double &param, double grads, double lr_mult=1) {
+        Moments &state = moments[&param];
+        if(state.steps && param!=state.scalarLast)
+            state = Moments();
+        state.steps++;
+        state.scalarFirst = state.scalarFirst*beta1 + grads*(1-beta1);
+        state.scalarSecond = state.scalarSecond*beta2 + grads*grads*(1-beta2);
+        double first = state.scalarFirst/(1-std::pow(beta1, state.steps));
+        double second = state.scalarSecond/(1-std::pow(beta2, state.steps));
+        param = param + first/(std::sqrt(second)+eps)*lr_mult*lr;
+        state.scalarLast = param;
+    }
+    // forgets all moments, e.g. after loading new parameters
+    void reset() {
+        moments.clear();
+    }
+    int num_states() const {
+        return moments.size();
+    }
+};
+
+
+}
+#endif  // TENSORLESS_ADAM_H
@@ -20,6 +20,17 @@ limitations under the License.
 #include "neural.h"
 #include "layered.h"
 #include "dense.h"
+#include "mixeddense.h"
+#include "sparsedense.h"
+#include "binarydense.h"
+#include "ternarydense.h"
+#include "softmax.h"
+#include "attention.h"
+#include "layernorm.h"
 #include "sgd.h"
+#include "momentum.h"
+#include "adam.h"
+#include "trainer.h"
+#include "pipeline.h"
 
 #endif  // TENSORLESS_LAYERS_H
@@ -0,0 +1,408 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef TENSORLESS_ATTENTION_H
+#define TENSORLESS_ATTENTION_H
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include "neural.h"
+#include "dense.h"
+#include "../types/all.h"
+#include <cmath>
+#include <omp.h>
+
+namespace tensorless {
+
+// scores at most this far below a head's maximum keep a nonzero weight in the exponential lookup table
+#define ATTENTION_SCORE_RANGE 8.0
+
+// bits of the integer query coefficients that multiply key rows in exact score sums
+#define ATTENTION_QUERY_BITS 12
+
+// packed type of attention scores and weights: Dynamic types keep their body, whose lanes share one scale
+template <typename Type>
+struct AttentionScores {
+    typedef Type type;
+    static type body(const Type &value) {return value;}
+    static double scale(const Type &value) {return 1;}
+};
+
+template <typename Number>
+struct AttentionScores<Dynamic<Number>> {
+    typedef Number type;
+    static type body(const Dynamic<Number> &value) {return value.getBody();}
+    static double scale(const Dynamic<Number> &value) {return value.getMantisa();}
+};
+
+template <typename Number, typename Mantisa>
+struct AttentionScores<Floating<Number, Mantisa>> {
+    static_assert(!std::is_same<Number, Number>::value, "Floating types have per-lane exponents and cannot be used in packed attention");
+};
+
+// Keys and values of the positions seen so far, both stored transposed: block b holds dim packed keys and 
+// dim packed values whose lanes are positions b*NUM_LANES onwards, so that the scores of a block are packed 
+// sums of its key rows and weighting values by attention probabilities is a packed dot.
+template <typename Type, int dim>
+class KVCache {
+private:
+    std::vector<Type> keys;
+    std::vector<Type> values;
+    std::vector<double> keyBounds;  // largest magnitude in each key row
+    int count = 0;
+
+public:
+    void append(const Type &key, const Type &value) {
+        int lane = count%NUM_LANES;
+        if(lane==0) {
+            keys.resize(keys.size()+dim);
+            values.resize(values.size()+dim);
+            keyBounds.resize(keyBounds.size()+dim);
+        }
+        Type *keyBlock = &keys[keys.size()-dim];
+        Type *valueBlock = &values[values.size()-dim];
+        for(int j=0;j<dim;++j) {
+            keyBlock[j].set(lane, key.get(j));
+            valueBlock[j].set(lane, value.get(j));
+            keyBounds[keyBounds.size()-dim+j] = std::max(keyBounds[keyBounds.size()-dim+j], std::abs(key.get(j)));
+        }
+        count++;
+    }
+
+    void clear() {
+        keys.clear();
+        values.clear();
+        keyBounds.clear();
+        count = 0;
+    }
+
+    int size() const {return count;}
+    int num_blocks() const {return values.size()/dim;}
+    const Type& key(int block, int lane) const {return keys[block*dim+lane];}
+    double keyBound(int block, int lane) const {return keyBounds[block*dim+lane];}
+    const Type& value(int block, int lane) const {return values[block*dim+lane];}
+
+    // lanes of a block that hold cached positions
+    VECTOR positions(int block) const {
+        return ~planeShift(~(VECTOR)0, std::min(NUM_LANES, size()-block*NUM_LANES));
+    }
+
+    size_t bytes() const {
+        return (keys.size()+values.size())*sizeof(Type);
+    }
+};
+
+// Multi-head causal self-attention for autoregressive decoding. Each forward call processes the next token 
+// of a sequence: its query, key and value projections are packed dot products with the input, its key and 
+// value are appended to a KV cache, and each head attends over all cached positions. The Q·K scores of a 
+// block of positions are one packed sum of the head's transposed key rows, each multiplied by a broadcast 
+// query lane; the softmax shifts and doubles them into the range of the packed type and exponentiates the 
+// whole block with one lookup table; the weighted sum of values is a packed dot of the probabilities with 
+// each transposed value row. Heads run in parallel on ThreadPool::global() under the same conditions as 
+// Dense. Call reset() before each new sequence.
+//
+// Backpropagation covers the current token: past keys and values are treated as constants, as they were
+// computed from earlier inputs.
+template <typename Tensor, int dim, int heads>
+class SelfAttention: public Neural<Tensor> {
+private:
+    typedef typename AttentionScores<Tensor>::type Scores;
+    static_assert(dim%heads==0, "attention heads must split the dimension evenly");
+    static_assert(dim<=NUM_LANES, "attention dimension exceeds the lanes of the packed type");
+    static const int headDim = dim/heads;
+
+    Tensor queryWeights[dim];
+    Tensor keyWeights[dim];
+    Tensor valueWeights[dim];
+    Tensor outputWeights[dim];
+    Lut<Scores> exp;
+    KVCache<Tensor, dim> cache;
+    Tensor input;
+    Tensor query;
+    Tensor attention;
+    std::vector<Scores> probabilities[heads];  // unnormalized, one per block of positions
+    double normalizers[heads];
+
+    static bool parallel() {
+        return ThreadPool::shouldSplit(heads, 2);
+    }
+
+    static double clip(double value) {
+        return std::min(std::max(value, Tensor::inf()), Tensor::sup());
+    }
+
+    // Scores are computed as A = c*S for a power of two 1/c, no larger than needed to keep each block within
+    // half the range of the score type given the bounds of its key rows, so that A-max(A) fits in the range 
+    // and doubling it maps score differences of ATTENTION_SCORE_RANGE onto the whole range without 
+    // multiplications. The query coefficients of A are rounded to ATTENTION_QUERY_BITS bits, and each block
+    // sums its key rows times these integers exactly in a WideSum, which is rounded once to the score type.
+    void attend(int head, double *attended) {
+        int blocks = cache.num_blocks();
+        double span = Scores::sup()-Scores::inf();
+        std::vector<double> coefficients(blocks*headDim);
+        double largest = 0;
+        double bound = 0;
+        for(int block=0;block<blocks;++block) {
+            double total = 0;
+            for(int j=0;j<headDim;++j) {
+                int lane = head*headDim+j;
+                double weight = query.get(lane)/std::sqrt((double)headDim);
+                double coefficient = weight*AttentionScores<Tensor>::scale(cache.key(block, lane));
+                coefficients[block*headDim+j] = coefficient;
+                total += std::abs(weight)*cache.keyBound(block, lane);
+                largest = std::max(largest, std::abs(coefficient));
+            }
+            bound = std::max(bound, total);
+        }
+        int doublings = 0;
+        double c = span/ATTENTION_SCORE_RANGE;
+        while(c*bound>Scores::sup()/2 || c*largest>Scores::sup()/2) {
+            c /= 2;
+            doublings++;
+        }
+        // coefficients become integers below 2^ATTENTION_QUERY_BITS in units of 2^-shift score steps; sums wrap
+        // modulo the width of the WideSum, which holds exactly the planes of the rounded scores and those below
+        int shift = 0;
+        if(largest>0) {
+            int exponent;
+            std::frexp(c*largest, &exponent);
+            shift = std::min(ATTENTION_QUERY_BITS-exponent, MAX_WIDESUM_PLANES-Scores::num_params());
+        }
+        int width = shift+Scores::num_params();
+        std::vector<long long> multiples(blocks*headDim);
+        for(int k=0;k<blocks*headDim;++k)
+            multiples[k] = std::llround(std::ldexp(c*coefficients[k], shift));
+        std::vector<Scores> &weights = probabilities[head];
+        weights.assign(blocks, Scores());
+        double max = -std::numeric_limits<double>::infinity();
+        for(int block=0;block<blocks;++block) {
+            WideSum<Scores> sum(width);
+            for(int j=0;j<headDim;++j)
+                if(multiples[block*headDim+j])
+                    sum.add(AttentionScores<Tensor>::body(cache.key(block, head*headDim+j)), multiples[block*headDim+j]);
+            Scores scores = sum.shifted(shift);
+            weights[block] = scores;
+            max = std::max(max, scores.get(scores.argmax(cache.positions(block))));
+        }
+        // score differences in [-ATTENTION_SCORE_RANGE, 0] span the whole range of the score type
+        double floor = -span/(1<<doublings);
+        double total = 0;
+        for(int block=0;block<blocks;++block) {
+            Scores shifted = weights[block]-Scores::broadcast(max);
+            if(doublings) {
+                shifted = shifted.merge(Scores::broadcast(floor), shifted>Scores::broadcast(floor));
+                for(int k=1;k<doublings;++k)
+                    shifted = shifted.times2();
+                shifted = (shifted+Scores::broadcast(Scores::sup()/2)).times2();
+            }
+            else
+                shifted = shifted+Scores::broadcast(Scores::sup());
+            weights[block] = exp(shifted).merge(Scores(), cache.positions(block));
+            total += weights[block].sum();
+        }
+        normalizers[head] = 1/total;
+        for(int j=head*headDim;j<(head+1)*headDim;++j) {
+            double sum = 0;
+            for(int block=0;block<cache.num_blocks();++block)
+                sum += dot(weights[block], cache.value(block, j));
+            attended[j] = sum*normalizers[head];
+        }
+    }
+
+public:
+    SelfAttention() : exp(Lut<Scores>::fromFunction([](double x) {
+            double span = Scores::sup()-Scores::inf();
+            return Scores::sup()*std::exp(ATTENTION_SCORE_RANGE*((x-Scores::inf())/span-1));
+        })) {
+        for (int i=0; i<dim;++i) {
+            queryWeights[i] = Tensor::random();
+            keyWeights[i] = Tensor::random();
+            valueWeights[i] = Tensor::random();
+            outputWeights[i] = Tensor::random();
+        }
+        for (int h=0; h<heads; ++h)
+            normalizers[h] = 0;
+    }
+
+    // starts a new sequence
+    void reset() {
+        cache.clear();
+    }
+
+    int num_cached() const {
+        return cache.size();
+    }
+
+    // projection 0 to 3 selects the query, key, value or output weights
+    double weight(int projection, int output, int input) const {
+        const Tensor *projections[] = {queryWeights, keyWeights, valueWeights, outputWeights};
+        return projections[projection][output].get(input);
+    }
+
+    virtual std::string describe() const {
+        std::string description;
+        int paramSpace = Tensor::num_bits()*4*dim/8;
+        description += "SelfAttention";
+        description += "\n  Dim      " + std::to_string(dim);
+        description += "\n  Heads    " + std::to_string(heads);
+        description += "\n  Params   " + std::to_string(Tensor::num_params()*4*dim)
+                            +" ("+std::to_string(paramSpace)+" bytes, "+std::to_string(paramSpace/sizeof(float)*100/4/dim/dim)+"% of float)";
+        description += "\n  Exp LUT  " + std::to_string(exp.num_nodes()) + " nodes";
+        description += "\n  Cached   " + std::to_string(cache.size()) + " positions (" + std::to_string(cache.bytes()) + " bytes)";
+        description += "\n";
+        return description;
+    }
+
+    virtual Tensor forward(const Tensor& input) {
+        this->input = input;
+        double queries[dim];
+        double keys[dim];
+        double values[dim];
+        auto projections = [&](int begin, int end) {
+            for (int i=begin;i<end;++i) {
+                queries[i] = clip(dot(input, queryWeights[i]));
+                keys[i] = clip(dot(input, keyWeights[i]));
+                values[i] = clip(dot(input, valueWeights[i]));
+            }
+        };
+        if(parallel() && dim>=DENSE_PARALLEL_OUTPUTS)
+            ThreadPool::global().parallelFor(0, dim, projections);
+        else
+            projections(0, dim);
+        // lanes share planes, so they are set by one thread, and Dynamic tensors pick their scale once
+        query = Tensor(std::vector<double>(queries, queries+dim));
+        Tensor key(std::vector<double>(keys, keys+dim));
+        Tensor value(std::vector<double>(values, values+dim));
+        cache.append(key, value);
+
+        double attended[dim];
+        auto attendHeads = [&](int begin, int end) {
+            for (int h=begin;h<end;++h)
+                attend(h, attended);
+        };
+        if(parallel())
+            ThreadPool::global().parallelFor(0, heads, attendHeads);
+        else
+            attendHeads(0, heads);
+        attention = Tensor();
+        for (int j=0;j<dim;++j)
+            attention.set(j, clip(attended[j]));
+
+        Tensor out = Tensor();
+        for (int i=0;i<dim;++i)
+            out.set(i, clip(dot(attention, outputWeights[i])));
+        return out;
+    }
+
+    // as in Dense, every weight is passed to the optimizer so that all samples issue the same updates
+    virtual Tensor backward(const Tensor &error, Optimizer<Tensor> &optimizer) {
+        if(cache.size()==0)
+            throw std::logic_error("SelfAttention::backward needs a preceding forward call");
+        int positions = cache.size();
+        int current = positions-1;
+        double scale = 1/std::sqrt((double)headDim);
+
+        double outputErrors[dim];
+        Tensor attentionError;
+        for (int i=0;i<dim;++i) {
+            outputErrors[i] = error.get(i);
+            if(outputErrors[i])
+                attentionError = attentionError + outputWeights[i]*Tensor::broadcast(clip(outputErrors[i]));
+        }
+
+        // softmax backward per head: ds_t = p_t (dp_t - sum_u p_u dp_u), where dp_t = sum_j da_j v_t[j]; 
+        // each head accumulates its own tensors, so that heads with small errors keep their precision
+        double queryErrors[dim];
+        double keyErrors[dim];
+        double valueErrors[dim];
+        auto headErrors = [&](int begin, int end) {
+            for (int h=begin;h<end;++h) {
+                std::vector<double> p(positions);
+                std::vector<double> dp(positions);
+                double expected = 0;
+                for(int block=0;block<cache.num_blocks();++block) {
+                    Tensor blockErrors;
+                    for(int j=h*headDim;j<(h+1)*headDim;++j) {
+                        double attentionErrorj = attentionError.get(j);
+                        if(attentionErrorj)
+                            blockErrors = blockErrors + cache.value(block, j)*Tensor::broadcast(clip(attentionErrorj));
+                    }
+                    int end = std::min(positions, (block+1)*NUM_LANES);
+                    for(int t=block*NUM_LANES;t<end;++t) {
+                        p[t] = probabilities[h][block].get(t-block*NUM_LANES)*normalizers[h];
+                        dp[t] = blockErrors.get(t-block*NUM_LANES);
+                        expected += p[t]*dp[t];
+                    }
+                }
+                // query errors are packed dots of the score errors with the transposed key rows, with the
+                // score errors normalized to half the unit so that small ones keep their precision
+                std::vector<double> scoreErrors(positions);
+                double largest = 0;
+                for(int t=0;t<positions;++t) {
+                    scoreErrors[t] = p[t]*(dp[t]-expected)*scale;
+                    largest = std::max(largest, std::abs(scoreErrors[t]));
+                }
+                std::vector<Tensor> normalized(cache.num_blocks());
+                for(int t=0;t<positions && largest;++t)
+                    if(scoreErrors[t])
+                        normalized[t/NUM_LANES].set(t%NUM_LANES, scoreErrors[t]/largest/2);
+                Tensor keyError = query*Tensor::broadcast(clip(p[current]*(dp[current]-expected)*scale));
+                Tensor valueError = attentionError*Tensor::broadcast(clip(p[current]));
+                for(int j=h*headDim;j<(h+1)*headDim;++j) {
+                    queryErrors[j] = 0;
+                    for(int block=0;block<cache.num_blocks();++block)
+                        queryErrors[j] += dot(normalized[block], cache.key(block, j))*largest*2;
+                    keyErrors[j] = keyError.get(j);
+                    valueErrors[j] = valueError.get(j);
+                }
+            }
+        };
+        if(parallel())
+            ThreadPool::global().parallelFor(0, heads, headErrors);
+        else
+            headErrors(0, heads);
+
+        Tensor err;
+        for (int i=0;i<dim;++i) {
+            double queryErrori = queryErrors[i];
+            double keyErrori = keyErrors[i];
+            double valueErrori = valueErrors[i];
+            Tensor queryScale = Tensor::broadcast(clip(queryErrori));
+            Tensor keyScale = Tensor::broadcast(clip(keyErrori));
+            Tensor valueScale = Tensor::broadcast(clip(valueErrori));
+            if(queryErrori)
+                err = err + queryWeights[i]*queryScale;
+            if(keyErrori)
+                err = err + keyWeights[i]*keyScale;
+            if(valueErrori)
+                err = err + valueWeights[i]*valueScale;
+            optimizer.update(queryWeights[i], input*queryScale);
+            optimizer.update(keyWeights[i], input*keyScale);
+            optimizer.update(valueWeights[i], input*valueScale);
+            optimizer.update(outputWeights[i], attention*Tensor::broadcast(clip(outputErrors[i])));
+        }
+        return err;
+    }
+
+    virtual void zerograd() {
+    }
+};
+
+}
+#endif  // TENSORLESS_ATTENTION_H
@@ -0,0 +1,123 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef TENSORLESS_BINARYDENSE_H
+#define TENSORLESS_BINARYDENSE_H
+
+#include <iostream>
+#include <vector>
+#include "neural.h"
+#include "../types/all.h"
+#include <cmath>
+
+namespace tensorless {
+
+// dense layer with 1-bit weights and activations: inputs are reduced to their sign mask and each output is
+// ins-2*bitcount(inputSigns^weightSigns), computed with one xor and one popcount; outputs are scaled by 1/ins 
+// so that they fit signed tensors. Training goes through packed latent weights with a straight-through estimator.
+template <typename Tensor, int ins, int outs>
+class BinaryDense: public Neural<Tensor> {
+protected:
+    Tensor latent[outs];
+    VECTOR negative[outs];
+    VECTOR lanes;
+    Tensor input;
+    VECTOR inputNegative;
+    double clip;
+
+    void binarize(int i) {
+        negative[i] = (latent[i] < Tensor()) & lanes;
+    }
+
+    // straight-through estimator hook: lanes of values through which gradients pass (those within [-clip, clip])
+    virtual VECTOR straightThrough(const Tensor &values) const {
+        VECTOR outside = 0;
+        if(clip<Tensor::sup())
+            outside |= values > Tensor::broadcast(clip);
+        if(-clip>Tensor::inf())
+            outside |= values < Tensor::broadcast(-clip);
+        return ~outside & lanes;
+    }
+
+public:
+    BinaryDense(double clip=1) : lanes(0), inputNegative(0), clip(clip) {
+        for (int j=0; j<ins; ++j) 
+            lanes |= ONEHOT(j);
+        for (int i=0; i<outs; ++i) {
+            latent[i] = Tensor::random().merge(Tensor(), lanes);
+            binarize(i);
+        }
+    }
+
+    // binarized weight, -1 or 1
+    int weight(int output, int input) const {
+        return GETAT(negative[output], input) ? -1 : 1;
+    }
+
+    virtual std::string describe() const {
+        std::string description;
+        int paramSpace = outs*ins/8;
+        description += "BinaryDense";
+        description += "\n  Inputs   " + std::to_string(ins);
+        description += "\n  Outputs  " + std::to_string(outs);
+        description += "\n  Params   " + std::to_string(ins*outs)
+                            +" ("+std::to_string(paramSpace)+" bytes, "+std::to_string(paramSpace/sizeof(float)*100/ins/outs)+"% of float)";
+        description += "\n";
+        return description;
+    }
+
+    // binary forward pass on sign masks, to chain binary layers without going through tensors
+    VECTOR forwardSigns(const VECTOR &inputNegative) const {
+        VECTOR ret = 0;
+        for (int i=0;i<outs;++i) 
+            if(2*bitcount((inputNegative ^ negative[i]) & lanes)>ins)
+                ret |= ONEHOT(i);
+        return ret;
+    }
+
+    virtual Tensor forward(const Tensor& input) {
+        this->input = input;
+        inputNegative = (input < Tensor()) & lanes;
+        int dots[outs];
+        for (int i=0;i<outs;++i) 
+            dots[i] = ins-2*bitcount((inputNegative ^ negative[i]) & lanes);
+        return fromCounts<Tensor>(dots, outs, 1.0/ins);
+    }
+
+    // latent weights receive the unscaled output error (a 1/ins factor would fall below the packed resolution)
+    virtual Tensor backward(const Tensor &error, Optimizer<Tensor> &optimizer) {
+        Tensor err;
+        double scale = 1.0/ins;
+        for (int i=0;i<outs;++i) {
+            double errori = error.get(i);
+            if(errori) {
+                Tensor positiveError = Tensor::broadcast(errori*scale);
+                err = err + positiveError.merge(Tensor::broadcast(-errori*scale), ~negative[i]);
+            }
+            Tensor grad = errori ? Tensor::broadcast(errori).merge(Tensor::broadcast(-errori), ~inputNegative).merge(Tensor(), straightThrough(latent[i])) : Tensor();
+            optimizer.update(latent[i], grad);
+            binarize(i);
+        }
+        return err.merge(Tensor(), straightThrough(input));
+    }
+
+    virtual void zerograd() {
+    }
+};
+
+}
+#endif  // TENSORLESS_BINARYDENSE_H
@@ -23,20 +23,34 @@ limitations under the License.
 #include "neural.h"
 #include "../types/all.h"
 #include <cmath>
+#include <omp.h>
 
 namespace tensorless {
 
+#define DENSE_PARALLEL_OUTPUTS 32
+
 template <typename Tensor, int ins, int outs>
 class Dense: public Neural<Tensor> {
 private:
     Tensor weights[outs];
     double biases[outs];
     bool activations[outs];
+    Tensor input;
+
+    // Outputs are split among the threads of ThreadPool::global() in layers of at least DENSE_PARALLEL_OUTPUTS
+    // outputs (see ThreadPool::shouldSplit). Sums and updates keep their sequential order, so results do not
+    // depend on threads.
+    static bool parallel() {
+        return ThreadPool::shouldSplit(outs, DENSE_PARALLEL_OUTPUTS);
+    }
 
 public:
     Dense() {
-        for (int i=0; i<outs;++i) 
+        for (int i=0; i<outs;++i) {
             weights[i] = Tensor::random();
+            biases[i] = 0;
+            activations[i] = false;
+        }
     }
 
     virtual std::string describe() const {
@@ -52,45 +66,53 @@ public:
     }
 
     virtual Tensor forward(const Tensor& input) {
-        Tensor in = input; 
-        Tensor out = Tensor();
-        bool activation;
-        double sum;
-        Tensor weightedIns;
-        //#pragma omp parallel for shared(input, weights, out) private(weightedIns, sum, activation)
-        for (int i=0;i<outs;++i) {
-            weightedIns = input*weights[i]; 
-            sum = weightedIns.sum();
-            activation = sum>0;
-            if(activation) { // relu
-                //#pragma omp critical 
-                {
-                    out.set(i, sum);
-                }
+        this->input = input;
+        double sums[outs];
+        auto outputs = [&](int begin, int end) {
+            for (int i=begin;i<end;++i) {
+                sums[i] = (input*weights[i]).sum()+biases[i];
+                activations[i] = sums[i]>0;
             }
-        }
+        };
+        if(parallel())
+            ThreadPool::global().parallelFor(0, outs, outputs);
+        else
+            outputs(0, outs);
+        // lanes share planes, so they are set by one thread
+        Tensor out = Tensor();
+        for (int i=0;i<outs;++i)
+            if(activations[i]) // relu
+                out.set(i, sums[i]);
         return out;
     }
 
+    // every output is passed to the optimizer, even inactive ones with zero gradients, so that
+    // the sequence of updates is the same for all samples (gradient accumulators rely on this)
     virtual Tensor backward(const Tensor &error, Optimizer<Tensor> &optimizer) {
-        /*Tensor err;
-        double scale = 2*std::sqrt(12.0/outs);
-        double invscale = 1./scale;
-        double errorsum = error.sum();
-        //#pragma omp parallel for
-        for (int i=0;i<outs;++i) {
-            if(!activations[i])
-                continue;
-            Tensor erri = weights[i]*error*scale;
-            optimizer.update(weights[i], error, invscale);
-            //optimizer.update(biases[i], errorsum, invscale);
-            #pragma omp critical
-            {
-                err = err + erri;
+        double errors[outs];
+        std::vector<Tensor> contributions(outs);
+        std::vector<Tensor> grads(outs);
+        auto products = [&](int begin, int end) {
+            for (int i=begin;i<end;++i) {
+                errors[i] = activations[i]?error.get(i):0;
+                Tensor scale = Tensor::broadcast(errors[i]);
+                if(errors[i])
+                    contributions[i] = weights[i]*scale;
+                grads[i] = input*scale;
             }
+        };
+        if(parallel())
+            ThreadPool::global().parallelFor(0, outs, products);
+        else
+            products(0, outs);
+        Tensor err;
+        for (int i=0;i<outs;++i) {
+            if(errors[i])
+                err = err + contributions[i];
+            optimizer.update(weights[i], grads[i]);
+            optimizer.update(biases[i], errors[i]);
         }
-        return err;*/
-        return error;
+        return err;
     }
 
     virtual void zerograd() {
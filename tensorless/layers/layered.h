@@ -30,6 +30,49 @@ template <typename Tensor>
 class Layered: public Neural<Tensor> {
 protected:
     std::vector<std::shared_ptr<Neural<Tensor>>> layers;
+    std::vector<Telemetry> telemetry;
+    mutable TelemetryLock telemetryLock;
+    std::vector<Profile> forwardProfile;
+    std::vector<Profile> backwardProfile;
+    std::vector<ProfileEvent> trace;
+    bool tracing = false;
+
+    // attributes the counters gathered since before to a layer, along with the zero lanes of its output
+    void record(int layer, const Telemetry &before, const Tensor &output) {
+        #ifdef TELEMETRY
+        Telemetry &counters = threadTelemetry();
+        counters.zeros += POPCOUNT(output == Tensor());
+        counters.lanes += output.size();
+        std::lock_guard<std::mutex> lock(telemetryLock.mutex);
+        telemetry[layer] += counters-before;
+        #endif
+    }
+
+    // attributes the time and op counts since start to a layer, keeping a trace event if tracing
+    void profile(int layer, bool backward, const ProfileMark &start, long long activeLanes, const Tensor &output) {
+        #ifdef PROFILING
+        Profile sample = Profile::between(start, ProfileMark::now());
+        sample.bytes = sample.planeOps*sizeof(VECTOR);
+        sample.lanes = output.size();
+        sample.activeLanes = activeLanes;
+        (backward ? backwardProfile : forwardProfile)[layer] += sample;
+        if(tracing)
+            trace.push_back(ProfileEvent{layer, backward, start.nanoseconds, sample});
+        #endif
+    }
+
+    static long long activeLanes(const Tensor &input) {
+        return input.size()-POPCOUNT(input == Tensor());
+    }
+
+    std::vector<std::string> layerNames() const {
+        std::vector<std::string> names;
+        for(const auto& layer : layers) {
+            std::string description = layer->describe();
+            names.push_back(description.substr(0, description.find('\n')));
+        }
+        return names;
+    }
 
 public:
     Layered() {
@@ -46,23 +89,125 @@ public:
 
     Layered& add(const std::shared_ptr<Neural<Tensor>> &layer) {
         layers.push_back(layer);
+        telemetry.push_back(Telemetry());
+        forwardProfile.push_back(Profile());
+        backwardProfile.push_back(Profile());
         return *this;
     }
 
+    int num_layers() const {
+        return layers.size();
+    }
+
+    const std::shared_ptr<Neural<Tensor>>& layer(int i) const {
+        return layers[i];
+    }
+
     virtual Tensor forward(const Tensor &input) {
         Tensor in = input;
-        for(const auto& layer : layers) 
-            in = layer->forward(in);
+        for(int i=0;i<layers.size();++i) {
+            #ifdef TELEMETRY
+            Telemetry before = threadTelemetry();
+            #endif
+            #ifdef PROFILING
+            long long active = activeLanes(in);
+            ProfileMark start = ProfileMark::now();
+            #endif
+            in = layers[i]->forward(in);
+            #ifdef PROFILING
+            profile(i, false, start, active, in);
+            #endif
+            #ifdef TELEMETRY
+            record(i, before, in);
+            #endif
+        }
         return in;
     }
 
     virtual Tensor backward(const Tensor &error, Optimizer<Tensor> &optimizer) {
-        Tensor err = err;
-        for(int i=layers.size()-1;i>=0;--i)
+        Tensor err = error;
+        for(int i=layers.size()-1;i>=0;--i) {
+            #ifdef TELEMETRY
+            Telemetry before = threadTelemetry();
+            #endif
+            #ifdef PROFILING
+            long long active = activeLanes(err);
+            ProfileMark start = ProfileMark::now();
+            #endif
             err = layers[i]->backward(err, optimizer);
+            #ifdef PROFILING
+            profile(i, true, start, active, err);
+            #endif
+            #ifdef TELEMETRY
+            record(i, before, err);
+            #endif
+        }
         return err;
     }
 
+    // per-layer counters of forward and backward passes; these stay zero unless compiled with TELEMETRY. Threads
+    // that share the model add to them under a lock, so they are returned as a copy.
+    std::vector<Telemetry> layerTelemetry() const {
+        std::lock_guard<std::mutex> lock(telemetryLock.mutex);
+        return telemetry;
+    }
+
+    Telemetry totalTelemetry() const {
+        Telemetry ret;
+        for(const auto& counters : layerTelemetry()) 
+            ret += counters;
+        return ret;
+    }
+
+    void resetTelemetry() {
+        std::lock_guard<std::mutex> lock(telemetryLock.mutex);
+        for(auto& counters : telemetry) 
+            counters = Telemetry();
+    }
+
+    std::string describeTelemetry() const {
+        std::vector<Telemetry> counters = layerTelemetry();
+        std::string description;
+        for(int i=0;i<counters.size();++i)
+            description += "Layer " + std::to_string(i) + ": " + counters[i].describe() + "\n";
+        return description;
+    }
+
+    // per-layer time and op counts of forward and backward passes; these stay zero unless compiled with PROFILING
+    const std::vector<Profile>& layerProfile(bool backward=false) const {
+        return backward ? backwardProfile : forwardProfile;
+    }
+
+    // keeps one event per layer call for chromeTrace; off by default so that long runs do not grow memory
+    void setTracing(bool enabled) {
+        tracing = enabled;
+    }
+
+    void resetProfile() {
+        for(auto& sample : forwardProfile) 
+            sample = Profile();
+        for(auto& sample : backwardProfile) 
+            sample = Profile();
+        trace.clear();
+    }
+
+    std::string profileJSON() const {
+        std::vector<std::string> names = layerNames();
+        std::string json = "{\"layers\": [";
+        for(int i=0;i<layers.size();++i) {
+            if(i)
+                json += ",";
+            json += "\n  {\"name\": " + jsonString(names[i]) 
+                  + ", \"forward\": " + forwardProfile[i].json() 
+                  + ", \"backward\": " + backwardProfile[i].json() + "}";
+        }
+        return json + "\n]}\n";
+    }
+
+    std::string chromeTrace() const {
+        return tensorless::chromeTrace(trace, layerNames());
+    }
+
     virtual void zerograd() {
         for(const auto& layer : layers) 
             layer->zerograd();
@@ -0,0 +1,107 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef TENSORLESS_LAYERNORM_H
+#define TENSORLESS_LAYERNORM_H
+
+#include <iostream>
+#include <vector>
+#include "neural.h"
+#include "../types/all.h"
+#include <cmath>
+#include <algorithm>
+
+namespace tensorless {
+
+// sums of squares of centered values: the approximate multiplication loses most bits of small products, so
+// values are scaled to a peak of one before squaring, and Dynamic types scale their body
+template <typename Tensor>
+struct LayerNormSquares {
+    static double sum(const Tensor &centered) {
+        Tensor negated = Tensor()-centered;
+        double peak = std::max(centered.get(centered.argmax()), negated.get(negated.argmax()));
+        if(peak<=0)
+            return 0;
+        double factor = std::min(1.0, (double)Tensor::sup())/peak;
+        Tensor widened = centered.scale(factor);
+        return (widened*widened).sum()/(factor*factor);
+    }
+};
+
+template <typename Number>
+struct LayerNormSquares<Dynamic<Number>> {
+    static double sum(const Dynamic<Number> &centered) {
+        double mantisa = centered.getMantisa();
+        return LayerNormSquares<Number>::sum(centered.getBody())*mantisa*mantisa;
+    }
+};
+
+template <typename Tensor, int size>
+class LayerNorm: public Neural<Tensor> {
+private:
+    Tensor gain;
+    Tensor bias;
+    VECTOR lanes;
+    Tensor normalized;
+    double invstd;
+    double eps;
+
+public:
+    LayerNorm(double eps=0.001) : gain(Tensor()), bias(Tensor()), lanes(0), invstd(1), eps(eps) {
+        for (int i=0; i<size; ++i) 
+            lanes |= ONEHOT(i);
+        gain = gain.merge(Tensor::broadcast(1), ~lanes);
+    }
+
+    virtual std::string describe() const {
+        std::string description;
+        int paramSpace = Tensor::num_bits()*2/8;
+        description += "LayerNorm";
+        description += "\n  Size     " + std::to_string(size);
+        description += "\n  Params   " + std::to_string(Tensor::num_params()*2)
+                            +" ("+std::to_string(paramSpace)+" bytes)";
+        description += "\n";
+        return description;
+    }
+
+    virtual Tensor forward(const Tensor& input) {
+        // statistics come from block reductions, and normalization is a single broadcast
+        // multiplication (a pure mantisa update for Dynamic tensors)
+        double mean = input.sum()/size;
+        Tensor centered = (input-Tensor::broadcast(mean)).merge(Tensor(), lanes);
+        double variance = LayerNormSquares<Tensor>::sum(centered)/size;
+        invstd = 1/std::sqrt(variance+eps);
+        normalized = centered.scale(invstd);
+        return normalized*gain+bias;
+    }
+
+    virtual Tensor backward(const Tensor &error, Optimizer<Tensor> &optimizer) {
+        Tensor grad = error*gain;
+        double meanGrad = grad.sum()/size;
+        double meanGradNormalized = (grad*normalized).sum()/size;
+        Tensor inputGrad = (grad-Tensor::broadcast(meanGrad)-normalized*Tensor::broadcast(meanGradNormalized)).merge(Tensor(), lanes);
+        optimizer.update(gain, error*normalized);
+        optimizer.update(bias, error.merge(Tensor(), lanes));
+        return inputGrad.scale(invstd);
+    }
+
+    virtual void zerograd() {
+    }
+};
+
+}
+#endif  // TENSORLESS_LAYERNORM_H
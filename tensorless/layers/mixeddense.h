@@ -0,0 +1,110 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef TENSORLESS_MIXEDDENSE_H
+#define TENSORLESS_MIXEDDENSE_H
+
+#include <iostream>
+#include <vector>
+#include "neural.h"
+#include "../types/all.h"
+#include <cmath>
+
+namespace tensorless {
+
+// dense layer whose weights are stored in a narrower type than its activations; outputs are computed by the 
+// cross-type dot kernel, so weights are never widened during inference. Training keeps full activation-precision 
+// master weights (widened on the first backward pass), which are requantized with whole-block operations and
+// masked to the input lanes once all rows of an optimizer step are updated.
+template <typename WeightT, typename ActT, int ins, int outs>
+class MixedDense: public Neural<ActT> {
+private:
+    WeightT weights[outs];
+    double biases[outs];
+    bool activations[outs];
+    std::vector<ActT> master;
+    VECTOR lanes;
+    ActT input;
+
+public:
+    MixedDense(): lanes(0) {
+        for (int j=0; j<ins; ++j) 
+            lanes |= ONEHOT(j);
+        for (int i=0; i<outs;++i) {
+            weights[i] = WeightT::random().merge(WeightT(), lanes);
+            biases[i] = 0;
+            activations[i] = false;
+        }
+    }
+
+    double weight(int output, int input) const {
+        return weights[output].get(input);
+    }
+
+    double bias(int output) const {
+        return biases[output];
+    }
+
+    virtual std::string describe() const {
+        std::string description;
+        int paramSpace = WeightT::num_bits()*outs/8+outs*sizeof(double);
+        description += "MixedDense";
+        description += "\n  Inputs   " + std::to_string(ins);
+        description += "\n  Outputs  " + std::to_string(outs);
+        description += "\n  Params   " + std::to_string(WeightT::num_params()*outs+outs)
+                            +" ("+std::to_string(paramSpace)+" bytes, "+std::to_string(paramSpace/sizeof(float)*100/ins/outs)+"% of float)";
+        description += "\n";
+        return description;
+    }
+
+    virtual ActT forward(const ActT& input) {
+        this->input = input;
+        ActT out = ActT();
+        for (int i=0;i<outs;++i) {
+            double sum = dot(input, weights[i])+biases[i];
+            activations[i] = sum>0;
+            if(activations[i]) // relu
+                out.set(i, sum);
+        }
+        return out;
+    }
+
+    virtual ActT backward(const ActT &error, Optimizer<ActT> &optimizer) {
+        if(master.empty())
+            for (int i=0;i<outs;++i)
+                master.push_back(widen<ActT>(weights[i]));
+        ActT err;
+        for (int i=0;i<outs;++i) {
+            double errori = activations[i]?error.get(i):0;
+            ActT scale = ActT::broadcast(errori);
+            if(errori)
+                err = err + master[i]*scale;
+            optimizer.update(master[i], input*scale);
+            optimizer.update(biases[i], errori);
+        }
+        // stateful optimizers move master weights even without an error
+        for (int i=0;i<outs;++i)
+            weights[i] = requantize<WeightT>(master[i], lanes);
+        return err.merge(ActT(), lanes);
+    }
+
+    virtual void zerograd() {
+    }
+};
+
+}
+#endif  // TENSORLESS_MIXEDDENSE_H
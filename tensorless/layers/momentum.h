@@ -0,0 +1,77 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef TENSORLESS_MOMENTUM_H
+#define TENSORLESS_MOMENTUM_H
+
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include "neural.h"
+#include "../types/all.h"
+#include <cmath>
+
+namespace tensorless {
+
+// velocities are kept per parameter in the parameter's own packed type and are updated with whole-block arithmetic;
+// like Adam's moments, they are keyed by the parameter's address and restart when the parameter no longer holds the
+// value last written to it
+template <typename Tensor>
+class Momentum: public Optimizer<Tensor> {
+    template <typename Value>
+    struct Velocity {
+        Value velocity = Value();
+        Value last = Value();
+        bool started = false;
+    };
+    double lr;
+    double beta;
+    std::unordered_map<const Tensor*, Velocity<Tensor>> velocities;
+    std::unordered_map<const double*, Velocity<double>> scalarVelocities;
+public:
+    Momentum(double lr=0.001, double beta=0.9) : lr(lr), beta(beta) {}
+    virtual void update(Tensor &param, const Tensor &grads, double lr_mult=1) {
+        Velocity<Tensor> &state = velocities[&param];
+        if(state.started && ~(param==state.last))
+            state = Velocity<Tensor>();
+        state.velocity = state.velocity.scale(beta) + grads;
+        param = param + state.velocity.scale(lr_mult*lr);
+        state.last = param;
+        state.started = true;
+    }
+    virtual void update(double &param, double grads, double lr_mult=1) {
+        Velocity<double> &state = scalarVelocities[&param];
+        if(state.started && param!=state.last)
+            state = Velocity<double>();
+        state.velocity = state.velocity*beta + grads;
+        param = param + state.velocity*lr_mult*lr;
+        state.last = param;
+        state.started = true;
+    }
+    // forgets all velocities, e.g. after loading new parameters
+    void reset() {
+        velocities.clear();
+        scalarVelocities.clear();
+    }
+    int num_states() const {
+        return velocities.size()+scalarVelocities.size();
+    }
+};
+
+
+}
+#endif  // TENSORLESS_MOMENTUM_H
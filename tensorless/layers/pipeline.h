@@ -0,0 +1,220 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef TENSORLESS_PIPELINE_H
+#define TENSORLESS_PIPELINE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "neural.h"
+#include "layered.h"
+#include "../types/all.h"
+#include "../types/ring.h"
+
+namespace tensorless {
+
+// Pipelined inference of a Layered model for streams of samples. Consecutive groups of layers (stages) run on
+// their own pinned threads and hand micro-batches of activations to the next stage through single-producer
+// single-consumer rings, so that a deep network keeps one core per stage busy instead of running all layers
+// of a sample on one core. Stages are balanced by timing the forward pass of each layer on a sample input.
+// Layers keep per-sample state (e.g. the last input of Dense), so the model should not run elsewhere while a
+// pipeline uses it, and only forward passes are pipelined.
+template <typename Tensor>
+class Pipeline {
+private:
+    struct MicroBatch {
+        std::vector<Tensor> samples;
+    };
+
+    std::vector<std::shared_ptr<Neural<Tensor>>> layers;
+    std::vector<int> firstLayer;      // stage s runs layers [firstLayer[s], firstLayer[s+1])
+    std::vector<double> stageSeconds; // estimated time of each stage per sample
+    std::vector<std::unique_ptr<SpscRing<MicroBatch>>> rings; // ring s feeds stage s, the last one holds outputs
+    std::vector<std::thread> threads;
+    std::atomic<bool> stopping;
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    int microBatch;
+
+    static std::vector<double> layerSeconds(const std::vector<std::shared_ptr<Neural<Tensor>>> &layers, const Tensor &sample) {
+        std::vector<double> seconds(layers.size(), 0);
+        for(int repeat=0;repeat<5;++repeat) {
+            Tensor in = sample;
+            for(int i=0;i<layers.size();++i) {
+                auto start = std::chrono::steady_clock::now();
+                in = layers[i]->forward(in);
+                seconds[i] += std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count()/5;
+            }
+        }
+        return seconds;
+    }
+
+    // contiguous split of the layers into stages that minimizes the slowest stage
+    void balance(const std::vector<double> &seconds, int stages) {
+        int n = seconds.size();
+        std::vector<double> prefix(n+1, 0);
+        for(int i=0;i<n;++i)
+            prefix[i+1] = prefix[i]+seconds[i];
+        // slowest[k][i]: slowest stage when the first i layers form k stages, split[k][i]: where the last one starts
+        std::vector<std::vector<double>> slowest(stages+1, std::vector<double>(n+1, INFINITY));
+        std::vector<std::vector<int>> split(stages+1, std::vector<int>(n+1, 0));
+        slowest[0][0] = 0;
+        for(int k=1;k<=stages;++k)
+            for(int i=k;i<=n;++i)
+                for(int j=k-1;j<i;++j) {
+                    double candidate = std::max(slowest[k-1][j], prefix[i]-prefix[j]);
+                    if(candidate<slowest[k][i]) {
+                        slowest[k][i] = candidate;
+                        split[k][i] = j;
+                    }
+                }
+        firstLayer.assign(stages+1, n);
+        for(int k=stages, i=n;k>0;--k) {
+            i = split[k][i];
+            firstLayer[k-1] = i;
+        }
+        for(int k=0;k<stages;++k)
+            stageSeconds.push_back(prefix[firstLayer[k+1]]-prefix[firstLayer[k]]);
+    }
+
+    void stage(int s) {
+        ThreadPool::Sequential sequential; // the stage owns its core, so its layers do not use the pool
+        SpscRing<MicroBatch> &in = *rings[s];
+        SpscRing<MicroBatch> &out = *rings[s+1];
+        while(true) {
+            MicroBatch *batch = in.frontWait(stopping);
+            if(!batch)
+                return;
+            MicroBatch *next = out.claimWait(stopping);
+            if(!next)
+                return;
+            next->samples.resize(batch->samples.size());
+            try {
+                for(int j=0;j<batch->samples.size();++j) {
+                    Tensor activations = batch->samples[j];
+                    for(int i=firstLayer[s];i<firstLayer[s+1];++i)
+                        activations = layers[i]->forward(activations);
+                    next->samples[j] = activations;
+                }
+            }
+            catch(...) {
+                // the micro-batch still moves on so that run() does not wait forever
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if(!error)
+                    error = std::current_exception();
+            }
+            in.release();
+            out.publish();
+        }
+    }
+
+public:
+    // stages defaults to one per thread of ThreadPool::global() (and at most one per layer); every ring holds
+    // capacity micro-batches of microBatch samples
+    Pipeline(const Layered<Tensor> &model, int stages=0, int microBatch=8, int capacity=4, const Tensor &sample=Tensor())
+        : stopping(false), microBatch(microBatch) {
+        if(model.num_layers()==0)
+            throw std::logic_error("cannot pipeline a model without layers");
+        if(microBatch<1 || capacity<1)
+            throw std::logic_error("micro-batches and rings need at least one slot");
+        for(int i=0;i<model.num_layers();++i)
+            layers.push_back(model.layer(i));
+        if(stages<=0)
+            stages = ThreadPool::global().size();
+        stages = std::min(stages, (int)layers.size());
+        balance(layerSeconds(layers, sample), stages);
+        for(int s=0;s<=stages;++s)
+            rings.emplace_back(new SpscRing<MicroBatch>(capacity));
+        int cores = std::thread::hardware_concurrency();
+        for(int s=0;s<stages;++s) {
+            threads.emplace_back(&Pipeline::stage, this, s);
+            if(cores>stages)
+                pinThread(threads.back(), (s+1)%cores);
+        }
+    }
+
+    ~Pipeline() {
+        stopping.store(true);
+        for(auto& ring : rings)
+            ring->wake();
+        for(auto& thread : threads)
+            thread.join();
+    }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    int num_stages() const {
+        return threads.size();
+    }
+
+    std::string describe() const {
+        std::string description;
+        for(int s=0;s<num_stages();++s)
+            description += "Stage " + std::to_string(s) + ": layers " + std::to_string(firstLayer[s]) + "-"
+                         + std::to_string(firstLayer[s+1]-1) + ", " + std::to_string(stageSeconds[s]*1.E6) + " us per sample\n";
+        return description;
+    }
+
+    // outputs of the model for a stream of inputs, in order; the calling thread feeds the first ring and
+    // drains the last one
+    std::vector<Tensor> run(const std::vector<Tensor> &inputs) {
+        std::vector<Tensor> outputs(inputs.size());
+        size_t fed = 0;
+        size_t collected = 0;
+        int idle = 0;
+        while(collected<inputs.size()) {
+            bool progress = false;
+            MicroBatch *batch;
+            if(fed<inputs.size() && (batch = rings.front()->claim())) {
+                size_t count = std::min((size_t)microBatch, inputs.size()-fed);
+                batch->samples.assign(inputs.begin()+fed, inputs.begin()+fed+count);
+                rings.front()->publish();
+                fed += count;
+                progress = true;
+            }
+            if((batch = rings.back()->front())) {
+                std::copy(batch->samples.begin(), batch->samples.end(), outputs.begin()+collected);
+                collected += batch->samples.size();
+                rings.back()->release();
+                progress = true;
+            }
+            if(progress)
+                idle = 0;
+            else if(++idle>1000)
+                std::this_thread::yield();
+        }
+        if(error) {
+            std::exception_ptr thrown = error;
+            error = nullptr;
+            std::rethrow_exception(thrown);
+        }
+        return outputs;
+    }
+};
+
+}
+#endif  // TENSORLESS_PIPELINE_H
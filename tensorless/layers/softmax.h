@@ -0,0 +1,145 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef TENSORLESS_SOFTMAX_H
+#define TENSORLESS_SOFTMAX_H
+
+#include <iostream>
+#include <vector>
+#include "neural.h"
+#include "../types/all.h"
+#include <cmath>
+#include <algorithm>
+
+namespace tensorless {
+
+// differences from the maximum below this range have weights under exp(-SOFTMAX_RANGE) and are clamped there
+#define SOFTMAX_RANGE 8.0
+
+// Exponents are looked up on packed scores x whose lanes stand for differences factor*x from the maximum input.
+// Signed scores halve both operands, so that differences of up to twice the range do not wrap.
+template <typename Tensor>
+struct SoftmaxScores {
+    typedef Tensor type;
+    static constexpr double factor() {return 2;}
+    static double max(const Tensor &input, const VECTOR &lanes) {
+        return input.get(input.argmax(lanes));
+    }
+    static type differences(const Tensor &input, double max) {
+        return input.half()-Tensor::broadcast(max/2);
+    }
+    // twice the exponents are divided exactly by their sum, written as a significand in the body range shifted
+    // by its exponent, and halving that quotient while adding its lowest bit back rounds to nearest, so that
+    // probabilities of many lanes do not all lose a step
+    static Tensor probabilities(const type &exps, double total) {
+        int exponent;
+        double significand = std::frexp(total, &exponent);
+        if(significand>Tensor::sup()) {
+            significand /= 2;
+            exponent++;
+        }
+        Tensor twice = exps.divide(Tensor::broadcast(significand), 1-exponent, ~(VECTOR)0);
+        VECTOR planes[MAX_ARITHMETIC_PLANES];
+        twice.toPlanes(planes);
+        return twice.half()+Tensor::broadcast(Tensor::eps()).merge(Tensor(), planes[0]);
+    }
+};
+
+// Floating sums are renormalized and never wrap; lookup tables cover types of up to 10 planes (float10)
+template <typename Number, typename Mantisa>
+struct SoftmaxScores<Floating<Number, Mantisa>> {
+    typedef Floating<Number, Mantisa> type;
+    static_assert(type::num_params()<=10, "Softmax looks up exponents on whole Floating encodings, of up to 10 planes");
+    static constexpr double factor() {return 1;}
+    static double max(const type &input, const VECTOR &lanes) {
+        return input.get(input.argmax(lanes));
+    }
+    static type differences(const type &input, double max) {
+        return input-type::broadcast(max);
+    }
+    static type probabilities(const type &exps, double total) {
+        return exps/type::broadcast(total);
+    }
+};
+
+// Dynamic scores are bodies whose range stands for differences down to -SOFTMAX_RANGE, which scale() saturates
+// at, and probabilities only change the shared mantisa
+template <typename Number>
+struct SoftmaxScores<Dynamic<Number>> {
+    typedef Number type;
+    static constexpr double factor() {return SOFTMAX_RANGE/Number::sup();}
+    static double max(const Dynamic<Number> &input, const VECTOR &lanes) {
+        Number body = input.getMantisa()<0 ? Number()-input.getBody() : input.getBody();
+        return input.get(body.argmax(lanes));
+    }
+    static type differences(const Dynamic<Number> &input, double max) {
+        double mantisa = input.getMantisa();
+        type halved = input.getBody().half()-Number::broadcast(max/mantisa/2);
+        return halved.scale(2*mantisa/factor());
+    }
+    static Dynamic<Number> probabilities(const type &exps, double total) {
+        return Dynamic<Number>::broadcast(1/total).withBody(exps);
+    }
+};
+
+// Softmax over the first size lanes, whose exponents come from one lookup table on packed scores. Exponents are
+// scaled to peak at one, or at the largest value of types whose range stays below one.
+template <typename Tensor, int size>
+class Softmax: public Neural<Tensor> {
+private:
+    typedef typename SoftmaxScores<Tensor>::type Scores;
+    Lut<Scores> exp;
+    VECTOR lanes;
+    Tensor output;
+
+public:
+    Softmax() : exp(Lut<Scores>::fromFunction([](double x) {
+            return std::min(1.0, (double)Scores::sup())*std::exp(SoftmaxScores<Tensor>::factor()*x);
+        })), lanes(0) {
+        for (int i=0; i<size; ++i) 
+            lanes |= ONEHOT(i);
+    }
+
+    virtual std::string describe() const {
+        std::string description;
+        description += "Softmax";
+        description += "\n  Size     " + std::to_string(size);
+        description += "\n  Exp LUT  " + std::to_string(exp.num_nodes()) + " nodes";
+        description += "\n";
+        return description;
+    }
+
+    virtual Tensor forward(const Tensor& input) {
+        // differences from the maximum keep all exponents in (0,1], and dividing by their sum is a constant
+        // multiplication
+        double max = SoftmaxScores<Tensor>::max(input, lanes);
+        Scores exps = exp(SoftmaxScores<Tensor>::differences(input, max)).merge(Scores(), lanes);
+        output = SoftmaxScores<Tensor>::probabilities(exps, exps.sum());
+        return output;
+    }
+
+    virtual Tensor backward(const Tensor &error, Optimizer<Tensor> &optimizer) {
+        double dot = (error*output).sum();
+        return output*(error-Tensor::broadcast(dot));
+    }
+
+    virtual void zerograd() {
+    }
+};
+
+}
+#endif  // TENSORLESS_SOFTMAX_H
@@ -0,0 +1,218 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef TENSORLESS_SPARSEDENSE_H
+#define TENSORLESS_SPARSEDENSE_H
+
+#include <iostream>
+#include <vector>
+#include "neural.h"
+#include "../types/all.h"
+#include <cmath>
+
+namespace tensorless {
+
+#define SPARSEDENSE_LANEWISE_NONZEROS 16
+
+// dense layer that keeps only the outputs whose weights have nonzero lanes, alongside their support masks;
+// outputs whose support does not overlap the nonzero lanes of the input skip the multiply and popcount entirely
+//
+// Rows with at most SPARSEDENSE_LANEWISE_NONZEROS nonzero weights are also listed as (lane, weight) pairs and
+// multiplied lane by lane against the input lanes they read, which are unpacked once per forward, so that their
+// cost grows with their nonzeros instead of with the planes of a packed product. These sums multiply the lane
+// values exactly, so they can differ from Dense by the truncation of its packed products.
+template <typename Tensor, int ins, int outs>
+class SparseDense: public Neural<Tensor> {
+private:
+    std::vector<int> rows;
+    std::vector<Tensor> weights;
+    std::vector<VECTOR> support;
+    std::vector<double> biases;
+    std::vector<int> laneStart;  // row k lists its lanes in [laneStart[k], laneStart[k+1]), empty for packed rows
+    std::vector<int> laneIndex;
+    std::vector<double> laneWeight;
+    VECTOR laneWiseSupport;
+    bool activations[outs];
+    Tensor input;
+    VECTOR inputSupport;
+
+    static VECTOR nonZeros(const Tensor &tensor) {
+        return ~(tensor == Tensor());
+    }
+
+    void tabulate() {
+        laneStart.assign(1, 0);
+        laneIndex.clear();
+        laneWeight.clear();
+        laneWiseSupport = 0;
+        for(int k=0;k<rows.size();++k) {
+            if(bitcount(support[k])<=SPARSEDENSE_LANEWISE_NONZEROS) {
+                laneWiseSupport |= support[k];
+                VECTOR remaining = support[k];
+                while(ANY(remaining)) {
+                    int lane = FIRSTONE(remaining);
+                    laneIndex.push_back(lane);
+                    laneWeight.push_back(weights[k].get(lane));
+                    remaining &= ~ONEHOT(lane);
+                }
+            }
+            laneStart.push_back(laneIndex.size());
+        }
+    }
+
+    void compact() {
+        int kept = 0;
+        for(int k=0;k<rows.size();++k) {
+            support[k] = nonZeros(weights[k]);
+            if(!ANY(support[k]))
+                continue;
+            rows[kept] = rows[k];
+            weights[kept] = weights[k];
+            support[kept] = support[k];
+            biases[kept] = biases[k];
+            kept++;
+        }
+        rows.resize(kept);
+        weights.resize(kept);
+        support.resize(kept);
+        biases.resize(kept);
+        tabulate();
+    }
+
+public:
+    // each weight lane is kept with probability density
+    SparseDense(double density=1) : laneWiseSupport(0), inputSupport(0) {
+        std::uniform_real_distribution<double> keep(0, 1);
+        VECTOR lanes = 0;
+        for (int j=0; j<ins; ++j) 
+            lanes |= ONEHOT(j);
+        for (int i=0; i<outs; ++i) {
+            VECTOR mask = 0;
+            for (int j=0; j<ins; ++j) 
+                if(keep(generator)<density)
+                    mask |= ONEHOT(j);
+            rows.push_back(i);
+            weights.push_back(Tensor::random().merge(Tensor(), mask & lanes));
+            support.push_back(0);
+            biases.push_back(0);
+            activations[i] = false;
+        }
+        compact();
+    }
+
+    // zeroes weights whose magnitude is below the threshold and drops outputs that are left without weights
+    SparseDense& prune(double threshold) {
+        for(int k=0;k<rows.size();++k) {
+            VECTOR small = (weights[k] < Tensor::broadcast(threshold)) & (weights[k] > Tensor::broadcast(-threshold));
+            weights[k] = weights[k].merge(Tensor(), ~small);
+        }
+        compact();
+        return *this;
+    }
+
+    int num_rows() const {
+        return rows.size();
+    }
+
+    // zero for outputs that are not stored
+    double weight(int output, int input) const {
+        for(int k=0;k<rows.size();++k)
+            if(rows[k]==output)
+                return weights[k].get(input);
+        return 0;
+    }
+
+    double bias(int output) const {
+        for(int k=0;k<rows.size();++k)
+            if(rows[k]==output)
+                return biases[k];
+        return 0;
+    }
+
+    int num_nonzeros() const {
+        int ret = 0;
+        for(int k=0;k<rows.size();++k)
+            ret += bitcount(support[k]);
+        return ret;
+    }
+
+    virtual std::string describe() const {
+        std::string description;
+        int nonzeros = num_nonzeros();
+        int paramSpace = Tensor::num_bits()*rows.size()/8+rows.size()*(sizeof(double)+sizeof(int)+sizeof(VECTOR))
+                         +laneIndex.size()*(sizeof(int)+sizeof(double));
+        description += "SparseDense";
+        description += "\n  Inputs   " + std::to_string(ins);
+        description += "\n  Outputs  " + std::to_string(outs) + " (" + std::to_string(rows.size()) + " stored)";
+        description += "\n  Nonzeros " + std::to_string(nonzeros) + " (" + std::to_string(nonzeros*100/ins/outs) + "% density)";
+        description += "\n  Params   " + std::to_string(Tensor::num_params()*rows.size()+rows.size())
+                            +" ("+std::to_string(paramSpace)+" bytes)";
+        description += "\n";
+        return description;
+    }
+
+    virtual Tensor forward(const Tensor& input) {
+        this->input = input;
+        inputSupport = nonZeros(input);
+        Tensor out = Tensor();
+        for (int i=0;i<outs;++i)
+            activations[i] = false;
+        double values[ins] = {};
+        VECTOR needed = laneWiseSupport & inputSupport;
+        while(ANY(needed)) {
+            int lane = FIRSTONE(needed);
+            values[lane] = input.get(lane);
+            needed &= ~ONEHOT(lane);
+        }
+        for (int k=0;k<rows.size();++k) {
+            double sum = biases[k];
+            if(laneStart[k+1]>laneStart[k]) {
+                for(int l=laneStart[k];l<laneStart[k+1];++l)
+                    sum += laneWeight[l]*values[laneIndex[l]];
+            }
+            else if(ANY(support[k] & inputSupport))
+                sum += (input*weights[k]).sum();
+            activations[rows[k]] = sum>0;
+            if(activations[rows[k]]) // relu
+                out.set(rows[k], sum);
+        }
+        return out;
+    }
+
+    // gradients are restricted to the support, so pruned weights stay zero during training
+    virtual Tensor backward(const Tensor &error, Optimizer<Tensor> &optimizer) {
+        Tensor err;
+        for (int k=0;k<rows.size();++k) {
+            double errork = activations[rows[k]]?error.get(rows[k]):0;
+            Tensor scale = Tensor::broadcast(errork);
+            if(errork)
+                err = err + weights[k]*scale;
+            Tensor grad = errork && ANY(support[k] & inputSupport) ? (input*scale).merge(Tensor(), support[k]) : Tensor();
+            optimizer.update(weights[k], grad);
+            optimizer.update(biases[k], errork);
+            for(int l=laneStart[k];l<laneStart[k+1];++l)
+                laneWeight[l] = weights[k].get(laneIndex[l]);
+        }
+        return err;
+    }
+
+    virtual void zerograd() {
+    }
+};
+
+}
+#endif  // TENSORLESS_SPARSEDENSE_H
@@ -0,0 +1,136 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef TENSORLESS_TERNARYDENSE_H
+#define TENSORLESS_TERNARYDENSE_H
+
+#include <iostream>
+#include <vector>
+#include "neural.h"
+#include "../types/all.h"
+#include <cmath>
+
+namespace tensorless {
+
+// dense layer with weights and activations in {-1,0,1}, each stored as a sign plane plus a nonzero mask; outputs are
+// bitcount(agreeing nonzeros)-bitcount(disagreeing nonzeros), scaled by 1/ins. Latent weights whose magnitude does 
+// not exceed weightThreshold become zero, as do inputs whose magnitude does not exceed inputThreshold.
+template <typename Tensor, int ins, int outs>
+class TernaryDense: public Neural<Tensor> {
+protected:
+    Tensor latent[outs];
+    VECTOR negative[outs];
+    VECTOR nonZero[outs];
+    VECTOR lanes;
+    Tensor input;
+    VECTOR inputNegative;
+    VECTOR inputNonZero;
+    double weightThreshold;
+    double inputThreshold;
+    double clip;
+
+    VECTOR exceeds(const Tensor &values, double threshold) const {
+        if(threshold==0)
+            return ~(values == Tensor()) & lanes;
+        return ((values > Tensor::broadcast(threshold)) | (values < Tensor::broadcast(-threshold))) & lanes;
+    }
+
+    void ternarize(int i) {
+        negative[i] = (latent[i] < Tensor()) & lanes;
+        nonZero[i] = exceeds(latent[i], weightThreshold);
+    }
+
+    // straight-through estimator hook: lanes of values through which gradients pass (those within [-clip, clip])
+    virtual VECTOR straightThrough(const Tensor &values) const {
+        VECTOR outside = 0;
+        if(clip<Tensor::sup())
+            outside |= values > Tensor::broadcast(clip);
+        if(-clip>Tensor::inf())
+            outside |= values < Tensor::broadcast(-clip);
+        return ~outside & lanes;
+    }
+
+public:
+    TernaryDense(double weightThreshold=0.25, double inputThreshold=0, double clip=1) 
+        : lanes(0), inputNegative(0), inputNonZero(0), weightThreshold(weightThreshold), inputThreshold(inputThreshold), clip(clip) {
+        for (int j=0; j<ins; ++j) 
+            lanes |= ONEHOT(j);
+        for (int i=0; i<outs; ++i) {
+            latent[i] = Tensor::random().merge(Tensor(), lanes);
+            ternarize(i);
+        }
+    }
+
+    // ternarized weight, -1, 0 or 1
+    int weight(int output, int input) const {
+        if(!GETAT(nonZero[output], input))
+            return 0;
+        return GETAT(negative[output], input) ? -1 : 1;
+    }
+
+    virtual std::string describe() const {
+        std::string description;
+        int paramSpace = 2*outs*ins/8;
+        int nonzeros = 0;
+        for (int i=0;i<outs;++i) 
+            nonzeros += bitcount(nonZero[i]);
+        description += "TernaryDense";
+        description += "\n  Inputs   " + std::to_string(ins);
+        description += "\n  Outputs  " + std::to_string(outs);
+        description += "\n  Nonzeros " + std::to_string(nonzeros);
+        description += "\n  Params   " + std::to_string(ins*outs)
+                            +" ("+std::to_string(paramSpace)+" bytes, "+std::to_string(paramSpace/sizeof(float)*100/ins/outs)+"% of float)";
+        description += "\n";
+        return description;
+    }
+
+    virtual Tensor forward(const Tensor& input) {
+        this->input = input;
+        inputNegative = (input < Tensor()) & lanes;
+        inputNonZero = exceeds(input, inputThreshold);
+        int dots[outs];
+        for (int i=0;i<outs;++i) {
+            VECTOR both = inputNonZero & nonZero[i];
+            VECTOR disagree = (inputNegative ^ negative[i]) & both;
+            dots[i] = bitcount(both)-2*bitcount(disagree);
+        }
+        return fromCounts<Tensor>(dots, outs, 1.0/ins);
+    }
+
+    // latent weights receive the unscaled output error (a 1/ins factor would fall below the packed resolution)
+    virtual Tensor backward(const Tensor &error, Optimizer<Tensor> &optimizer) {
+        Tensor err;
+        double scale = 1.0/ins;
+        for (int i=0;i<outs;++i) {
+            double errori = error.get(i);
+            if(errori) {
+                Tensor positiveError = Tensor::broadcast(errori*scale);
+                err = err + positiveError.merge(Tensor::broadcast(-errori*scale), ~negative[i]).merge(Tensor(), nonZero[i]);
+            }
+            Tensor grad = errori ? Tensor::broadcast(errori).merge(Tensor::broadcast(-errori), ~inputNegative).merge(Tensor(), inputNonZero & straightThrough(latent[i])) : Tensor();
+            optimizer.update(latent[i], grad);
+            ternarize(i);
+        }
+        return err.merge(Tensor(), straightThrough(input));
+    }
+
+    virtual void zerograd() {
+    }
+};
+
+}
+#endif  // TENSORLESS_TERNARYDENSE_H
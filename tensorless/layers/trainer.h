@@ -0,0 +1,264 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef TENSORLESS_TRAINER_H
+#define TENSORLESS_TRAINER_H
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <stdexcept>
+#include <cmath>
+#include "neural.h"
+#include "../types/all.h"
+
+namespace tensorless {
+
+// packed gradient sums are spilled to doubles at least once every this many gradients, since each Floating and
+// Dynamic addition rounds and the rounding grows with the sum
+#define ACCUMULATOR_SPILL 8
+
+// optimizer that records gradients instead of applying them; layers issue their updates in the same
+// order for every sample, so the n-th update of each sample (and of each replica) refers to the same parameter.
+// Packed gradients are summed until a lane would wrap or ACCUMULATOR_SPILL of them are pending, when the
+// pending sum is spilled to per-lane doubles; apply() writes each mean once, so that many small gradients
+// neither wrap nor truncate to zero.
+template <typename Tensor>
+class Accumulator: public Optimizer<Tensor> {
+    std::vector<Tensor*> params;
+    std::vector<Tensor> grads;
+    std::vector<std::vector<double>> spilled;  // empty until the first spill
+    std::vector<int> pending;
+    std::vector<double> lr_mults;
+    std::vector<double*> scalarParams;
+    std::vector<double> scalarGrads;
+    std::vector<double> scalarLr_mults;
+    int cursor = 0;
+    int scalarCursor = 0;
+    bool recorded = false;
+
+    // lanes where adding two values of the same sign flips it
+    static VECTOR wraps(const Tensor &a, const Tensor &b, const Tensor &sum) {
+        Tensor zero;
+        VECTOR positive = (a>=zero) & (b>=zero);
+        VECTOR negative = (a<zero) & (b<zero);
+        return (positive & (sum<zero)) | (negative & (sum>=zero));
+    }
+
+    void spill(int k) {
+        if(spilled[k].empty())
+            spilled[k].assign(grads[k].size(), 0);
+        for(int i=0;i<grads[k].size();++i)
+            spilled[k][i] += grads[k].get(i);
+        grads[k] = Tensor();
+        pending[k] = 0;
+    }
+
+    void accumulate(int k, const Tensor &grad, int count=1) {
+        Tensor sum = grads[k]+grad;
+        if(pending[k]+count>ACCUMULATOR_SPILL || ANY(wraps(grads[k], grad, sum))) {
+            spill(k);
+            sum = grad;
+        }
+        grads[k] = sum;
+        pending[k] += count;
+    }
+
+public:
+    virtual void update(Tensor &param, const Tensor &grad, double lr_mult=1) {
+        if(cursor==params.size()) {
+            if(recorded)
+                throw std::logic_error("layers issued a different number of updates than in previous samples");
+            params.push_back(&param);
+            grads.push_back(grad);
+            spilled.emplace_back();
+            pending.push_back(1);
+            lr_mults.push_back(lr_mult);
+        }
+        else 
+            accumulate(cursor, grad);
+        cursor++;
+    }
+
+    virtual void update(double &param, double grad, double lr_mult=1) {
+        if(scalarCursor==scalarParams.size()) {
+            if(recorded)
+                throw std::logic_error("layers issued a different number of updates than in previous samples");
+            scalarParams.push_back(&param);
+            scalarGrads.push_back(grad);
+            scalarLr_mults.push_back(lr_mult);
+        }
+        else 
+            scalarGrads[scalarCursor] += grad;
+        scalarCursor++;
+    }
+
+    // marks the end of a sample's backward pass
+    void rewind() {
+        if(cursor || scalarCursor)
+            recorded = true;
+        cursor = 0;
+        scalarCursor = 0;
+    }
+
+    void zerograd() {
+        for(int k=0;k<grads.size();++k) {
+            grads[k] = Tensor();
+            spilled[k].clear();
+            pending[k] = 0;
+        }
+        for(int k=0;k<scalarGrads.size();++k)
+            scalarGrads[k] = 0;
+    }
+
+    void add(const Accumulator<Tensor> &other) {
+        if(other.grads.size()!=grads.size() || other.scalarGrads.size()!=scalarGrads.size())
+            throw std::logic_error("can only add accumulators of identical models");
+        for(int k=0;k<grads.size();++k) {
+            accumulate(k, other.grads[k], other.pending[k]);
+            if(other.spilled[k].empty())
+                continue;
+            if(spilled[k].empty())
+                spilled[k].assign(other.spilled[k].size(), 0);
+            for(int i=0;i<spilled[k].size();++i)
+                spilled[k][i] += other.spilled[k][i];
+        }
+        for(int k=0;k<scalarGrads.size();++k)
+            scalarGrads[k] += other.scalarGrads[k];
+    }
+
+    // passes the accumulated gradients, scaled by scale, to an actual optimizer; the lane of largest magnitude
+    // is written first, so that Dynamic tensors pick their shared scale once
+    void apply(Optimizer<Tensor> &optimizer, double scale) {
+        for(int k=0;k<grads.size();++k) {
+            std::vector<double> totals(grads[k].size());
+            int largest = 0;
+            for(int i=0;i<totals.size();++i) {
+                totals[i] = grads[k].get(i)+(spilled[k].empty() ? 0 : spilled[k][i]);
+                if(std::abs(totals[i])>std::abs(totals[largest]))
+                    largest = i;
+            }
+            Tensor mean;
+            if(totals[largest])
+                mean.set(largest, totals[largest]*scale);
+            for(int i=0;i<totals.size();++i)
+                if(i!=largest && totals[i])
+                    mean.set(i, totals[i]*scale);
+            optimizer.update(*params[k], mean, lr_mults[k]);
+        }
+        for(int k=0;k<scalarGrads.size();++k)
+            optimizer.update(*scalarParams[k], scalarGrads[k]*scale, scalarLr_mults[k]);
+    }
+
+    // copies parameter values from the (identically structured) model recorded by another accumulator
+    void copyParams(const Accumulator<Tensor> &other) {
+        if(other.params.size()!=params.size() || other.scalarParams.size()!=scalarParams.size())
+            throw std::logic_error("can only copy parameters between identical models");
+        for(int k=0;k<params.size();++k)
+            *params[k] = *other.params[k];
+        for(int k=0;k<scalarParams.size();++k)
+            *scalarParams[k] = *other.scalarParams[k];
+    }
+
+    int num_updates() const {
+        return params.size()+scalarParams.size();
+    }
+};
+
+
+// data-parallel mini-batch training: each replica of the model (and hence of its activations) is a task of
+// ThreadPool::global() that accumulates gradients over its share of the batch, and replicas are combined with a tree reduction before
+// a single optimizer step whose result is copied back to all replicas
+template <typename Tensor>
+class Trainer {
+    std::vector<std::shared_ptr<Neural<Tensor>>> replicas;
+    std::vector<Accumulator<Tensor>> accumulators;
+    Optimizer<Tensor> &optimizer;
+    std::function<Tensor(const Tensor&, const Tensor&)> lossGradient;
+
+public:
+    // lossGradient(prediction, target) returns the error passed to backward; the default is target-prediction
+    Trainer(const std::function<std::shared_ptr<Neural<Tensor>>()> &factory, 
+            Optimizer<Tensor> &optimizer, 
+            int threads=0,
+            const std::function<Tensor(const Tensor&, const Tensor&)> &lossGradient=[](const Tensor &prediction, const Tensor &target) {return target-prediction;}) 
+            : optimizer(optimizer), lossGradient(lossGradient) {
+        if(threads<=0)
+            threads = ThreadPool::global().size();
+        for(int t=0;t<threads;++t) 
+            replicas.push_back(factory());
+        accumulators.resize(threads);
+        // a zero-error pass registers the parameters of each replica so that they can be synchronized
+        for(int t=0;t<threads;++t) {
+            replicas[t]->backward(Tensor(), accumulators[t]);
+            accumulators[t].rewind();
+            accumulators[t].zerograd();
+            if(t)
+                accumulators[t].copyParams(accumulators[0]);
+        }
+    }
+
+    int num_threads() const {
+        return replicas.size();
+    }
+
+    std::shared_ptr<Neural<Tensor>> model() const {
+        return replicas[0];
+    }
+
+    // trains on one mini-batch and returns the sum of squared errors before the update
+    double step(const std::vector<Tensor> &inputs, const std::vector<Tensor> &targets) {
+        if(inputs.size()!=targets.size())
+            throw std::logic_error("there should be as many targets as inputs");
+        if(inputs.empty())
+            return 0;
+        int threads = replicas.size();
+        int batch = inputs.size();
+        std::vector<double> losses(threads, 0);
+        ThreadPool::global().parallelFor(0, threads, [&](int begin, int end) {
+            for(int t=begin;t<end;++t) {
+                Neural<Tensor> &replica = *replicas[t];
+                Accumulator<Tensor> &accumulator = accumulators[t];
+                accumulator.zerograd();
+                for(int i=t;i<batch;i+=threads) {
+                    Tensor error = lossGradient(replica.forward(inputs[i]), targets[i]);
+                    losses[t] += (error*error).sum();
+                    replica.backward(error, accumulator);
+                    accumulator.rewind();
+                }
+            }
+        });
+        for(int stride=1;stride<threads;stride*=2)
+            ThreadPool::global().parallelFor(0, (threads-stride+2*stride-1)/(2*stride), [&](int begin, int end) {
+                for(int pair=begin;pair<end;++pair)
+                    accumulators[2*stride*pair].add(accumulators[2*stride*pair+stride]);
+            });
+        accumulators[0].apply(optimizer, 1.0/batch);
+        ThreadPool::global().parallelFor(1, threads, [&](int begin, int end) {
+            for(int t=begin;t<end;++t)
+                accumulators[t].copyParams(accumulators[0]);
+        });
+        double loss = 0;
+        for(int t=0;t<threads;++t)
+            loss += losses[t];
+        return loss;
+    }
+};
+
+}
+#endif  // TENSORLESS_TRAINER_H
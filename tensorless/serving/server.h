@@ -0,0 +1,374 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef TENSORLESS_SERVER_H
+#define TENSORLESS_SERVER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../layers/all.h"
+
+namespace tensorless {
+
+// Wire format over a Unix stream socket: every request and response is a header followed by count float32
+// lane values, and responses carry the id of their request (they may return out of order when a client has
+// several requests in flight).
+struct MessageHeader {
+    uint32_t magic;
+    uint32_t count;
+    uint64_t id;
+};
+
+#define TENSORLESS_MESSAGE_MAGIC 0x54534C53u
+#define TENSORLESS_MAX_MESSAGE_LANES 65536
+
+inline bool readFully(int fd, void *data, size_t size) {
+    char *bytes = (char*)data;
+    while(size) {
+        ssize_t count = ::read(fd, bytes, size);
+        if(count<=0) {
+            if(count<0 && errno==EINTR)
+                continue;
+            return false;
+        }
+        bytes += count;
+        size -= count;
+    }
+    return true;
+}
+
+inline bool writeFully(int fd, const void *data, size_t size) {
+    const char *bytes = (const char*)data;
+    while(size) {
+        ssize_t count = ::send(fd, bytes, size, MSG_NOSIGNAL);
+        if(count<=0) {
+            if(count<0 && errno==EINTR)
+                continue;
+            return false;
+        }
+        bytes += count;
+        size -= count;
+    }
+    return true;
+}
+
+inline bool writeMessage(int fd, uint64_t id, const std::vector<float> &values) {
+    MessageHeader header{TENSORLESS_MESSAGE_MAGIC, (uint32_t)values.size(), id};
+    return writeFully(fd, &header, sizeof(header)) && writeFully(fd, values.data(), values.size()*sizeof(float));
+}
+
+inline bool readMessage(int fd, uint64_t &id, std::vector<float> &values) {
+    MessageHeader header;
+    if(!readFully(fd, &header, sizeof(header)) || header.magic!=TENSORLESS_MESSAGE_MAGIC || header.count>TENSORLESS_MAX_MESSAGE_LANES)
+        return false;
+    id = header.id;
+    values.resize(header.count);
+    return readFully(fd, values.data(), values.size()*sizeof(float));
+}
+
+inline sockaddr_un socketAddress(const std::string &path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(path.size()>=sizeof(address.sun_path))
+        throw std::logic_error("socket path is too long: "+path);
+    std::strcpy(address.sun_path, path.c_str());
+    return address;
+}
+
+// client side: a connected socket, or -1
+inline int connectSocket(const std::string &path) {
+    sockaddr_un address = socketAddress(path);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd>=0 && ::connect(fd, (sockaddr*)&address, sizeof(address))) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// p-th quantile of unsorted samples
+inline double quantile(std::vector<double> samples, double p) {
+    if(samples.empty())
+        return 0;
+    size_t index = std::min(samples.size()-1, (size_t)(p*samples.size()));
+    std::nth_element(samples.begin(), samples.begin()+index, samples.end());
+    return samples[index];
+}
+
+struct ServerStats {
+    long long requests = 0;
+    long long batches = 0;
+    double seconds = 0;
+    double p50 = 0;  // microseconds from a request being read to its response being written
+    double p99 = 0;
+
+    std::string describe() const {
+        return std::to_string(requests) + " requests in " + std::to_string(batches) + " batches ("
+               + std::to_string(batches ? (double)requests/batches : 0) + " per batch), "
+               + std::to_string(seconds ? requests/seconds : 0) + " requests/s, p50 " + std::to_string(p50)
+               + " us, p99 " + std::to_string(p99) + " us";
+    }
+};
+
+// Serves forward passes of a model over a Unix domain socket with dynamic batching. Connections are read by
+// their own threads into one request queue; each worker owns a replica of the model and takes up to maxBatch
+// queued requests, waiting at most maxWaitMicros after the oldest one arrived for the batch to fill, then runs
+// them one by one through its replica and writes the responses. Batches share no computation: Neural layers
+// process one packed sample per call, so batching only amortizes queue locking and worker wake-ups. The packed
+// GEMM of matrix.h is not used for batches, as it cannot multiply Floating types and its exact dot products
+// differ from the rounded products of Dense::forward, so responses would depend on the path a request took.
+// Replicas receive the parameters of the first one, so that every worker computes the same function. A connection's socket is closed as soon as its
+// reader and the requests it queued are done with it, and finished readers are joined on the next accept.
+template <typename Tensor>
+class InferenceServer {
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // closed when neither its reader nor a queued request refers to it any more
+    struct Connection {
+        int fd;
+        std::mutex writing;
+        Connection(int fd) : fd(fd) {}
+        ~Connection() {::close(fd);}
+    };
+
+    struct Reader {
+        std::thread thread;
+        std::weak_ptr<Connection> connection;
+        std::atomic<bool> finished{false};
+    };
+
+    struct Request {
+        std::shared_ptr<Connection> connection;
+        uint64_t id;
+        Tensor input;
+        Clock::time_point arrival;
+    };
+
+    std::string path;
+    int maxBatch;
+    std::chrono::microseconds maxWait;
+    std::vector<std::shared_ptr<Neural<Tensor>>> replicas;
+    int listener;
+    std::atomic<bool> stopping;
+    std::thread acceptor;
+    std::list<Reader> readers;
+    std::mutex readersMutex;
+    std::vector<std::thread> workers;
+    std::deque<Request> queue;
+    std::mutex queueMutex;
+    std::condition_variable queued;
+    std::vector<double> latencies;
+    long long batches;
+    std::mutex statsMutex;
+    Clock::time_point started;
+
+    void accept() {
+        while(!stopping.load()) {
+            int fd = ::accept(listener, nullptr, nullptr);
+            if(fd<0) {
+                if(errno==EINTR)
+                    continue;
+                return;
+            }
+            std::shared_ptr<Connection> connection = std::make_shared<Connection>(fd);
+            std::lock_guard<std::mutex> lock(readersMutex);
+            // readers of closed connections are joined here, so that they do not pile up
+            for(auto it=readers.begin();it!=readers.end();) {
+                if(it->finished.load()) {
+                    it->thread.join();
+                    it = readers.erase(it);
+                }
+                else
+                    ++it;
+            }
+            readers.emplace_back();
+            Reader &reader = readers.back();
+            reader.connection = connection;
+            reader.thread = std::thread(&InferenceServer::read, this, connection, &reader.finished);
+        }
+    }
+
+    void read(std::shared_ptr<Connection> connection, std::atomic<bool> *finished) {
+        uint64_t id;
+        std::vector<float> values;
+        int lanes = Tensor().size();
+        while(!stopping.load() && readMessage(connection->fd, id, values)) {
+            Request request{connection, id, Tensor(), Clock::now()};
+            for(int i=0;i<values.size() && i<lanes;++i)
+                if(values[i])
+                    request.input.set(i, values[i]);
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                queue.push_back(request);
+            }
+            queued.notify_one();
+        }
+        ::shutdown(connection->fd, SHUT_RDWR);
+        connection.reset();
+        finished->store(true);
+    }
+
+    void work(int worker) {
+        ThreadPool::Sequential sequential; // workers already run in parallel
+        Neural<Tensor> &model = *replicas[worker];
+        std::vector<Request> batch;
+        std::vector<Tensor> outputs(maxBatch);
+        std::vector<float> values(Tensor().size());
+        std::vector<double> batchLatencies;
+        batch.reserve(maxBatch);
+        batchLatencies.reserve(maxBatch);
+        while(true) {
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queued.wait(lock, [this]() {return stopping.load() || !queue.empty();});
+                if(queue.empty())
+                    return;
+                Clock::time_point deadline = queue.front().arrival+maxWait;
+                while(queue.size()<maxBatch && !stopping.load())
+                    if(queued.wait_until(lock, deadline)==std::cv_status::timeout)
+                        break;
+                if(queue.empty())
+                    continue;
+                int count = std::min((int)queue.size(), maxBatch);
+                for(int i=0;i<count;++i) {
+                    batch.push_back(queue.front());
+                    queue.pop_front();
+                }
+            }
+            for(int i=0;i<batch.size();++i)
+                outputs[i] = model.forward(batch[i].input);
+            for(int i=0;i<batch.size();++i) {
+                for(int lane=0;lane<values.size();++lane)
+                    values[lane] = outputs[i].get(lane);
+                {
+                    std::lock_guard<std::mutex> lock(batch[i].connection->writing);
+                    writeMessage(batch[i].connection->fd, batch[i].id, values);
+                }
+                batchLatencies.push_back(std::chrono::duration<double, std::micro>(Clock::now()-batch[i].arrival).count());
+            }
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                latencies.insert(latencies.end(), batchLatencies.begin(), batchLatencies.end());
+                batches++;
+            }
+            batch.clear();
+            batchLatencies.clear();
+        }
+    }
+
+public:
+    // factory creates one replica per worker; workers defaults to the threads of ThreadPool::global()
+    InferenceServer(const std::string &path, const std::function<std::shared_ptr<Neural<Tensor>>()> &factory,
+                    int workers=0, int maxBatch=16, int maxWaitMicros=200)
+        : path(path), maxBatch(maxBatch), maxWait(maxWaitMicros), listener(-1), stopping(false), batches(0) {
+        if(maxBatch<1 || maxWaitMicros<0)
+            throw std::logic_error("batches need at least one request and a non-negative wait");
+        if(workers<=0)
+            workers = ThreadPool::global().size();
+        std::vector<Accumulator<Tensor>> accumulators(workers);
+        for(int w=0;w<workers;++w) {
+            replicas.push_back(factory());
+            replicas[w]->backward(Tensor(), accumulators[w]);
+            if(w)
+                accumulators[w].copyParams(accumulators[0]);
+        }
+    }
+
+    ~InferenceServer() {
+        stop();
+    }
+
+    InferenceServer(const InferenceServer&) = delete;
+    InferenceServer& operator=(const InferenceServer&) = delete;
+
+    // binds the socket (replacing a stale one at the same path) and starts serving in background threads
+    void start() {
+        sockaddr_un address = socketAddress(path);
+        listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if(listener<0)
+            throw std::runtime_error("cannot create a socket");
+        ::unlink(path.c_str());
+        if(::bind(listener, (sockaddr*)&address, sizeof(address)) || ::listen(listener, 128)) {
+            ::close(listener);
+            listener = -1;
+            throw std::runtime_error("cannot listen on "+path);
+        }
+        started = Clock::now();
+        acceptor = std::thread(&InferenceServer::accept, this);
+        for(int w=0;w<replicas.size();++w)
+            workers.emplace_back(&InferenceServer::work, this, w);
+    }
+
+    // answers the requests already queued, closes all connections and removes the socket
+    void stop() {
+        if(listener<0)
+            return;
+        stopping.store(true);
+        ::shutdown(listener, SHUT_RDWR);
+        acceptor.join();
+        ::close(listener);
+        listener = -1;
+        queued.notify_all();
+        for(auto& worker : workers)
+            worker.join();
+        {
+            std::lock_guard<std::mutex> lock(readersMutex);
+            for(auto& reader : readers)
+                if(std::shared_ptr<Connection> connection = reader.connection.lock())
+                    ::shutdown(connection->fd, SHUT_RDWR);
+        }
+        for(auto& reader : readers)
+            reader.thread.join();
+        readers.clear();
+        workers.clear();
+        queue.clear();
+        ::unlink(path.c_str());
+    }
+
+    ServerStats stats() {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        ServerStats ret;
+        ret.requests = latencies.size();
+        ret.batches = batches;
+        ret.seconds = std::chrono::duration<double>(Clock::now()-started).count();
+        ret.p50 = quantile(latencies, 0.5);
+        ret.p99 = quantile(latencies, 0.99);
+        return ret;
+    }
+};
+
+}
+#endif  // TENSORLESS_SERVER_H
@@ -17,6 +17,7 @@ limitations under the License.
 #ifndef TENSORLESS_TYPES_H
 #define TENSORLESS_TYPES_H
 
+#include <type_traits>
 #include "vecutils.h"
 #include "raw/int2.h"
 #include "raw/int3.h"
@@ -30,6 +31,13 @@ limitations under the License.
 #include "signed.h"
 #include "dynamic.h"
 #include "floating.h"
+#include "reductions.h"
+#include "lut.h"
+#include "mixed.h"
+#include "matrix.h"
+#include "threadpool.h"
+#include "lanes.h"
+#include "constant.h"
 
 namespace tensorless {
     typedef Signed<Int2> int3;
@@ -61,6 +69,12 @@ namespace tensorless {
     typedef Floating<sfloat8, int5> float13;  
     typedef Floating<sfloat9, int5> float14;  
     typedef Floating<sfloat9, int5> float15; 
+
+    // the wrappers add no copy semantics of their own, so every typedef can be moved around with memcpy
+    static_assert(std::is_trivially_copyable<int5>::value, "packed types are copied as plain bit-planes");
+    static_assert(std::is_trivially_copyable<sfloat9>::value, "packed types are copied as plain bit-planes");
+    static_assert(std::is_trivially_copyable<dfloat10>::value, "packed types are copied as plain bit-planes");
+    static_assert(std::is_trivially_copyable<float15>::value, "packed types are copied as plain bit-planes");
 }
 
 #endif  // TENSORLESS_TYPES_H
@@ -0,0 +1,279 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef ARITHMETIC_H
+#define ARITHMETIC_H
+
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include "vecutils.h"
+#include "telemetry.h"
+
+namespace tensorless {
+
+// Plane-level kernels shared by the raw types. They work on the LSB-first planes written by
+// toPlanes, where a type stores code*eps() in num_params() planes.
+
+#define MAX_ARITHMETIC_PLANES 16
+
+template <typename Number>
+inline constexpr int fractionBits() {
+    int bits = 0;
+    double eps = Number::eps();
+    while(eps<1) {
+        eps *= 2;
+        bits++;
+    }
+    return bits;
+}
+
+// Canonical signed digit form of numerator*2^-shift: terms sign*2^-shifts[i], most significant first, with no
+// two adjacent digits nonzero. Multiplying by a constant then takes at most about half as many shifted additions
+// as it has binary digits, and partial sums never exceed the magnitude of the first term.
+struct SignedDigits {
+    int shifts[64] = {};
+    int signs[64] = {};
+    int count = 0;
+};
+
+inline constexpr SignedDigits signedDigits(long long numerator, int shift) {
+    SignedDigits digits;
+    int sign = numerator<0 ? -1 : 1;
+    unsigned long long n = numerator<0 ? -(unsigned long long)numerator : numerator;
+    int lsbFirstShifts[64] = {};
+    int lsbFirstSigns[64] = {};
+    for(int position=0;n;++position, n>>=1)
+        if(n&1) {
+            int digit = (n&3)==3 ? -1 : 1;
+            n = digit<0 ? n+1 : n-1;
+            lsbFirstShifts[digits.count] = shift-position;
+            lsbFirstSigns[digits.count] = sign*digit;
+            digits.count++;
+        }
+    for(int i=0;i<digits.count;++i) {
+        digits.shifts[i] = lsbFirstShifts[digits.count-1-i];
+        digits.signs[i] = lsbFirstSigns[digits.count-1-i];
+    }
+    return digits;
+}
+
+// number of binary digits of |numerator|, so that numerator*2^-bitLength(numerator) lies in [0.5, 1)
+inline constexpr int bitLength(long long numerator) {
+    unsigned long long n = numerator<0 ? -(unsigned long long)numerator : numerator;
+    int bits = 0;
+    for(;n;n>>=1)
+        bits++;
+    return bits;
+}
+
+// value rounded to the precision of Number, whose eps() is a power of two
+template <typename Number>
+inline SignedDigits signedDigits(double value) {
+    const int fraction = fractionBits<Number>();
+    return signedDigits(std::llround(std::ldexp(value, fraction)), fraction);
+}
+
+// number*2^-shift through the half, quarter, eighth and times2 plane shifts
+template <typename Number>
+inline Number shifted(const Number &number, int shift) {
+    Number ret = number;
+    for(;shift>=3;shift-=3)
+        ret = ret.eighth();
+    if(shift==2)
+        ret = ret.quarter();
+    else if(shift==1)
+        ret = ret.half();
+    for(;shift<0;++shift)
+        ret = ret.times2();
+    return ret;
+}
+
+// multiplication by a constant as shifted additions and subtractions of number, instead of a full plane product
+template <typename Number>
+inline Number shiftAdd(const Number &number, const SignedDigits &digits) {
+    Number ret = Number();
+    for(int i=0;i<digits.count;++i) {
+        Number term = shifted(number, digits.shifts[i]);
+        ret = digits.signs[i]>0 ? ret+term : ret-term;
+    }
+    return ret;
+}
+
+// exact sums of integer multiples of two's complement packed values (such as Signed types), modulo 2^width
+// code steps, so that sums whose shifted results fit the type need no planes above them; each multiple is
+// added through its signed digits, one ripple-carry pass each
+#define MAX_WIDESUM_PLANES 64
+
+template <typename Number>
+class WideSum {
+private:
+    VECTOR planes[MAX_WIDESUM_PLANES];
+    int width;
+
+    // adds or subtracts the planes of a number shifted up by shift, sign-extended to the whole width
+    void add(const VECTOR *number, int shift, bool subtract) {
+        const int top = Number::num_params()-1;
+        VECTOR flip = subtract ? ~(VECTOR)0 : (VECTOR)0;
+        VECTOR carry = flip;
+        COUNT_PLANES(5*(width-shift));
+        for(int j=shift;j<width;++j) {
+            VECTOR operand = number[std::min(j-shift, top)]^flip;
+            VECTOR sum = planes[j]^operand^carry;
+            carry = (planes[j] & operand) | (carry & (planes[j]^operand));
+            planes[j] = sum;
+        }
+    }
+
+public:
+    WideSum(int width) : width(width) {
+        if(width>MAX_WIDESUM_PLANES)
+            throw std::logic_error("wide sums support up to "+std::to_string(MAX_WIDESUM_PLANES)+" planes");
+        for(int j=0;j<width;++j)
+            planes[j] = 0;
+    }
+
+    void add(const Number &number, long long multiple) {
+        VECTOR numberPlanes[MAX_ARITHMETIC_PLANES];
+        number.toPlanes(numberPlanes);
+        SignedDigits digits = signedDigits(multiple, 0);
+        for(int i=0;i<digits.count;++i)
+            add(numberPlanes, -digits.shifts[i], digits.signs[i]<0);
+    }
+
+    // the sum divided by 2^shift and rounded to nearest, for widths of shift+num_params() planes
+    Number shifted(int shift) const {
+        WideSum<Number> rounded = *this;
+        if(shift>0) {
+            VECTOR half[MAX_ARITHMETIC_PLANES] = {};
+            half[0] = ~(VECTOR)0;
+            rounded.add(half, shift-1, false);
+        }
+        VECTOR ret[MAX_ARITHMETIC_PLANES];
+        for(int j=0;j<Number::num_params();++j)
+            ret[j] = rounded.planes[std::min(shift+j, width-1)];
+        return Number::fromPlanes(ret);
+    }
+};
+
+// restoring division of (dividend << fractionBits) by divisor, saturating on overflow
+// (this includes division by zero, where every restoring step succeeds); lanes in shifted divide
+// (dividend << (fractionBits+shift)) instead, which scales their quotients without dropping dividend bits
+template <typename Number>
+inline Number planeDivide(const Number &dividend, const Number &divisor, int shift=0, const VECTOR &shifted=0) {
+    const int planes = Number::num_params();
+    const int fraction = fractionBits<Number>();
+    const int steps = planes+fraction+std::max(shift, 0);
+    COUNT_PLANES(2*steps*(planes+1));
+    VECTOR a[MAX_ARITHMETIC_PLANES];
+    VECTOR b[MAX_ARITHMETIC_PLANES+1];
+    VECTOR r[MAX_ARITHMETIC_PLANES+1];
+    VECTOR q[MAX_ARITHMETIC_PLANES];
+    dividend.toPlanes(a);
+    divisor.toPlanes(b);
+    b[planes] = 0;
+    for(int j=0;j<=planes;++j)
+        r[j] = 0;
+    VECTOR overflow = 0;
+    for(int i=steps-1;i>=0;--i) {
+        for(int j=planes;j>0;--j)
+            r[j] = r[j-1];
+        int plain = i-fraction;
+        int moved = i-fraction-shift;
+        r[0] = (plain>=0 && plain<planes ? a[plain] & ~shifted : (VECTOR)0)
+             | (moved>=0 && moved<planes ? a[moved] & shifted : (VECTOR)0);
+        VECTOR greater = 0;
+        VECTOR equal = ~(VECTOR)0;
+        for(int j=planes;j>=0;--j) {
+            greater |= equal & r[j] & ~b[j];
+            equal &= ~(r[j] ^ b[j]);
+        }
+        VECTOR fits = greater | equal;
+        VECTOR borrow = 0;
+        for(int j=0;j<=planes;++j) {
+            VECTOR diff = r[j] ^ b[j] ^ borrow;
+            borrow = (~r[j] & b[j]) | (~(r[j] ^ b[j]) & borrow);
+            r[j] = (diff & fits) | (r[j] & ~fits);
+        }
+        if(i<planes)
+            q[i] = fits;
+        else
+            overflow |= fits;
+    }
+    for(int j=0;j<planes;++j)
+        q[j] |= overflow;
+    COUNT_LANES(saturations, overflow);
+    return Number::fromPlanes(q);
+}
+
+// digit-by-digit square root of (number << fractionBits), two operand bits per step; lanes in shifted take the
+// root of (number << (fractionBits+shift)) instead, without dropping operand bits
+template <typename Number>
+inline Number planeSqrt(const Number &number, int shift=0, const VECTOR &shifted=0) {
+    const int planes = Number::num_params();
+    const int fraction = fractionBits<Number>();
+    const int operand = planes+fraction+std::max(shift, 0);
+    const int width = operand+(operand&1);
+    const int rootPlanes = width/2;
+    COUNT_PLANES(2*rootPlanes*(rootPlanes+2));
+    VECTOR a[MAX_ARITHMETIC_PLANES];
+    VECTOR x[2*MAX_ARITHMETIC_PLANES+1];
+    VECTOR rem[MAX_ARITHMETIC_PLANES+2];
+    VECTOR root[MAX_ARITHMETIC_PLANES+2];
+    number.toPlanes(a);
+    for(int i=0;i<width;++i) {
+        int plain = i-fraction;
+        int moved = i-fraction-shift;
+        x[i] = (plain>=0 && plain<planes ? a[plain] & ~shifted : (VECTOR)0)
+             | (moved>=0 && moved<planes ? a[moved] & shifted : (VECTOR)0);
+    }
+    for(int j=0;j<rootPlanes+2;++j) {
+        rem[j] = 0;
+        root[j] = 0;
+    }
+    for(int k=rootPlanes-1;k>=0;--k) {
+        for(int j=rootPlanes+1;j>1;--j)
+            rem[j] = rem[j-2];
+        rem[1] = x[2*k+1];
+        rem[0] = x[2*k];
+        // trial = (root << 2) | 1
+        VECTOR greater = 0;
+        VECTOR equal = ~(VECTOR)0;
+        for(int j=rootPlanes+1;j>=0;--j) {
+            VECTOR trial = j==0 ? ~(VECTOR)0 : j==1 ? (VECTOR)0 : root[j-2];
+            greater |= equal & rem[j] & ~trial;
+            equal &= ~(rem[j] ^ trial);
+        }
+        VECTOR fits = greater | equal;
+        VECTOR borrow = 0;
+        for(int j=0;j<rootPlanes+2;++j) {
+            VECTOR trial = j==0 ? ~(VECTOR)0 : j==1 ? (VECTOR)0 : root[j-2];
+            VECTOR diff = rem[j] ^ trial ^ borrow;
+            borrow = (~rem[j] & trial) | (~(rem[j] ^ trial) & borrow);
+            rem[j] = (diff & fits) | (rem[j] & ~fits);
+        }
+        for(int j=rootPlanes-1;j>0;--j)
+            root[j] = root[j-1];
+        root[0] = fits;
+    }
+    for(int j=rootPlanes;j<planes;++j)
+        root[j] = 0;
+    return Number::fromPlanes(root);
+}
+
+}
+#endif  // ARITHMETIC_H
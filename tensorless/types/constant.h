@@ -0,0 +1,42 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+
+#ifndef CONSTANT_H
+#define CONSTANT_H
+
+namespace tensorless {
+
+// Broadcasts a value known while compiling, so that expressions like x*constant<float8>(0.25) use ready plane
+// patterns instead of running the conversion in inner loops. Out-of-range values fail to compile instead of
+// throwing. C++20 guarantees compile-time evaluation of every call; before that, it is guaranteed when the result
+// initializes a constexpr variable or when the value is passed through TENSORLESS_CONSTANT.
+template <typename Type>
+#ifdef __cpp_consteval
+consteval
+#else
+constexpr
+#endif
+Type constant(double value) {
+    return Type::broadcast(value);
+}
+
+// compile-time constant in any expression, also before C++20
+#define TENSORLESS_CONSTANT(Type, value) ([]() {constexpr Type ret = tensorless::constant<Type>(value); return ret;}())
+
+}
+#endif  // CONSTANT_H
@@ -22,6 +22,8 @@ limitations under the License.
 #include <bitset>
 #include <cstdlib>
 #include <random>
+#include <cmath>
+#include <limits>
 #include "vecutils.h"
 #include <omp.h>
 
@@ -32,17 +34,27 @@ class Dynamic {
 private:
     double mantisa;
     Number value;
-    Dynamic(const Number& value, double mantisa) : value(value), mantisa(mantisa) {}
+    constexpr Dynamic(const Number& value, double mantisa) : mantisa(mantisa), value(value) {}
+
+    // bodies of both operands may reach the top of the range, so when their sum overflows in any lane, all lanes
+    // are kept halved and the mantisa doubles
+    static Dynamic<Number> summed(const Number &a, const Number &b, bool subtract, double mantisa) {
+        VECTOR halved;
+        Number body = a.sumOrHalf(b, subtract, halved);
+        if(!ANY(halved))
+            return Dynamic(body, mantisa);
+        return Dynamic(body.half(~halved), 2*mantisa);
+    }
 public:
     static Dynamic<Number> random() {return Dynamic(Number::random(), 1);}  // 2.0/Number::sup()
-    static Dynamic<Number> broadcast(double value) {
+    static constexpr Dynamic<Number> broadcast(double value) {
         //double scale = Number::sup()/2.0;
         if(value<0)
             return Dynamic(Number::broadcast(-1), -value);
         return Dynamic(Number::broadcast(1), value);
     }
 
-    static int num_params() {
+    static constexpr int num_params() {
         return 1+Number::num_params();
     }
 
@@ -50,6 +62,28 @@ public:
         return Number::num_bits() + sizeof(double)*8;
     }
 
+    // the scalar mantisa makes the range unbounded
+    static double sup() {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    static double inf() {
+        return -std::numeric_limits<double>::infinity();
+    }
+
+    double getMantisa() const {
+        return mantisa;
+    }
+
+    Number getBody() const {
+        return value;
+    }
+
+    // same mantisa, other lanes (used by the lane movements of lanes.h)
+    Dynamic<Number> withBody(const Number &body) const {
+        return Dynamic(body, mantisa);
+    }
+
     Dynamic<Number> times2() {
         return Dynamic(value, mantisa*2);
     }
@@ -58,15 +92,7 @@ public:
         return Dynamic();
     }
 
-    Dynamic<Number>& operator=(const Dynamic<Number>& other) {
-        if (this != &other) {
-            this->value = other.value;
-            this->mantisa = other.mantisa;
-        }
-        return *this;
-    }
-
-    Dynamic(): mantisa(1) {}
+    constexpr Dynamic(): mantisa(1), value() {}
 
     Dynamic(const std::vector<double>& vec) {
         value = Number();
@@ -98,6 +124,15 @@ public:
         return value.absmax();
     }
 
+    // a negative mantisa reverses the order of the bodies
+    int argmax(const VECTOR &mask) const {
+        return FIRSTONE(mantisa<0 ? value.argminMask(mask) : value.argmaxMask(mask));
+    }
+
+    int argmax() const {
+        return argmax(~(VECTOR)0);
+    }
+
     const double get(int i) {
         return value.get(i)*mantisa;
     }
@@ -113,7 +148,7 @@ public:
         
         if(absval>mantisa) {
             double mult = mantisa/absval;
-            value = value*Number::broadcast(mult);
+            value = value.scale(mult);
             mantisa = absval;
             value.set(i, val>0?1:-1);
         }
@@ -149,28 +184,119 @@ public:
 
     Dynamic<Number> operator+(const Dynamic<Number> &other) const {
         if(other.mantisa<mantisa)
-            return Dynamic(value+other.value*Number::broadcast(other.mantisa/mantisa), mantisa);
+            return summed(value, other.value.scale(other.mantisa/mantisa), false, mantisa);
         else
-            return Dynamic(value*Number::broadcast(mantisa/other.mantisa)+other.value, other.mantisa);
+            return summed(value.scale(mantisa/other.mantisa), other.value, false, other.mantisa);
     }
 
     Dynamic<Number> operator-(const Dynamic<Number> &other) const {
         if(other.mantisa<mantisa)
-            return Dynamic(value-other.value*Number::broadcast(other.mantisa/mantisa), mantisa);
+            return summed(value, other.value.scale(other.mantisa/mantisa), true, mantisa);
+        else if(other.mantisa==mantisa)
+            return summed(value, other.value, true, other.mantisa);
+        else
+            return summed(value.scale(mantisa/other.mantisa), other.value, true, other.mantisa);
+    }
+
+    Dynamic<Number> merge(const Dynamic<Number> &other, const VECTOR &mask) const {
+        if(other.mantisa<mantisa)
+            return Dynamic(value.merge(other.value.scale(other.mantisa/mantisa), mask), mantisa);
         else if(other.mantisa==mantisa)
-            return Dynamic(value-other.value, other.mantisa);
+            return Dynamic(value.merge(other.value, mask), mantisa);
         else
-            return Dynamic(value*Number::broadcast(mantisa/other.mantisa)-other.value, other.mantisa);
+            return Dynamic((value.scale(mantisa/other.mantisa)).merge(other.value, mask), other.mantisa);
+    }
+
+    VECTOR operator==(const Dynamic<Number> &other) const {
+        if(other.mantisa<mantisa)
+            return value==other.value.scale(other.mantisa/mantisa);
+        else if(other.mantisa==mantisa)
+            return value==other.value;
+        else
+            return value.scale(mantisa/other.mantisa)==other.value;
+    }
+
+    VECTOR operator>(const Dynamic<Number> &other) const {
+        if(other.mantisa<mantisa)
+            return value>other.value.scale(other.mantisa/mantisa);
+        else if(other.mantisa==mantisa)
+            return value>other.value;
+        else
+            return value.scale(mantisa/other.mantisa)>other.value;
+    }
+
+    VECTOR operator<(const Dynamic<Number> &other) const {return other > *this;}
+    VECTOR operator>=(const Dynamic<Number> &other) const {return ~(other > *this);}
+    VECTOR operator<=(const Dynamic<Number> &other) const {return ~(*this > other);}
+
+    // doubles the bodies while the largest stays within one, or the body range if smaller, and moves the factor
+    // to the mantisa, so that products and roots, whose truncation is fixed in body units, keep the bits of small
+    // bodies, and products of bodies stay in range
+    Dynamic<Number> normalized() const {
+        double largest = value.absmax();
+        if(largest<=0)
+            return *this;
+        int shift = 0;
+        for(;largest*2<=std::min(1.0, (double)Number::sup());++shift)
+            largest *= 2;
+        if(!shift)
+            return *this;
+        return Dynamic<Number>(value.scale(std::ldexp(1.0, shift)), std::ldexp(mantisa, -shift));
     }
 
     Dynamic<Number> operator*(const Dynamic<Number> &other) const {
-        return Dynamic<Number>(value*other.value, mantisa*other.mantisa);
+        Dynamic<Number> a = normalized();
+        Dynamic<Number> b = other.normalized();
+        return Dynamic<Number>(a.value*b.value, a.mantisa*b.mantisa);
     }
 
     Dynamic<Number> operator*(const double &other) const {
         return Dynamic<Number>(value, mantisa*other);
     }
 
+    // constants only change the shared scale
+    Dynamic<Number> scale(double factor) const {
+        return *this*factor;
+    }
+
+    template <long long numerator, int shift=0>
+    Dynamic<Number> mul_const() const {
+        return *this*std::ldexp((double)numerator, -shift);
+    }
+
+    // quotients are scaled by the power of two that brings the largest ratio of bodies, over lanes with
+    // nonzero divisors, into the upper half of the body range, and the shared mantisa takes the inverse
+    // scale; the ratios are bounded by comparing halved dividends or halved divisors, which never overflow
+    Dynamic<Number> operator/(const Dynamic<Number> &other) const {
+        auto divisor = other.value.abs();
+        auto dividend = value.abs();
+        VECTOR nonzero = ~(other.value == Number());
+        const int limit = Number::num_params()+fractionBits<Number>();
+        int shift = 0;
+        if(ANY(nonzero)) {
+            auto reaches = Number::sup()>1 ? dividend.half() : dividend;
+            for(;shift>-limit && ANY(nonzero & (reaches >= divisor));--shift)
+                reaches = reaches.half();
+            auto bound = Number::sup()>1 ? divisor : divisor.half();
+            if(shift==0)
+                for(;shift<limit && !ANY(nonzero & (dividend >= bound));++shift)
+                    bound = bound.half();
+        }
+        return Dynamic<Number>(value.divide(other.value, shift, ~(VECTOR)0), std::ldexp(mantisa/other.mantisa, -shift));
+    }
+
+    // one is written as 0.5*2, since bodies whose range stays below one cannot hold it
+    Dynamic<Number> reciprocal() const {
+        return Dynamic<Number>(Number::broadcast(0.5), 2)/(*this);
+    }
+
+    Dynamic<Number> sqrt() const {
+        Dynamic<Number> source = normalized();
+        if(source.mantisa<0)
+            return Dynamic<Number>((Number()-source.value).sqrt(), std::sqrt(-source.mantisa));
+        return Dynamic<Number>(source.value.sqrt(), std::sqrt(source.mantisa));
+    }
+
 };
 
 }
@@ -42,6 +42,21 @@ public:
         return *this;
     }
 
+    T get(std::size_t index) const {
+        return (*this)[index];
+    }
+
+    static Fixed<T, N> broadcast(T value) {
+        Fixed<T, N> result;
+        for (std::size_t i = 0; i < N; ++i) 
+            result[i] = value;
+        return result;
+    }
+
+    static constexpr std::size_t size() {
+        return N;
+    }
+
     T& operator[](std::size_t index) {
         if (index >= N) 
             throw std::out_of_range("Index out of range");
@@ -82,6 +97,10 @@ public:
         return result;
     }
 
+    Fixed<T, N> scale(double factor) const {
+        return *this*(T)factor;
+    }
+
     Fixed<T, N>& operator+=(const Fixed<T, N>& other) {
         for (std::size_t i = 0; i < N; ++i) 
             data[i] += other[i];
@@ -126,7 +145,7 @@ public:
         return result;
     }
     
-    static const int num_params() {
+    static constexpr int num_params() {
         return N;
     }
 
@@ -22,24 +22,117 @@ limitations under the License.
 #include <bitset>
 #include <cstdlib>
 #include <random>
+#include <cmath>
+#include <algorithm>
 #include "vecutils.h"
+#include "arithmetic.h"
+#include "constant.h"
 #include <omp.h>
 
 namespace tensorless {
 
+#define MAX_FLOATING_COMPARE_PLANES 64  // body planes plus the largest mantisa offset, 9+31 for float15
+
 template <typename Number, typename Mantisa>
 class Floating {
 private:
     Mantisa mantisa;
     Number value;
-    Floating(const Number& value, const Mantisa& mantisa) : value(value), mantisa(mantisa) {}
+    constexpr Floating(const Number& value, const Mantisa& mantisa) : mantisa(mantisa), value(value) {}
+    // aligns both bodies to the larger mantisa, which is returned; zero bodies take the other operand's mantisa,
+    // so that a zero left at a large mantisa does not shift the other body away. Mantisas of opposite signs can be
+    // further apart than the mantisa range, in which case the gap is applied in two representable parts, from
+    // the positive mantisa down to zero and from zero down to the negative one
+    Mantisa align(const Floating<Number, Mantisa> &other, Number &selfValue, Number &otherValue) const {
+        Mantisa selfMantisa = other.mantisa.merge(mantisa, value==value.zerolike());
+        Mantisa otherMantisa = mantisa.merge(other.mantisa, other.value==other.value.zerolike());
+        Mantisa diff = selfMantisa-otherMantisa;
+        VECTOR overflow = (selfMantisa.sign() ^ otherMantisa.sign()) & (diff.sign() ^ selfMantisa.sign());
+        if(ANY(overflow)) {
+            Mantisa upper = selfMantisa.relu()-otherMantisa.relu();
+            Mantisa lower = otherMantisa.twosComplement().relu()-selfMantisa.twosComplement().relu();
+            selfValue = upper.twosComplement().relu().applyHalf(lower.twosComplement().relu().applyHalf(value));
+            otherValue = upper.relu().applyHalf(lower.relu().applyHalf(other.value));
+        }
+        else {
+            selfValue = diff.twosComplement().relu().applyHalf(value);
+            otherValue = diff.relu().applyHalf(other.value);
+        }
+        return selfMantisa.maximum(otherMantisa);
+    }
+    // doubles bodies whose top plane only repeats the sign, so that chained operations do not keep dropping precision
+    Floating<Number, Mantisa> normalized() const {
+        VECTOR bodyPlanes[MAX_ARITHMETIC_PLANES];
+        value.toPlanes(bodyPlanes);
+        int sign = Number::num_params()-1;
+        VECTOR redundant = ~(bodyPlanes[sign-1]^bodyPlanes[sign]) & (mantisa > Mantisa::broadcast(Mantisa::inf()));
+        for(int j=sign-1;j>0;--j)
+            bodyPlanes[j] = (bodyPlanes[j-1] & redundant) | (bodyPlanes[j] & ~redundant);
+        bodyPlanes[0] &= ~redundant;
+        return Floating(Number::fromPlanes(bodyPlanes), mantisa-Mantisa::broadcastOnes(redundant));
+    }
+    // repeats normalized() until no body has a redundant top plane, as divisions and roots need all body bits,
+    // but writes the most negative body as its half, since its magnitude would saturate
+    Floating<Number, Mantisa> fullyNormalized() const {
+        Floating<Number, Mantisa> ret = normalized();
+        for(int j=3;j<Number::num_params();++j)
+            ret = ret.normalized();
+        VECTOR extreme = ret.value < Number::broadcast(Number::inf());
+        return Floating(ret.value.half(extreme), ret.mantisa+Mantisa::broadcastOnes(extreme));
+    }
+    // the exponent goes to the mantisa and the significand to the body through shift-and-add; bodies are fully
+    // normalized first, so that the right shifts of small bodies keep their bits. Exponents are added in steps
+    // within the mantisa range, nonzero lanes whose mantisa wraps upwards saturate, and lanes whose mantisa wraps
+    // downwards become zeros at the lowest mantisa
+    Floating<Number, Mantisa> scaled(const SignedDigits &digits, int exponent) const {
+        Floating<Number, Mantisa> source = fullyNormalized();
+        // significands below one leave at most one redundant top plane, which is restored before the mantisa moves
+        source = Floating(shiftAdd(source.value, digits), source.mantisa).normalized();
+        Number body = source.value;
+        if(exponent==0)
+            return source;
+        // beyond twice the range every lane wraps, so longer exponents need no more steps
+        int range = (int)Mantisa::sup()-(int)Mantisa::inf()+1;
+        int remaining = std::max(-2*range, std::min(2*range, exponent));
+        Mantisa newMantisa = source.mantisa;
+        VECTOR underflow = 0;
+        VECTOR overflow = 0;
+        while(remaining) {
+            int step = std::max((int)Mantisa::inf(), std::min((int)Mantisa::sup(), remaining));
+            remaining -= step;
+            VECTOR wrapped;
+            Mantisa next = newMantisa.addWithUnderflow(Mantisa::broadcast(step), wrapped);
+            underflow |= wrapped;
+            if(step>0)
+                overflow |= ~newMantisa.sign() & next.sign();
+            newMantisa = next;
+        }
+        VECTOR zero = body == body.zerolike();
+        COUNT_LANES(underflows, underflow & ~zero);
+        overflow &= ~zero & ~underflow;
+        Number bound = Number::broadcast(Number::sup()).merge(Number::broadcast(Number::inf()), ~body.sign());
+        newMantisa = newMantisa.merge(Mantisa::broadcast(Mantisa::inf()), ~underflow).merge(Mantisa::broadcast(Mantisa::sup()), ~overflow);
+        body = body.zerolike(underflow).merge(bound, ~overflow);
+        // the most negative mantisa has no positive counterpart for alignment, so it moves up by halving the body
+        VECTOR lowest = newMantisa < Mantisa::broadcast(Mantisa::inf());
+        return Floating(body.half(lowest), newMantisa+Mantisa::broadcastOnes(lowest)).normalized();
+    }
 public:
     // standard declarations
-    Floating() : value(), mantisa() {}
-    static Floating<Number, Mantisa> random() {return Floating(Number::random(), Mantisa::broadcast(0));}
-    static int num_params() {return Number::num_params() + Mantisa::num_params();} 
+    constexpr Floating() : mantisa(), value() {}
+    static Floating<Number, Mantisa> random() {return Floating(Number::random(), constant<Mantisa>(0));}
+    static constexpr int num_params() {return Number::num_params() + Mantisa::num_params();} 
     static int num_bits() {return Number::num_bits() + Mantisa::num_bits();}
-    Floating<Number, Mantisa> times2() const {return Floating(value, mantisa+Mantisa::broadcast(1));}
+    static constexpr double sup() {return Number::sup()*(1<<(int)Mantisa::sup());}
+    static constexpr double inf() {return -sup();}
+    static Floating<Number, Mantisa> fromPlanes(const VECTOR *planes) {
+        return Floating(Number::fromPlanes(planes), Mantisa::fromPlanes(planes+Number::num_params()));
+    }
+    void toPlanes(VECTOR *planes) const {
+        value.toPlanes(planes);
+        mantisa.toPlanes(planes+Number::num_params());
+    }
+    Floating<Number, Mantisa> times2() const {return Floating(value, mantisa+constant<Mantisa>(1));}
     Floating<Number, Mantisa> zerolike() const {return Floating();}
     Mantisa getMantisa() const {return mantisa;}
     Number getBody() const {return value;}
@@ -65,14 +158,17 @@ public:
     }
 
     // setters
-    static Floating<Number, Mantisa> broadcast(double val) {
+    static constexpr Floating<Number, Mantisa> broadcast(double val) {
         int mantisa = 0;
         if(val) {
-            while(val>1 || val<-1) {
+            int mantsup = Mantisa::sup();
+            int mantinf = Mantisa::inf();
+            double sup = std::min(1.0, Number::sup()); // bodies whose range stays below one cannot hold one
+            while((val>sup || val<-sup) && mantisa < mantsup) {
                 val /= 2;
                 mantisa++;
             }
-            while(val<0.5 && val>-0.5) {
+            while(val<sup/2 && val>-sup/2 && mantisa > mantinf) {
                 val *= 2;
                 mantisa--;
             }
@@ -102,16 +198,25 @@ public:
     }
 
     // operations
-    const double sum() const {
-        return value.sum();
+    // lanes are grouped by mantisa so that each group is reduced with the body's popcounts
+    const double sum(VECTOR mask) const {
+        double ret = 0;
+        VECTOR remaining = mask & ~(value == value.zerolike());
+        while(ANY(remaining)) {
+            int mant = (int)mantisa.get(FIRSTONE(remaining));
+            VECTOR group = remaining & (mantisa == Mantisa::broadcast(mant));
+            remaining &= ~group;
+            double groupSum = value.sum(group);
+            ret += mant<0 ? groupSum/(1<<-mant) : groupSum*(1<<mant);
+        }
+        return ret;
     }
-    
 
-    /*const double sum(VECTOR mask) const {
-        return value.sum(mask)*mantisa;
+    const double sum() const {
+        return sum(~(VECTOR)0);
     }
 
-    const double absmax() const {
+    /*const double absmax() const {
         return value.absmax();
     }
 
@@ -126,44 +231,215 @@ public:
     */
 
     Floating<Number, Mantisa> operator+(const Floating<Number, Mantisa> &other) const {
-        Mantisa diff = mantisa-other.mantisa;
-        Mantisa selfDiff = diff.relu();
-        Mantisa otherDiff = diff.twosComplement().relu();
-        Number selfValue = otherDiff.applyHalf(value);
-        Number otherValue = selfDiff.applyHalf(other.value);
+        Number selfValue, otherValue;
+        Mantisa common = align(other, selfValue, otherValue);
 
-        return Floating<Number, Mantisa>((selfValue+otherValue).half(), 
-                                         mantisa.maximum(other.mantisa)+Mantisa::broadcastOnes(~(VECTOR)0));
+        VECTOR halved;
+        Number body = selfValue.sumOrHalf(otherValue, false, halved);
+        return Floating<Number, Mantisa>(body, common+Mantisa::broadcastOnes(halved)).normalized();
     }
 
     Floating<Number, Mantisa> operator-(const Floating<Number, Mantisa> &other) const {
-        Mantisa diff = mantisa-other.mantisa;
-        Mantisa selfDiff = diff.relu();
-        Mantisa otherDiff = diff.twosComplement().relu();
-        Number selfValue = otherDiff.applyHalf(value);
-        Number otherValue = selfDiff.applyHalf(other.value);
+        Number selfValue, otherValue;
+        Mantisa common = align(other, selfValue, otherValue);
+
+        VECTOR halved;
+        Number body = selfValue.sumOrHalf(otherValue, true, halved);
+        return Floating<Number, Mantisa>(body, common+Mantisa::broadcastOnes(halved)).normalized();
+    }
+
+    // Comparisons are exact: each lane is widened into the two's complement integer body*2^(mantisa-Mantisa::inf()),
+    // whose planes are the sign-extended body shifted left by the mantisa's offset from its minimum. That offset
+    // is the mantisa with its sign plane flipped, so no mantisa difference is computed (it could overflow) and no
+    // body bit is shifted out (lanes that differ below the body precision would compare as equal).
+    static int wideWidth() {return Number::num_params()+(1<<Mantisa::num_params())-1;}
+    void widen(VECTOR *wide) const {
+        VECTOR bodyPlanes[MAX_ARITHMETIC_PLANES];
+        VECTOR mantisaPlanes[MAX_ARITHMETIC_PLANES];
+        value.toPlanes(bodyPlanes);
+        mantisa.toPlanes(mantisaPlanes);
+        int sign = Number::num_params()-1;
+        int width = wideWidth();
+        for(int j=0;j<width;++j)
+            wide[j] = bodyPlanes[std::min(j, sign)];
+        mantisaPlanes[Mantisa::num_params()-1] = ~mantisaPlanes[Mantisa::num_params()-1];
+        for(int k=0;k<Mantisa::num_params();++k) {
+            int shift = 1<<k;
+            const VECTOR &mask = mantisaPlanes[k];
+            for(int j=width-1;j>=0;--j)
+                wide[j] = (j>=shift ? wide[j-shift] & mask : (VECTOR)0) | (wide[j] & ~mask);
+        }
+    }
+
+    void compareWithCarry(const Floating<Number, Mantisa> &other, VECTOR &greater, VECTOR &equal) const {
+        VECTOR self[MAX_FLOATING_COMPARE_PLANES];
+        VECTOR others[MAX_FLOATING_COMPARE_PLANES];
+        widen(self);
+        other.widen(others);
+        int top = wideWidth()-1;
+        greater |= equal & ~self[top] & others[top];
+        equal &= ~(self[top] ^ others[top]);
+        for(int j=top-1;j>=0;--j) {
+            greater |= equal & self[j] & ~others[j];
+            equal &= ~(self[j] ^ others[j]);
+        }
+    }
+
+    VECTOR operator>(const Floating<Number, Mantisa> &other) const {
+        VECTOR greater = 0;
+        VECTOR equal = ~(VECTOR)0;
+        compareWithCarry(other, greater, equal);
+        return greater;
+    }
+
+    VECTOR operator<(const Floating<Number, Mantisa> &other) const {return other > *this;}
+    VECTOR operator>=(const Floating<Number, Mantisa> &other) const {return ~(other > *this);}
+    VECTOR operator<=(const Floating<Number, Mantisa> &other) const {return ~(*this > other);}
 
-        return Floating<Number, Mantisa>(selfValue-otherValue, mantisa.maximum(other.mantisa));
+    VECTOR operator==(const Floating<Number, Mantisa> &other) const {
+        VECTOR greater = 0;
+        VECTOR equal = ~(VECTOR)0;
+        compareWithCarry(other, greater, equal);
+        return equal;
     }
 
+    Floating<Number, Mantisa> merge(const Floating<Number, Mantisa> &other, const VECTOR &mask) const {
+        return Floating<Number, Mantisa>(value.merge(other.value, mask), mantisa.merge(other.mantisa, mask));
+    }
+
+    Floating<Number, Mantisa> minimum(const Floating<Number, Mantisa> &other) const {return merge(other, *this < other);}
+    Floating<Number, Mantisa> maximum(const Floating<Number, Mantisa> &other) const {return merge(other, *this > other);}
+
+    // narrows candidates on magnitudes aligned to the largest candidate mantisa; floor-aligned magnitudes
+    // preserve the ordering, so the few lanes that survive are resolved exactly
+    VECTOR argmaxMask(const VECTOR &mask) const {
+        VECTOR isNegative = value.sign();
+        VECTOR nonZero = ~(value == value.zerolike());
+        VECTOR candidates = mask & ~isNegative & nonZero;
+        bool positive = ANY(candidates);
+        if(!positive) {
+            candidates = mask & ~isNegative;
+            if(ANY(candidates))
+                return candidates;
+            candidates = mask;
+        }
+        Mantisa diff;
+        while(true) {
+            diff = Mantisa::broadcast(mantisa.get(mantisa.argmax(candidates)))-mantisa;
+            VECTOR overflow = candidates & diff.sign(); // mantisa gap too wide to be represented
+            if(!ANY(overflow))
+                break;
+            candidates = positive ? candidates & ~overflow : overflow;
+        }
+        auto aligned = diff.applyHalf(value.abs(), candidates);
+        candidates = positive ? aligned.argmaxMask(candidates) : aligned.argminMask(candidates);
+        VECTOR ret = 0;
+        double best = 0;
+        while(ANY(candidates)) {
+            int pos = FIRSTONE(candidates);
+            candidates &= ~ONEHOT(pos);
+            double val = get(pos);
+            if(!ANY(ret) || val>best) {
+                best = val;
+                ret = ONEHOT(pos);
+            }
+            else if(val==best)
+                ret |= ONEHOT(pos);
+        }
+        return ret;
+    }
+
+    int argmax(const VECTOR &mask) const {return FIRSTONE(argmaxMask(mask));}
+    int argmax() const {return FIRSTONE(argmaxMask(~(VECTOR)0));}
+    const double max() const {return get(argmax());}
+
+    // bodies whose range reaches two can multiply to more than sup(), so lanes where both bodies reach one halve
+    // the first of them
     Floating<Number, Mantisa> operator*(const Floating<Number, Mantisa> &other) const {
         VECTOR underflow;
         Mantisa newMantisa = mantisa.addWithUnderflow(other.mantisa, underflow);
-        return Floating<Number, Mantisa>(value.zerolike(underflow)*other.value, newMantisa);
+        COUNT_LANES(underflows, underflow & ~(value == value.zerolike()) & ~(other.value == other.value.zerolike()));
+        Number body = value.zerolike(underflow);
+        if(Number::sup()>1) {
+            Number one = Number::broadcast(1);
+            Number minusOne = Number::broadcast(-1);
+            VECTOR large = ((value>=one) | (value<=minusOne)) & ((other.value>=one) | (other.value<=minusOne));
+            body = body.half(large);
+            newMantisa = newMantisa+Mantisa::broadcastOnes(large);
+        }
+        return Floating<Number, Mantisa>(body*other.value, newMantisa).normalized();
     }
 
+
+    // both bodies are normalized first, and lanes whose ratio of bodies would leave the normalized range have
+    // their quotient doubled or halved during the division; the mantisas subtract as ma+~mb+1, so that the
+    // smallest divisor mantisa does not overflow when negated
+    Floating<Number, Mantisa> operator/(const Floating<Number, Mantisa> &other) const {
+        Floating<Number, Mantisa> dividend = fullyNormalized();
+        Floating<Number, Mantisa> divisor = other.fullyNormalized();
+        VECTOR smaller = dividend.value.abs() < divisor.value.abs();
+        VECTOR planes[MAX_ARITHMETIC_PLANES];
+        divisor.mantisa.toPlanes(planes);
+        for(int j=0;j<Mantisa::num_params();++j)
+            planes[j] = ~planes[j];
+        Number quotient;
+        VECTOR once, twice;
+        if(Number::sup()>1) { // ratios in [1, 2) fit as they are and ratios in (1/2, 1) are doubled
+            quotient = dividend.value.divide(divisor.value, 1, smaller);
+            once = ~smaller;
+            twice = 0;
+        }
+        else { // ratios in (1/2, 1) fit as they are and ratios in [1, 2) are halved
+            quotient = dividend.value.divide(divisor.value, -1, ~smaller);
+            once = ~(VECTOR)0;
+            twice = ~smaller;
+        }
+        VECTOR underflow;
+        Mantisa newMantisa = dividend.mantisa.addWithUnderflow(Mantisa::fromPlanes(planes), underflow);
+        newMantisa = newMantisa+Mantisa::broadcastOnes(once)+Mantisa::broadcastOnes(twice);
+        COUNT_LANES(underflows, underflow & ~(value == value.zerolike()));
+        return Floating<Number, Mantisa>(quotient.zerolike(underflow), newMantisa);
+    }
+
+    // one is written as 0.5*2, since bodies whose range stays below one cannot hold it
+    Floating<Number, Mantisa> reciprocal() const {
+        return Floating<Number, Mantisa>(Number::broadcast(0.5), Mantisa::broadcast(1))/(*this);
+    }
+
+    // odd mantisas move one factor of two into the body before halving the exponent, doubling bodies that
+    // reach one and halving the others, so that every root lands in the normalized range
+    Floating<Number, Mantisa> sqrt() const {
+        Floating<Number, Mantisa> normalized = fullyNormalized();
+        VECTOR mantisaPlanes[MAX_ARITHMETIC_PLANES];
+        normalized.mantisa.toPlanes(mantisaPlanes);
+        VECTOR odd = mantisaPlanes[0];
+        int sign = Mantisa::num_params()-1;
+        for(int j=0;j<sign-1;++j)
+            mantisaPlanes[j] = mantisaPlanes[j+1];
+        mantisaPlanes[sign-1] = mantisaPlanes[sign];
+        if(Number::sup()>1)
+            return Floating<Number, Mantisa>(normalized.value.sqrt(1, odd), Mantisa::fromPlanes(mantisaPlanes));
+        return Floating<Number, Mantisa>(normalized.value.sqrt(-1, odd), 
+                                         Mantisa::fromPlanes(mantisaPlanes)+Mantisa::broadcastOnes(odd));
+    }
     
-    Floating<Number, Mantisa> operator*(const double other) const {
-        return *this+broadcast(other);
+    // multiplication by a constant without a full body product, e.g. scale(0.75) computes x-x/4
+    Floating<Number, Mantisa> scale(double factor) const {
+        int exponent;
+        double significand = std::frexp(factor, &exponent);
+        return scaled(signedDigits<Number>(significand), exponent);
     }
 
+    // multiplication by numerator*2^-shift, decomposed while compiling
+    template <long long numerator, int shift=0>
+    Floating<Number, Mantisa> mul_const() const {
+        constexpr int bits = bitLength(numerator);
+        constexpr SignedDigits digits = signedDigits(numerator, bits);
+        return scaled(digits, bits-shift);
+    }
 
-    Floating<Number, Mantisa>& operator=(const Floating<Number, Mantisa>& other) {
-        if (this != &other) {
-            this->value = other.value;
-            this->mantisa = other.mantisa;
-        }
-        return *this;
+    Floating<Number, Mantisa> operator*(const double other) const {
+        return scale(other);
     }
 };
 
@@ -0,0 +1,261 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef LANES_H
+#define LANES_H
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "vecutils.h"
+#include "arithmetic.h"
+#include "dynamic.h"
+
+namespace tensorless {
+
+// Cross-lane movements. Lane i of a packed value is bit i of each of its planes, so moving lanes moves the
+// same bits in every plane: shifts and rotations are plane shifts, and an arbitrary permutation is a Benes
+// network of delta swaps whose masks are routed once and reused. Dynamic types move their body and keep the
+// scalar mantisa. Vacated lanes hold all-zero planes, which every type decodes as zero.
+
+#ifdef SUPERLONG
+#define NUM_LANES 256  // the lanes FourLongs addresses
+#else
+#define NUM_LANES ((int)(sizeof(VECTOR)*8))
+#endif
+
+#ifdef SUPERLONG
+// FourLongs has no shifts, so plane shifts move one bit at a time
+inline VECTOR planeShift(const VECTOR &plane, int count) {
+    VECTOR ret;
+    for(int i=std::max(0, count);i<std::min(NUM_LANES, NUM_LANES+count);++i)
+        if(GETAT(plane, i-count))
+            ret |= ONEHOT(i);
+    return ret;
+}
+#else
+#ifdef INT128
+typedef unsigned __int128 UNSIGNED_VECTOR;
+#else
+typedef unsigned long long UNSIGNED_VECTOR;
+#endif
+// moves lane i to lane i+count (towards lower lanes for negative counts) and fills vacated lanes with zeros
+inline __attribute__((always_inline)) VECTOR planeShift(const VECTOR &plane, int count) {
+    if(count>=NUM_LANES || count<=-NUM_LANES)
+        return 0;
+    if(count>=0)
+        return (VECTOR)((UNSIGNED_VECTOR)plane << count);
+    return (VECTOR)((UNSIGNED_VECTOR)plane >> -count);
+}
+#endif
+
+inline __attribute__((always_inline)) VECTOR planeRotate(const VECTOR &plane, int count) {
+    count %= NUM_LANES;
+    if(count<0)
+        count += NUM_LANES;
+    if(count==0)
+        return plane;
+    return planeShift(plane, count) | planeShift(plane, count-NUM_LANES);
+}
+
+// exchanges lanes i and i+distance for every lane i in mask
+inline __attribute__((always_inline)) VECTOR deltaSwap(const VECTOR &plane, const VECTOR &mask, int distance) {
+    VECTOR swapped = (planeShift(plane, -distance) ^ plane) & mask;
+    return plane ^ swapped ^ planeShift(swapped, distance);
+}
+
+// lanes whose index has the given power-of-two bit clear, the lower sides of the delta swaps at that distance
+inline const VECTOR& lowerLanes(int distance) {
+    static const std::vector<VECTOR> masks = []() {
+        std::vector<VECTOR> ret(NUM_LANES);
+        for(int distance=1;distance<NUM_LANES;distance*=2)
+            for(int i=0;i<NUM_LANES;++i)
+                if(!(i & distance))
+                    ret[distance] |= ONEHOT(i);
+        return ret;
+    }();
+    return masks[distance];
+}
+
+#ifdef SUPERLONG
+inline VECTOR planeReverse(VECTOR plane) {
+    for(int distance=NUM_LANES/2;distance>=1;distance/=2)
+        plane = deltaSwap(plane, lowerLanes(distance), distance);
+    return plane;
+}
+#else
+// the byte repeated in every byte of a plane
+inline constexpr UNSIGNED_VECTOR everyByte(unsigned char byte) {
+    return ~(UNSIGNED_VECTOR)0/255*byte;
+}
+
+// reverses the lanes within each byte with three swaps and then the bytes themselves
+inline __attribute__((always_inline)) VECTOR planeReverse(const VECTOR &plane) {
+    UNSIGNED_VECTOR bits = plane;
+    bits = ((bits >> 1) & everyByte(0x55)) | ((bits & everyByte(0x55)) << 1);
+    bits = ((bits >> 2) & everyByte(0x33)) | ((bits & everyByte(0x33)) << 2);
+    bits = ((bits >> 4) & everyByte(0x0F)) | ((bits & everyByte(0x0F)) << 4);
+    #ifdef INT128
+    return (VECTOR)(((UNSIGNED_VECTOR)__builtin_bswap64((uint64_t)bits) << 64) | __builtin_bswap64((uint64_t)(bits >> 64)));
+    #else
+    return (VECTOR)__builtin_bswap64(bits);
+    #endif
+}
+#endif
+
+// applies a plane operation to every plane of a number
+template <typename Number, typename Operation>
+inline __attribute__((always_inline)) Number mapPlanes(const Number &number, Operation operation) {
+    VECTOR planes[MAX_ARITHMETIC_PLANES];
+    number.toPlanes(planes);
+    for(int j=0;j<Number::num_params();++j)
+        planes[j] = operation(planes[j]);
+    return Number::fromPlanes(planes);
+}
+
+template <typename Number, typename Operation>
+inline __attribute__((always_inline)) Dynamic<Number> mapPlanes(const Dynamic<Number> &number, Operation operation) {
+    return number.withBody(mapPlanes(number.getBody(), operation));
+}
+
+// lane i of the result is lane i-count of the number, or zero when that lane does not exist
+template <typename Number>
+inline Number shift_lanes(const Number &number, int count) {
+    return mapPlanes(number, [count](const VECTOR &plane) {return planeShift(plane, count);});
+}
+
+// lane i of the result is lane i-count (modulo the number of lanes) of the number
+template <typename Number>
+inline Number rotate_lanes(const Number &number, int count) {
+    return mapPlanes(number, [count](const VECTOR &plane) {return planeRotate(plane, count);});
+}
+
+template <typename Number>
+inline Number reverse_lanes(const Number &number) {
+    return mapPlanes(number, [](const VECTOR &plane) {return planeReverse(plane);});
+}
+
+// every lane of the result is the given lane of the number
+template <typename Number>
+inline Number splat_lane(const Number &number, int lane) {
+    if(lane<0 || lane>=NUM_LANES)
+        throw std::logic_error("lane "+std::to_string(lane)+" is out of range");
+    return mapPlanes(number, [lane](const VECTOR &plane) {return GETAT(plane, lane) ? ~(VECTOR)0 : (VECTOR)0;});
+}
+
+// lanes of b where the mask is set and lanes of a elsewhere
+template <typename Number>
+inline Number blend(const Number &a, const Number &b, const VECTOR &mask) {
+    return b.merge(a, mask);
+}
+
+// A fixed permutation of lanes, where lane i of the result is lane source[i] of the input. The constructor
+// routes the permutation through a Benes network with the looping algorithm: the network of 2^n lanes swaps
+// lanes at distance 2^(n-1), permutes each half with a network of 2^(n-1) lanes, and swaps at distance
+// 2^(n-1) again. Its 2n-1 stages become delta swaps with one mask each, and stages that swap nothing are
+// dropped, so applying the permutation costs at most 2n-1 delta swaps per plane.
+class LanePermutation {
+private:
+    std::vector<VECTOR> masks;
+    std::vector<int> distances;
+
+    void route(const std::vector<int> &source, int offset, int first, int last) {
+        int size = source.size();
+        int half = size/2;
+        if(size==2) {
+            if(source[0]==1)
+                stageMask(first) |= ONEHOT(offset);
+            return;
+        }
+        std::vector<int> destination(size);
+        for(int i=0;i<size;++i)
+            destination[source[i]] = i;
+        // the two inputs of each swap enter different halves and so do the two outputs of each swap
+        std::vector<int> lower(size, -1);
+        for(int start=0;start<half;++start) {
+            if(lower[start]!=-1)
+                continue;
+            int input = start;
+            while(lower[input]==-1) {
+                lower[input] = 1;
+                lower[input ^ half] = 0;
+                int partner = source[destination[input ^ half] ^ half];
+                if(lower[partner]!=-1)
+                    break;
+                input = partner;
+            }
+        }
+        std::vector<int> lowerSource(half);
+        std::vector<int> upperSource(half);
+        for(int i=0;i<half;++i) {
+            int lane = offset+i;
+            if(!lower[i])
+                stageMask(first) |= ONEHOT(lane);
+            int output = destination[i] % half;
+            int other = destination[i+half] % half;
+            (lower[i] ? lowerSource : upperSource)[output] = i;
+            (lower[i+half] ? lowerSource : upperSource)[other] = i;
+            if(lower[source[i+half]])
+                stageMask(last) |= ONEHOT(lane);
+        }
+        route(lowerSource, offset, first+1, last-1);
+        route(upperSource, offset+half, first+1, last-1);
+    }
+
+    VECTOR& stageMask(int stage) {return masks[stage];}
+public:
+    LanePermutation(const std::vector<int> &source) {
+        if((int)source.size()!=NUM_LANES)
+            throw std::logic_error("lane permutations need "+std::to_string(NUM_LANES)+" source lanes");
+        std::vector<bool> used(NUM_LANES, false);
+        for(int lane : source) {
+            if(lane<0 || lane>=NUM_LANES || used[lane])
+                throw std::logic_error("lane permutation sources must contain every lane once");
+            used[lane] = true;
+        }
+        int levels = 0;
+        while((1<<levels)<NUM_LANES)
+            levels++;
+        masks.resize(2*levels-1);
+        route(source, 0, 0, 2*levels-2);
+        std::vector<VECTOR> stages;
+        for(int stage=0;stage<(int)masks.size();++stage) {
+            int level = stage<levels ? stage : 2*levels-2-stage;
+            if(!ANY(masks[stage]))
+                continue;
+            stages.push_back(masks[stage]);
+            distances.push_back(NUM_LANES >> (level+1));
+        }
+        masks = stages;
+    }
+
+    int num_stages() const {return masks.size();}
+
+    VECTOR apply(VECTOR plane) const {
+        for(int stage=0;stage<(int)masks.size();++stage)
+            plane = deltaSwap(plane, masks[stage], distances[stage]);
+        return plane;
+    }
+
+    template <typename Number>
+    Number operator()(const Number &number) const {
+        return mapPlanes(number, [this](const VECTOR &plane) {return apply(plane);});
+    }
+};
+
+}
+#endif  // LANES_H
@@ -0,0 +1,149 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LUT_H
+#define LUT_H
+
+#include <vector>
+#include <map>
+#include <tuple>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "vecutils.h"
+
+namespace tensorless {
+
+// whether a type exposes its bit-planes through toPlanes and fromPlanes (Dynamic types keep a scalar mantisa instead)
+template <typename Number, typename = void>
+struct HasPlanes : std::false_type {};
+
+template <typename Number>
+struct HasPlanes<Number, decltype(Number::fromPlanes((const VECTOR*)nullptr), std::declval<const Number&>().toPlanes((VECTOR*)nullptr))> : std::true_type {};
+
+// Lut compiles a table over all 2^num_params() plane encodings of a type into a reduced
+// ordered binary decision diagram (Shannon expansion on the most significant plane first,
+// with shared sub-diagrams), so that applying it costs one AND and two XOR per node for
+// all lanes at once. The diagram is built once when the Lut is constructed.
+template <typename Number>
+class Lut {
+private:
+    static const int maxPlanes = 10;
+    static const int maxNodes = 2048;
+    static_assert(HasPlanes<Number>::value, "lookup tables need types with toPlanes and fromPlanes");
+    static_assert(Number::num_params()<=maxPlanes, "lookup tables support up to 10 planes");
+    struct Node {
+        int plane;
+        int low;
+        int high;
+    };
+    std::vector<Node> nodes;  // slots 0 and 1 are the constants, node k is evaluated into slot k+2
+    std::vector<int> outputs;
+    std::map<std::tuple<int, int, int>, int> unique;
+
+    int build(const std::vector<int> &table, int bit, int plane, int from) {
+        int count = 1<<(plane+1);
+        int first = (table[from]>>bit)&1;
+        bool constant = true;
+        for(int i=1;i<count && constant;++i)
+            constant = ((table[from+i]>>bit)&1)==first;
+        if(constant)
+            return first;
+        int low = build(table, bit, plane-1, from);
+        int high = build(table, bit, plane-1, from+count/2);
+        if(low==high)
+            return low;
+        std::tuple<int, int, int> key = std::make_tuple(plane, low, high);
+        auto it = unique.find(key);
+        if(it!=unique.end())
+            return it->second;
+        if(nodes.size()>=maxNodes)
+            throw std::logic_error("lookup table is too complex");
+        nodes.push_back(Node{plane, low, high});
+        unique[key] = nodes.size()+1;
+        return nodes.size()+1;
+    }
+
+public:
+    // table[code] is the output encoding for the input encoding code, where bit j of
+    // an encoding is the lane's bit in plane j (as written by toPlanes)
+    Lut(const std::vector<int> &table) {
+        int planes = Number::num_params();
+        if(table.size()!=(1<<planes))
+            throw std::logic_error("lookup table needs "+std::to_string(1<<planes)+" entries");
+        for(int bit=0;bit<planes;++bit)
+            outputs.push_back(build(table, bit, planes-1, 0));
+        unique.clear();
+    }
+
+    // tabulates f on every representable value, clipping results to [inf(), sup()]
+    template <typename Function>
+    static Lut<Number> fromFunction(Function f) {
+        int planes = Number::num_params();
+        std::vector<int> table(1<<planes);
+        VECTOR in[maxPlanes];
+        VECTOR out[maxPlanes];
+        for(int code=0;code<table.size();++code) {
+            for(int j=0;j<planes;++j)
+                in[j] = (code>>j)&1 ? ~(VECTOR)0 : (VECTOR)0;
+            double val = f(Number::fromPlanes(in).get(0));
+            if(val>Number::sup())
+                val = Number::sup();
+            if(val<Number::inf())
+                val = Number::inf();
+            Number result;
+            result.set(0, val);
+            result.toPlanes(out);
+            int outCode = 0;
+            for(int j=0;j<planes;++j)
+                outCode |= GETAT(out[j], 0)<<j;
+            table[code] = outCode;
+        }
+        return Lut<Number>(table);
+    }
+
+    int num_nodes() const {
+        return nodes.size();
+    }
+
+    inline Number operator()(const Number &number) const {
+        VECTOR in[maxPlanes];
+        VECTOR out[maxPlanes];
+        // one slot per node, kept per thread instead of on the stack since diagrams may have up to maxNodes nodes
+        static thread_local std::vector<VECTOR> slots;
+        if(slots.size()<nodes.size()+2)
+            slots.resize(nodes.size()+2);
+        number.toPlanes(in);
+        slots[0] = 0;
+        slots[1] = ~(VECTOR)0;
+        for(int k=0;k<nodes.size();++k) {
+            const Node &node = nodes[k];
+            VECTOR low = slots[node.low];
+            slots[k+2] = low ^ (in[node.plane] & (low ^ slots[node.high]));
+        }
+        for(int j=0;j<outputs.size();++j)
+            out[j] = slots[outputs[j]];
+        return Number::fromPlanes(out);
+    }
+};
+
+template <typename Number>
+inline Number apply_lut(const Number &number, const Lut<Number> &lut) {
+    return lut(number);
+}
+
+}
+#endif  // LUT_H
@@ -0,0 +1,230 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <vector>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include "vecutils.h"
+#include "dynamic.h"
+#include "floating.h"
+#include "mixed.h"
+#include "threadpool.h"
+
+namespace tensorless {
+
+// Row-major matrix whose rows are split into consecutive packed blocks of Type. Lanes past cols() in the last
+// block of each row are kept at zero, so that they do not contribute to products.
+template <typename Type>
+class PackedMatrix {
+private:
+    int numRows;
+    int numCols;
+    int rowBlocks;
+    std::vector<Type> data;
+public:
+    PackedMatrix(int rows, int cols) : numRows(rows), numCols(cols), rowBlocks((cols+lanes()-1)/lanes()), data(rows*rowBlocks) {
+        if(rows<0 || cols<0)
+            throw std::logic_error("matrix dimensions cannot be negative");
+    }
+
+    static PackedMatrix<Type> random(int rows, int cols) {
+        PackedMatrix<Type> ret(rows, cols);
+        for(int row=0;row<rows;++row)
+            for(int block=0;block<ret.rowBlocks;++block) {
+                Type values = Type::random();
+                for(int lane=cols-block*lanes();lane<lanes();++lane)
+                    values.set(lane, 0);
+                ret.block(row, block) = values;
+            }
+        return ret;
+    }
+
+    static int lanes() {
+        return Type().size();
+    }
+
+    int rows() const {return numRows;}
+    int cols() const {return numCols;}
+    int blocks() const {return rowBlocks;}
+
+    Type& block(int row, int block) {
+        return data[row*rowBlocks+block];
+    }
+
+    const Type& block(int row, int block) const {
+        return data[row*rowBlocks+block];
+    }
+
+    double get(int row, int col) const {
+        return block(row, col/lanes()).get(col%lanes());
+    }
+
+    void set(int row, int col, double value) {
+        block(row, col/lanes()).set(col%lanes(), value);
+    }
+};
+
+// Types whose lanes are fixed linear combinations of their planes, optionally with one scale per block
+// (the mantisa of Dynamic types). Floating types have per-lane exponents and cannot be multiplied plane by plane.
+template <typename Type>
+struct PlaneLayout {
+    typedef Type Body;
+    static const Type& body(const Type &value) {return value;}
+    static double scale(const Type &value) {return 1;}
+};
+
+template <typename Number>
+struct PlaneLayout<Dynamic<Number>> {
+    typedef Number Body;
+    static Number body(const Dynamic<Number> &value) {return value.getBody();}
+    static double scale(const Dynamic<Number> &value) {return value.getMantisa();}
+};
+
+template <typename Number, typename Mantisa>
+struct PlaneLayout<Floating<Number, Mantisa>> {
+    static_assert(!std::is_same<Number, Number>::value, "Floating types have per-lane exponents and cannot be packed into matrix products");
+};
+
+// rows of a matrix unpacked to their planes, block-major within each row, padded with zero rows to a multiple of
+// the micro-kernel height; plane weights are integer multiples of unit
+template <typename Type>
+struct GemmPanel {
+    int planes;
+    int blocks;
+    double unit;
+    std::vector<long long> weights;
+    std::vector<VECTOR> data;
+    std::vector<double> scales;
+
+    GemmPanel(const PackedMatrix<Type> &matrix, int rowMultiple) {
+        typedef typename PlaneLayout<Type>::Body Body;
+        planes = Body::num_params();
+        blocks = matrix.blocks();
+        const std::vector<double> &planeValues = planeWeights<Body>();
+        unit = std::abs(planeValues[0]);
+        for(int p=0;p<planes;++p) {
+            weights.push_back(std::llround(planeValues[p]/unit));
+            if(weights[p]*unit!=planeValues[p])
+                throw std::logic_error("plane weights are not integer multiples of the first plane");
+        }
+        int rows = (matrix.rows()+rowMultiple-1)/rowMultiple*rowMultiple;
+        data.resize((size_t)rows*blocks*planes, (VECTOR)0);
+        scales.resize((size_t)rows*blocks, 0);
+        for(int row=0;row<matrix.rows();++row)
+            for(int block=0;block<blocks;++block) {
+                const Type &value = matrix.block(row, block);
+                PlaneLayout<Type>::body(value).toPlanes(&data[((size_t)row*blocks+block)*planes]);
+                scales[(size_t)row*blocks+block] = PlaneLayout<Type>::scale(value);
+            }
+    }
+
+    const VECTOR* planesOf(int row, int block) const {
+        return &data[((size_t)row*blocks+block)*planes];
+    }
+};
+
+#define GEMM_MR 2           // micro-kernel rows of A
+#define GEMM_NR 2           // micro-kernel rows of B
+#define GEMM_TILE 32        // output tile side, the unit of parallel work
+#define GEMM_BLOCK_DEPTH 16 // blocks of each row kept in cache while sweeping a tile
+
+// GEMM_MR x GEMM_NR dot products over blocks [begin, end), one AND and popcount per plane pair and block
+template <typename TypeA, typename TypeB>
+inline void gemmMicroKernel(const GemmPanel<TypeA> &a, const GemmPanel<TypeB> &b, const long long *weights,
+                            int row, int col, int begin, int end, double out[GEMM_MR][GEMM_NR]) {
+    const int planesA = a.planes;
+    const int planesB = b.planes;
+    for(int block=begin;block<end;++block) {
+        const VECTOR *a0 = a.planesOf(row, block);
+        const VECTOR *a1 = a.planesOf(row+1, block);
+        const VECTOR *b0 = b.planesOf(col, block);
+        const VECTOR *b1 = b.planesOf(col+1, block);
+        long long c00 = 0, c01 = 0, c10 = 0, c11 = 0;
+        COUNT_PLANES(GEMM_MR*GEMM_NR*planesA*planesB);
+        for(int p=0;p<planesA;++p) {
+            const long long *weightRow = weights+p*planesB;
+            for(int q=0;q<planesB;++q) {
+                long long weight = weightRow[q];
+                c00 += weight*bitcount(a0[p] & b0[q]);
+                c01 += weight*bitcount(a0[p] & b1[q]);
+                c10 += weight*bitcount(a1[p] & b0[q]);
+                c11 += weight*bitcount(a1[p] & b1[q]);
+            }
+        }
+        size_t rowA = (size_t)row*a.blocks+block;
+        size_t rowB = (size_t)col*b.blocks+block;
+        out[0][0] += c00*a.scales[rowA]*b.scales[rowB];
+        out[0][1] += c01*a.scales[rowA]*b.scales[rowB+b.blocks];
+        out[1][0] += c10*a.scales[rowA+a.blocks]*b.scales[rowB];
+        out[1][1] += c11*a.scales[rowA+a.blocks]*b.scales[rowB+b.blocks];
+    }
+}
+
+// Product of a with the transpose of b, whose rows both run along the packed lanes: the returned row-major
+// a.rows() x b.rows() values are out[i*b.rows()+j] = sum_k a(i,k)*b(j,k). Output tiles are split among the threads
+// of ThreadPool::global(), each sweeping GEMM_BLOCK_DEPTH blocks of its rows at a time so that they stay in cache.
+template <typename TypeA, typename TypeB>
+std::vector<double> gemm(const PackedMatrix<TypeA> &a, const PackedMatrix<TypeB> &b) {
+    if(a.cols()!=b.cols() || PackedMatrix<TypeA>::lanes()!=PackedMatrix<TypeB>::lanes())
+        throw std::logic_error("gemm needs matrices with the same number of columns");
+    GemmPanel<TypeA> panelA(a, GEMM_MR);
+    GemmPanel<TypeB> panelB(b, GEMM_NR);
+    std::vector<long long> weights;
+    for(int p=0;p<panelA.planes;++p)
+        for(int q=0;q<panelB.planes;++q)
+            weights.push_back(panelA.weights[p]*panelB.weights[q]);
+    const double unit = panelA.unit*panelB.unit;
+    const int rows = a.rows();
+    const int cols = b.rows();
+    const int blocks = a.blocks();
+    const int rowTiles = (rows+GEMM_TILE-1)/GEMM_TILE;
+    const int colTiles = (cols+GEMM_TILE-1)/GEMM_TILE;
+    std::vector<double> out((size_t)rows*cols);
+    ThreadPool::global().parallelFor(0, rowTiles*colTiles, [&](int firstTile, int lastTile) {
+        for(int tileIndex=firstTile;tileIndex<lastTile;++tileIndex) {
+            int rowTile = tileIndex/colTiles;
+            int colTile = tileIndex%colTiles;
+            double tile[GEMM_TILE][GEMM_TILE] = {};
+            int rowBegin = rowTile*GEMM_TILE;
+            int colBegin = colTile*GEMM_TILE;
+            int rowEnd = std::min(rowBegin+GEMM_TILE, rows);
+            int colEnd = std::min(colBegin+GEMM_TILE, cols);
+            for(int begin=0;begin<blocks;begin+=GEMM_BLOCK_DEPTH) {
+                int end = std::min(begin+GEMM_BLOCK_DEPTH, blocks);
+                for(int row=rowBegin;row<rowEnd;row+=GEMM_MR)
+                    for(int col=colBegin;col<colEnd;col+=GEMM_NR) {
+                        double micro[GEMM_MR][GEMM_NR] = {};
+                        gemmMicroKernel(panelA, panelB, weights.data(), row, col, begin, end, micro);
+                        for(int i=0;i<GEMM_MR;++i)
+                            for(int j=0;j<GEMM_NR;++j)
+                                tile[row-rowBegin+i][col-colBegin+j] += micro[i][j];
+                    }
+            }
+            for(int row=rowBegin;row<rowEnd;++row)
+                for(int col=colBegin;col<colEnd;++col)
+                    out[(size_t)row*cols+col] = tile[row-rowBegin][col-colBegin]*unit;
+        }
+    });
+    return out;
+}
+
+}
+#endif  // MATRIX_H
@@ -0,0 +1,192 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef MIXED_H
+#define MIXED_H
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "vecutils.h"
+#include "arithmetic.h"
+#include "dynamic.h"
+
+namespace tensorless {
+
+// Kernels between different packed types. Raw and Signed lanes are linear combinations of their bits, so a 
+// product of two lanes expands into plane pairs: sum_p sum_q weight_p*weight_q*bit_p*bit_q. Dynamic types 
+// contribute their scalar mantisa. Floating types, whose exponents differ per lane, are not supported.
+
+// value of each plane (LSB first, as written by toPlanes) within a lane
+template <typename Number>
+inline const std::vector<double>& planeWeights() {
+    static const std::vector<double> weights = []() {
+        std::vector<double> ret;
+        VECTOR planes[MAX_ARITHMETIC_PLANES];
+        for(int p=0;p<Number::num_params();++p) {
+            for(int j=0;j<Number::num_params();++j)
+                planes[j] = j==p ? ONEHOT(0) : (VECTOR)0;
+            ret.push_back(Number::fromPlanes(planes).get(0));
+        }
+        return ret;
+    }();
+    return weights;
+}
+
+// sum over the masked lanes of a*b, computed with one AND and popcount per plane pair
+template <typename NumberA, typename NumberB>
+inline double dot(const NumberA &a, const NumberB &b, const VECTOR &mask=~(VECTOR)0) {
+    VECTOR aPlanes[MAX_ARITHMETIC_PLANES];
+    VECTOR bPlanes[MAX_ARITHMETIC_PLANES];
+    a.toPlanes(aPlanes);
+    b.toPlanes(bPlanes);
+    const std::vector<double> &aWeights = planeWeights<NumberA>();
+    const std::vector<double> &bWeights = planeWeights<NumberB>();
+    double ret = 0;
+    for(int p=0;p<NumberA::num_params();++p) {
+        VECTOR masked = aPlanes[p] & mask;
+        if(!ANY(masked))
+            continue;
+        double partial = 0;
+        COUNT_PLANES(NumberB::num_params());
+        for(int q=0;q<NumberB::num_params();++q)
+            partial += bWeights[q]*bitcount(masked & bPlanes[q]);
+        ret += aWeights[p]*partial;
+    }
+    return ret;
+}
+
+template <typename NumberA, typename NumberB>
+inline double dot(const Dynamic<NumberA> &a, const NumberB &b, const VECTOR &mask=~(VECTOR)0) {
+    return a.getMantisa()*dot(a.getBody(), b, mask);
+}
+
+template <typename NumberA, typename NumberB>
+inline double dot(const NumberA &a, const Dynamic<NumberB> &b, const VECTOR &mask=~(VECTOR)0) {
+    return b.getMantisa()*dot(a, b.getBody(), mask);
+}
+
+template <typename NumberA, typename NumberB>
+inline double dot(const Dynamic<NumberA> &a, const Dynamic<NumberB> &b, const VECTOR &mask=~(VECTOR)0) {
+    return a.getMantisa()*b.getMantisa()*dot(a.getBody(), b.getBody(), mask);
+}
+
+// lane-by-lane conversion that clips values to the target's range
+template <typename To, typename From>
+inline To convert(const From &from) {
+    To ret;
+    double sup = To::sup();
+    double inf = To::inf();
+    for(int i=0;i<from.size();++i) {
+        double value = from.get(i);
+        if(value)
+            ret.set(i, value>sup ? sup : value<inf ? inf : value);
+    }
+    return ret;
+}
+
+// packed counterpart of convert for targets whose lanes are linear combinations of their planes, such as narrower
+// weights. Values are clipped to the target's range, which is symmetric when the target is signed, and lanes outside
+// the mask become zero. From the most significant plane down, each plane is set where the remaining magnitude
+// reaches its value, less half of the lowest plane so that lanes round to the nearest step, and negative lanes are
+// negated in the target. This takes a few whole-block operations per target plane instead of a get() and set() per
+// lane.
+template <typename To, typename From>
+inline To requantize(const From &from, const VECTOR &mask=~(VECTOR)0) {
+    const std::vector<double> &weights = planeWeights<To>();
+    double half = To::sup();
+    for(double weight : weights)
+        if(weight>0 && weight<2*half)
+            half = weight/2;
+    // sources whose steps are as coarse as the target's hold no values to round
+    if(From::broadcast(half).get(0)!=half)
+        half = 0;
+    double sup = To::sup();
+    double inf = std::max((double)To::inf(), -sup);
+    From remainder = from;
+    if(sup<From::sup()) {
+        From upper = From::broadcast(sup);
+        remainder = upper.merge(remainder, remainder>upper);
+    }
+    if(inf>From::inf()) {
+        From lower = From::broadcast(inf);
+        remainder = lower.merge(remainder, remainder<lower);
+    }
+    VECTOR negative = (remainder<From::broadcast(-half)) & mask;
+    if(ANY(negative))
+        remainder = (From()-remainder).merge(remainder, negative);
+    VECTOR planes[MAX_ARITHMETIC_PLANES];
+    for(int p=To::num_params()-1;p>=0;--p) {
+        planes[p] = 0;
+        if(weights[p]<=0 || weights[p]-half>From::sup())
+            continue;
+        planes[p] = (remainder>=From::broadcast(weights[p]-half)) & mask;
+        if(ANY(planes[p]))
+            remainder = (remainder-From::broadcast(weights[p])).merge(remainder, planes[p]);
+    }
+    To ret = To::fromPlanes(planes);
+    if(ANY(negative))
+        ret = (To()-ret).merge(ret, negative);
+    return ret;
+}
+
+// packed counterpart of convert from types whose lanes are linear combinations of their planes into wider types,
+// as the sum of each plane's value over the lanes where it is set
+template <typename To, typename From>
+inline To widen(const From &from) {
+    const std::vector<double> &weights = planeWeights<From>();
+    VECTOR planes[MAX_ARITHMETIC_PLANES];
+    from.toPlanes(planes);
+    To ret;
+    for(int p=0;p<From::num_params();++p)
+        if(ANY(planes[p]))
+            ret = ret + To::broadcast(weights[p]).merge(To(), planes[p]);
+    return ret;
+}
+
+// lanes below count hold counts[i]*step, e.g. the popcount dots of binary layers: lanes are gathered into one mask
+// per bit of their magnitude, each mask adds a broadcast of its bit's value, and negative lanes are negated at the
+// end, so no lane is set individually
+template <typename Number>
+inline Number fromCounts(const int *counts, int count, double step) {
+    const int maxBits = 8*sizeof(int);
+    VECTOR bits[maxBits];
+    for(int b=0;b<maxBits;++b)
+        bits[b] = 0;
+    VECTOR negative = 0;
+    int top = 0;
+    for(int i=0;i<count;++i) {
+        unsigned int magnitude = counts[i]<0 ? -(unsigned int)counts[i] : counts[i];
+        if(counts[i]<0)
+            negative |= ONEHOT(i);
+        for(int b=0;magnitude;++b, magnitude>>=1)
+            if(magnitude & 1) {
+                bits[b] |= ONEHOT(i);
+                top = std::max(top, b+1);
+            }
+    }
+    Number ret;
+    for(int b=top-1;b>=0;--b)
+        if(ANY(bits[b]))
+            ret = ret + Number::broadcast(std::ldexp(step, b)).merge(Number(), bits[b]);
+    if(ANY(negative))
+        ret = (Number()-ret).merge(ret, negative);
+    return ret;
+}
+
+}
+#endif  // MIXED_H
@@ -0,0 +1,159 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+
+#ifndef PROFILING_H
+#define PROFILING_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+namespace tensorless {
+
+// Operation counters. When PROFILING is defined, bitcount and the raw arithmetic kernels (additions,
+// multiplications, comparisons, merges, two's complements, divisions and square roots) add to thread-local
+// counters, where a plane op is one pass of a kernel over one VECTOR plane. Otherwise the counting compiles away.
+struct OpCounters {
+    long long planeOps = 0;
+    long long popcounts = 0;
+};
+
+inline OpCounters& threadOpCounters() {
+    static thread_local OpCounters counters;
+    return counters;
+}
+
+#ifdef PROFILING
+    #define COUNT_PLANES(planes) (tensorless::threadOpCounters().planeOps += (planes))
+#else
+    #define COUNT_PLANES(planes)
+#endif
+
+// a point in time (steady clock nanoseconds and, on x86, timestamp counter cycles) along with the op counters
+struct ProfileMark {
+    long long nanoseconds;
+    long long cycles;
+    OpCounters ops;
+
+    static ProfileMark now() {
+        ProfileMark mark;
+        mark.ops = threadOpCounters();
+        mark.nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        #if defined(__x86_64__) || defined(__i386__)
+        mark.cycles = __rdtsc();
+        #else
+        mark.cycles = 0;
+        #endif
+        return mark;
+    }
+};
+
+// accumulated cost of one or more layer calls
+//   bytes:       bytes of planes streamed through the kernels (plane ops times the VECTOR size)
+//   lanes:       output lanes produced
+//   activeLanes: nonzero input lanes consumed
+struct Profile {
+    long long calls = 0;
+    long long nanoseconds = 0;
+    long long cycles = 0;
+    long long planeOps = 0;
+    long long popcounts = 0;
+    long long bytes = 0;
+    long long lanes = 0;
+    long long activeLanes = 0;
+
+    static Profile between(const ProfileMark &start, const ProfileMark &end) {
+        Profile ret;
+        ret.calls = 1;
+        ret.nanoseconds = end.nanoseconds-start.nanoseconds;
+        ret.cycles = end.cycles-start.cycles;
+        ret.planeOps = end.ops.planeOps-start.ops.planeOps;
+        ret.popcounts = end.ops.popcounts-start.ops.popcounts;
+        return ret;
+    }
+
+    Profile& operator+=(const Profile &other) {
+        calls += other.calls;
+        nanoseconds += other.nanoseconds;
+        cycles += other.cycles;
+        planeOps += other.planeOps;
+        popcounts += other.popcounts;
+        bytes += other.bytes;
+        lanes += other.lanes;
+        activeLanes += other.activeLanes;
+        return *this;
+    }
+
+    std::string json() const {
+        return "{\"calls\": " + std::to_string(calls)
+              + ", \"nanoseconds\": " + std::to_string(nanoseconds)
+              + ", \"cycles\": " + std::to_string(cycles)
+              + ", \"planeOps\": " + std::to_string(planeOps)
+              + ", \"popcounts\": " + std::to_string(popcounts)
+              + ", \"bytes\": " + std::to_string(bytes)
+              + ", \"lanes\": " + std::to_string(lanes)
+              + ", \"activeLanes\": " + std::to_string(activeLanes) + "}";
+    }
+};
+
+// a single layer call kept for Chrome trace output
+struct ProfileEvent {
+    int layer;
+    bool backward;
+    long long start;
+    Profile profile;
+};
+
+inline std::string jsonString(const std::string &text) {
+    std::string ret = "\"";
+    for(char c : text) {
+        if(c=='"' || c=='\\')
+            ret += '\\';
+        if(c=='\n')
+            ret += "\\n";
+        else
+            ret += c;
+    }
+    return ret + "\"";
+}
+
+// serializes events in the Chrome trace event format (chrome://tracing, Perfetto), with timestamps in
+// microseconds relative to the first event
+inline std::string chromeTrace(const std::vector<ProfileEvent> &events, const std::vector<std::string> &names) {
+    std::string ret = "{\"traceEvents\": [";
+    long long origin = events.size() ? events[0].start : 0;
+    for(size_t i=0;i<events.size();++i) {
+        const ProfileEvent &event = events[i];
+        if(i)
+            ret += ",";
+        ret += "\n  {\"name\": " + jsonString(names[event.layer])
+             + ", \"cat\": " + (event.backward ? "\"backward\"" : "\"forward\"")
+             + ", \"ph\": \"X\", \"pid\": 0, \"tid\": 0"
+             + ", \"ts\": " + std::to_string((event.start-origin)/1000.0)
+             + ", \"dur\": " + std::to_string(event.profile.nanoseconds/1000.0)
+             + ", \"args\": " + event.profile.json() + "}";
+    }
+    return ret + "\n], \"displayTimeUnit\": \"ns\"}\n";
+}
+
+}
+#endif  // PROFILING_H
@@ -22,7 +22,9 @@ limitations under the License.
 #include <bitset>
 #include <cstdlib>
 #include <random>
+#include <type_traits>
 #include "../vecutils.h"
+#include "../arithmetic.h"
 
 namespace tensorless {
 
@@ -31,10 +33,10 @@ private:
     VECTOR value;
     VECTOR value1;
     VECTOR value2;
-    explicit Float3(VECTOR v, VECTOR v1, VECTOR v2) : value(v), value1(v1), value2(v2) {}
+    constexpr explicit Float3(VECTOR v, VECTOR v1, VECTOR v2) : value(v), value1(v1), value2(v2) {}
 public:
     static Float3 random() {return Float3(lrand(), lrand(), 0);}
-    static Float3 broadcast(double val) {
+    static constexpr Float3 broadcast(double val) {
         if(val<0 || val>2)
             throw std::logic_error("can only set values in range [0,2]");
         VECTOR value2 = 0;
@@ -53,7 +55,17 @@ public:
         return Float3(value, value1, value2);
     }
 
-    static int num_params() {
+    inline __attribute__((always_inline)) static Float3 fromPlanes(const VECTOR *planes) {
+        return Float3(planes[0], planes[1], planes[2]);
+    }
+
+    inline __attribute__((always_inline)) void toPlanes(VECTOR *planes) const {
+        planes[0] = value;
+        planes[1] = value1;
+        planes[2] = value2;
+    }
+
+    static constexpr int num_params() {
         return 3;
     }
 
@@ -67,19 +79,8 @@ public:
                 set(i, vec[i]);
     }
     
-    Float3(const Float3 &other) : value(other.value), value1(other.value1), value2(other.value2) {}
-    
-    Float3() : value(0), value1(0), value2(0) {}
+    constexpr Float3() : value(0), value1(0), value2(0) {}
 
-    Float3& operator=(const Float3 &other) {
-        if (this != &other) {
-            value = other.value;
-            value1 = other.value1;
-            value2 = other.value2;
-        }
-        return *this;
-    }
-    
     explicit operator bool() const {
         return ANY(value) || ANY(value1) || ANY(value2);
     }
@@ -158,6 +159,54 @@ public:
         return ret/4.0;
     }
 
+    inline __attribute__((always_inline)) VECTOR argmaxMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & value2;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) VECTOR argminMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & ~value2;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) int argmax(const VECTOR &mask) const {
+        return FIRSTONE(argmaxMask(mask));
+    }
+
+    inline __attribute__((always_inline)) int argmax() const {
+        return FIRSTONE(argmaxMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) int argmin() const {
+        return FIRSTONE(argminMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) double max() const {
+        return get(argmax());
+    }
+
+    inline __attribute__((always_inline)) double min() const {
+        return get(argmin());
+    }
+
     
     const double sum() const {
         int ret = bitcount(value);
@@ -225,6 +274,7 @@ public:
     }
 
     inline __attribute__((always_inline)) Float3 twosComplement(const VECTOR &mask) const {
+        COUNT_PLANES(num_params());
         VECTOR notmask = ~mask;
         return Float3(mask&~value | (notmask&value), 
                       mask&~value1 | (notmask&value1),
@@ -304,7 +354,62 @@ public:
         return Float3(0, 0, (other.value^value) | (other.value1^value1) | (other.value2^value2));
     }
 
+    inline __attribute__((always_inline)) void compareWithCarry(const Float3 &other, VECTOR &greater, VECTOR &equal) const {
+        COUNT_PLANES(2*num_params());
+        greater |= equal & value2 & ~other.value2;
+        equal &= ~(value2 ^ other.value2);
+        greater |= equal & value1 & ~other.value1;
+        equal &= ~(value1 ^ other.value1);
+        greater |= equal & value & ~other.value;
+        equal &= ~(value ^ other.value);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>(const Float3 &other) const {
+        VECTOR greater = 0;
+        VECTOR equal = ~(VECTOR)0;
+        compareWithCarry(other, greater, equal);
+        return greater;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<(const Float3 &other) const {
+        return other > *this;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>=(const Float3 &other) const {
+        return ~(other > *this);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<=(const Float3 &other) const {
+        return ~(*this > other);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator==(const Float3 &other) const {
+        return ~((other.value^value) | (other.value1^value1) | (other.value2^value2));
+    }
+
+    inline __attribute__((always_inline)) Float3 operator/(const Float3 &other) const {
+        return planeDivide(*this, other);
+    }
+
+    inline __attribute__((always_inline)) Float3 reciprocal() const {
+        return planeDivide(broadcast(1), *this);
+    }
+
+    inline __attribute__((always_inline)) Float3 sqrt() const {
+        return planeSqrt(*this);
+    }
+
+    inline __attribute__((always_inline)) Float3 merge(const Float3 &other, const VECTOR &mask) const {
+        COUNT_PLANES(2*num_params());
+        VECTOR notmask = ~mask;
+        return Float3((value&mask) | (other.value & notmask), 
+                      (value1&mask) | (other.value1 & notmask),
+                      (value2&mask) | (other.value2 & notmask)
+                      );
+    }
+
     inline __attribute__((always_inline)) Float3 operator*(const Float3 &other) const {
+        COUNT_PLANES(2*num_params());
         Float3 ret = Float3(value2&other.value, value2&other.value1, value2&other.value2);
         ret.selfAdd(value1&other.value1, value1&other.value2);
         ret.selfAdd(value&other.value2);
@@ -331,6 +436,7 @@ public:
     }
 
     inline __attribute__((always_inline)) Float3 operator+(const Float3 &other) const {
+        COUNT_PLANES(2*num_params());
         VECTOR carry = other.value&value;
         VECTOR carry1 = (value1 & other.value1) | (carry & (value1 ^ other.value1));
         
@@ -372,15 +478,15 @@ public:
         return *this;
     }
 
-    static double sup() {
+    static constexpr double sup() {
         return 1.75;
     }
 
-    static double eps() {
+    static constexpr double eps() {
         return 0.25;
     }
 
-    static double inf() {
+    static constexpr double inf() {
         return 0;
     }
 
@@ -394,6 +500,8 @@ public:
     }
 };
 
+static_assert(std::is_trivially_copyable<Float3>::value, "packed types are copied as plain bit-planes");
+
 }
 
 #endif // FLOAT3_H
@@ -22,7 +22,9 @@ limitations under the License.
 #include <bitset>
 #include <cstdlib>
 #include <random>
+#include <type_traits>
 #include "../vecutils.h"
+#include "../arithmetic.h"
 
 
 namespace tensorless {
@@ -33,11 +35,11 @@ private:
     VECTOR value1;
     VECTOR value2;
     VECTOR value3;
-    explicit Float4(VECTOR v, VECTOR v1, VECTOR v2, VECTOR v3) : value(v), value1(v1), value2(v2), value3(v3) {}
+    constexpr explicit Float4(VECTOR v, VECTOR v1, VECTOR v2, VECTOR v3) : value(v), value1(v1), value2(v2), value3(v3) {}
 
 public:
     static Float4 random() {return Float4(lrand(), lrand(), lrand(), 0);}
-    static Float4 broadcast(double val) {
+    static constexpr Float4 broadcast(double val) {
         if(val<0 || val>2)
             throw std::logic_error("can only set values in range [0,2]");
         VECTOR value3 = 0;
@@ -60,7 +62,18 @@ public:
             value = ~value;
         return Float4(value, value1, value2, value3);
     }
-    static int num_params() {
+    inline __attribute__((always_inline)) static Float4 fromPlanes(const VECTOR *planes) {
+        return Float4(planes[0], planes[1], planes[2], planes[3]);
+    }
+
+    inline __attribute__((always_inline)) void toPlanes(VECTOR *planes) const {
+        planes[0] = value;
+        planes[1] = value1;
+        planes[2] = value2;
+        planes[3] = value3;
+    }
+
+    static constexpr int num_params() {
         return 4;
     }
     
@@ -121,20 +134,8 @@ public:
                 set(i, vec[i]);
     }
     
-    Float4(const Float4 &other) : value(other.value), value1(other.value1), value2(other.value2), value3(other.value3) {}
-    
-    Float4() : value(0), value1(0), value2(0), value3(0) {}
-
-    Float4& operator=(const Float4 &other) {
-        if (this != &other) {
-            value = other.value;
-            value1 = other.value1;
-            value2 = other.value2;
-            value3 = other.value3;
-        }
-        return *this;
-    }
-    
+    constexpr Float4() : value(0), value1(0), value2(0), value3(0) {}
+
     explicit operator bool() const {
         return ANY(value) || ANY(value1) || ANY(value2) || ANY(value3);
     }
@@ -186,6 +187,60 @@ public:
         return ret/8.0;
     }
 
+    inline __attribute__((always_inline)) VECTOR argmaxMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & value3;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value2;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) VECTOR argminMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & ~value3;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value2;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) int argmax(const VECTOR &mask) const {
+        return FIRSTONE(argmaxMask(mask));
+    }
+
+    inline __attribute__((always_inline)) int argmax() const {
+        return FIRSTONE(argmaxMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) int argmin() const {
+        return FIRSTONE(argminMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) double max() const {
+        return get(argmax());
+    }
+
+    inline __attribute__((always_inline)) double min() const {
+        return get(argmin());
+    }
+
     const double sum() const {
         int ret = bitcount(value);
         ret += bitcount(value1)*2;
@@ -261,6 +316,7 @@ public:
     }
     
     inline __attribute__((always_inline)) Float4 twosComplement(const VECTOR &mask) const {
+        COUNT_PLANES(num_params());
         VECTOR notmask = ~mask;
         return Float4(mask&~value | (notmask&value), 
                       mask&~value1 | (notmask&value1),
@@ -293,9 +349,67 @@ public:
     inline __attribute__((always_inline)) Float4 operator!=(const Float4 &other) const {
         return Float4(0, 0, 0, (other.value^value) | (other.value1^value1) | (other.value2^value2) | (other.value3^value3));
     }
+
+    inline __attribute__((always_inline)) void compareWithCarry(const Float4 &other, VECTOR &greater, VECTOR &equal) const {
+        COUNT_PLANES(2*num_params());
+        greater |= equal & value3 & ~other.value3;
+        equal &= ~(value3 ^ other.value3);
+        greater |= equal & value2 & ~other.value2;
+        equal &= ~(value2 ^ other.value2);
+        greater |= equal & value1 & ~other.value1;
+        equal &= ~(value1 ^ other.value1);
+        greater |= equal & value & ~other.value;
+        equal &= ~(value ^ other.value);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>(const Float4 &other) const {
+        VECTOR greater = 0;
+        VECTOR equal = ~(VECTOR)0;
+        compareWithCarry(other, greater, equal);
+        return greater;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<(const Float4 &other) const {
+        return other > *this;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>=(const Float4 &other) const {
+        return ~(other > *this);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<=(const Float4 &other) const {
+        return ~(*this > other);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator==(const Float4 &other) const {
+        return ~((other.value^value) | (other.value1^value1) | (other.value2^value2) | (other.value3^value3));
+    }
+
+    inline __attribute__((always_inline)) Float4 operator/(const Float4 &other) const {
+        return planeDivide(*this, other);
+    }
+
+    inline __attribute__((always_inline)) Float4 reciprocal() const {
+        return planeDivide(broadcast(1), *this);
+    }
+
+    inline __attribute__((always_inline)) Float4 sqrt() const {
+        return planeSqrt(*this);
+    }
+
+    inline __attribute__((always_inline)) Float4 merge(const Float4 &other, const VECTOR &mask) const {
+        COUNT_PLANES(2*num_params());
+        VECTOR notmask = ~mask;
+        return Float4((value&mask) | (other.value & notmask), 
+                      (value1&mask) | (other.value1 & notmask),
+                      (value2&mask) | (other.value2 & notmask),
+                      (value3&mask) | (other.value3 & notmask)
+                      );
+    }
     
 
     inline __attribute__((always_inline)) Float4 operator*(const Float4 &other) const {
+        COUNT_PLANES(2*num_params());
         Float4 ret = Float4(value3&other.value, value3&other.value1, value3&other.value2, value3&other.value3);
         ret.selfAdd(value2&other.value1, value2&other.value2, value2&other.value3);
         ret.selfAdd(value1&other.value2, value1&other.value3);
@@ -400,6 +514,7 @@ public:
     }
 
     Float4 operator+(const Float4 &other) const {
+        COUNT_PLANES(2*num_params());
         VECTOR carry = other.value&value;
         VECTOR carry1 = (value1 & other.value1) | (carry & (value1 ^ other.value1));
         VECTOR carry2 = (value2 & other.value2) | (carry1 & (value2 ^ other.value2));
@@ -446,15 +561,15 @@ public:
         return *this;
     }
 
-    static double sup() {
+    static constexpr double sup() {
         return 1.875;
     }
 
-    static double eps() {
+    static constexpr double eps() {
         return 0.125;
     }
 
-    static double inf() {
+    static constexpr double inf() {
         return 0;
     }
 
@@ -468,6 +583,8 @@ public:
     }
 };
 
+static_assert(std::is_trivially_copyable<Float4>::value, "packed types are copied as plain bit-planes");
+
 }
 
 #endif // FLOAT4_H
@@ -22,7 +22,9 @@ limitations under the License.
 #include <bitset>
 #include <cstdlib>
 #include <random>
+#include <type_traits>
 #include "../vecutils.h"
+#include "../arithmetic.h"
 
 namespace tensorless {
 
@@ -33,10 +35,10 @@ private:
     VECTOR value2;
     VECTOR value3;
     VECTOR value4;
-    explicit Float5(VECTOR v, VECTOR v1, VECTOR v2, VECTOR v3, VECTOR v4) : value(v), value1(v1), value2(v2), value3(v3), value4(v4) {}
+    constexpr explicit Float5(VECTOR v, VECTOR v1, VECTOR v2, VECTOR v3, VECTOR v4) : value(v), value1(v1), value2(v2), value3(v3), value4(v4) {}
 public:
     static Float5 random() {return Float5(lrand(), lrand(), lrand(), lrand(), 0);}
-    static Float5 broadcast(double val) {
+    static constexpr Float5 broadcast(double val) {
         if(val<0 || val>2)
             throw std::logic_error("can only set values in range [0,2]");
         VECTOR value4 = 0;
@@ -64,7 +66,19 @@ public:
             value = ~value;
         return Float5(value, value1, value2, value3, value4);
     }
-    static int num_params() {
+    inline __attribute__((always_inline)) static Float5 fromPlanes(const VECTOR *planes) {
+        return Float5(planes[0], planes[1], planes[2], planes[3], planes[4]);
+    }
+
+    inline __attribute__((always_inline)) void toPlanes(VECTOR *planes) const {
+        planes[0] = value;
+        planes[1] = value1;
+        planes[2] = value2;
+        planes[3] = value3;
+        planes[4] = value4;
+    }
+
+    static constexpr int num_params() {
         return 5;
     }
 
@@ -78,21 +92,8 @@ public:
                 set(i, vec[i]);
     }
     
-    Float5(const Float5 &other) : value(other.value), value1(other.value1), value2(other.value2), value3(other.value3), value4(other.value4) {}
-    
-    Float5() : value(0), value1(0), value2(0), value3(0), value4(0) {}
-
-    inline __attribute__((always_inline)) Float5& operator=(const Float5 &other) {
-        if (this != &other) {
-            value = other.value;
-            value1 = other.value1;
-            value2 = other.value2;
-            value3 = other.value3;
-            value4 = other.value4;
-        }
-        return *this;
-    }
-    
+    constexpr Float5() : value(0), value1(0), value2(0), value3(0), value4(0) {}
+
     explicit operator bool() const {
         return ANY(value) || ANY(value1) || ANY(value2) || ANY(value3) || ANY(value4);
     }
@@ -199,6 +200,66 @@ public:
         return ret/16.0;
     }
 
+    inline __attribute__((always_inline)) VECTOR argmaxMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & value4;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value3;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value2;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) VECTOR argminMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & ~value4;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value3;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value2;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) int argmax(const VECTOR &mask) const {
+        return FIRSTONE(argmaxMask(mask));
+    }
+
+    inline __attribute__((always_inline)) int argmax() const {
+        return FIRSTONE(argmaxMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) int argmin() const {
+        return FIRSTONE(argminMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) double max() const {
+        return get(argmax());
+    }
+
+    inline __attribute__((always_inline)) double min() const {
+        return get(argmin());
+    }
+
     inline __attribute__((always_inline)) const double sum() const {
         int ret = bitcount(value);
         ret += bitcount(value1)*2;
@@ -307,7 +368,68 @@ public:
         return Float5(0, 0, 0, 0, (other.value^value) | (other.value1^value1) | (other.value2^value2) | (other.value3^value3) | (other.value4^value4));
     }
 
+    inline __attribute__((always_inline)) void compareWithCarry(const Float5 &other, VECTOR &greater, VECTOR &equal) const {
+        COUNT_PLANES(2*num_params());
+        greater |= equal & value4 & ~other.value4;
+        equal &= ~(value4 ^ other.value4);
+        greater |= equal & value3 & ~other.value3;
+        equal &= ~(value3 ^ other.value3);
+        greater |= equal & value2 & ~other.value2;
+        equal &= ~(value2 ^ other.value2);
+        greater |= equal & value1 & ~other.value1;
+        equal &= ~(value1 ^ other.value1);
+        greater |= equal & value & ~other.value;
+        equal &= ~(value ^ other.value);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>(const Float5 &other) const {
+        VECTOR greater = 0;
+        VECTOR equal = ~(VECTOR)0;
+        compareWithCarry(other, greater, equal);
+        return greater;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<(const Float5 &other) const {
+        return other > *this;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>=(const Float5 &other) const {
+        return ~(other > *this);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<=(const Float5 &other) const {
+        return ~(*this > other);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator==(const Float5 &other) const {
+        return ~((other.value^value) | (other.value1^value1) | (other.value2^value2) | (other.value3^value3) | (other.value4^value4));
+    }
+
+    inline __attribute__((always_inline)) Float5 operator/(const Float5 &other) const {
+        return planeDivide(*this, other);
+    }
+
+    inline __attribute__((always_inline)) Float5 reciprocal() const {
+        return planeDivide(broadcast(1), *this);
+    }
+
+    inline __attribute__((always_inline)) Float5 sqrt() const {
+        return planeSqrt(*this);
+    }
+
+    inline __attribute__((always_inline)) Float5 merge(const Float5 &other, const VECTOR &mask) const {
+        COUNT_PLANES(2*num_params());
+        VECTOR notmask = ~mask;
+        return Float5((value&mask) | (other.value & notmask), 
+                      (value1&mask) | (other.value1 & notmask),
+                      (value2&mask) | (other.value2 & notmask),
+                      (value3&mask) | (other.value3 & notmask),
+                      (value4&mask) | (other.value4 & notmask)
+                      );
+    }
+
     inline __attribute__((always_inline)) Float5 operator*(const Float5 &other) const {
+        COUNT_PLANES(2*num_params());
         Float5 ret = Float5(value4&other.value, value4&other.value1, value4&other.value2, value4&other.value3, value4&other.value4);
         ret.selfAdd(value3&other.value1, value3&other.value2, value3&other.value3, value3&other.value4);
         ret.selfAdd(value2&other.value2, value2&other.value3, value2&other.value4);
@@ -449,6 +571,7 @@ public:
     }
 
     inline __attribute__((always_inline)) Float5 twosComplement(const VECTOR &mask) const {
+        COUNT_PLANES(num_params());
         VECTOR notmask = ~mask;
         return Float5((mask&~value) | (notmask&value), 
                       (mask&~value1) | (notmask&value1),
@@ -477,6 +600,7 @@ public:
     }
 
     inline __attribute__((always_inline)) Float5 operator+(const Float5 &other) const {
+        COUNT_PLANES(2*num_params());
         VECTOR carry = other.value&value;
         VECTOR carry1 = (value1 & other.value1) | (carry & (value1 ^ other.value1));
         VECTOR carry2 = (value2 & other.value2) | (carry1 & (value2 ^ other.value2));
@@ -532,15 +656,15 @@ public:
         return *this;
     }
 
-    static double sup() {
+    static constexpr double sup() {
         return 1.9375;
     }
 
-    static double eps() {
+    static constexpr double eps() {
         return 0.0625;
     }
 
-    static double inf() {
+    static constexpr double inf() {
         return 0;
     }
 
@@ -553,6 +677,9 @@ public:
         return Float5(value&notmask, value1&notmask, value2&notmask, value3&notmask, value4&notmask);
     }
 };
+
+static_assert(std::is_trivially_copyable<Float5>::value, "packed types are copied as plain bit-planes");
+
 }
 
 #endif // FLOAT5_H
@@ -22,7 +22,9 @@ limitations under the License.
 #include <bitset>
 #include <cstdlib>
 #include <random>
+#include <type_traits>
 #include "../vecutils.h"
+#include "../arithmetic.h"
 
 namespace tensorless {
 
@@ -34,12 +36,12 @@ private:
     VECTOR value3;
     VECTOR value4;
     VECTOR value5;
-    explicit Float6(VECTOR v, VECTOR v1, VECTOR v2, VECTOR v3, VECTOR v4, VECTOR v5) : 
+    constexpr explicit Float6(VECTOR v, VECTOR v1, VECTOR v2, VECTOR v3, VECTOR v4, VECTOR v5) : 
         value(v), value1(v1), value2(v2), value3(v3), value4(v4), value5(v5) {}
 public:
     static inline __attribute__((always_inline)) Float6 random() {return Float6(lrand(), lrand(), lrand(), lrand(), lrand(), 0);}
     
-    static inline __attribute__((always_inline)) Float6 broadcast(double val) {
+    static inline __attribute__((always_inline)) constexpr Float6 broadcast(double val) {
         if(val<0 || val>1)
             throw std::logic_error("can only set values in range [0,1]");
         VECTOR value5 = 0;
@@ -80,22 +82,7 @@ public:
                 set(i, vec[i]);
     }
     
-    inline __attribute__((always_inline)) Float6(const Float6 &other) : 
-        value(other.value), value1(other.value1), value2(other.value2), value3(other.value3), value4(other.value4), value5(other.value5) {}
-    
-    inline __attribute__((always_inline)) Float6() : value(0), value1(0), value2(0), value3(0), value4(0), value5(0) {}
-
-    inline __attribute__((always_inline)) Float6& operator=(const Float6 &other) {
-        if (this != &other) {
-            value = other.value;
-            value1 = other.value1;
-            value2 = other.value2;
-            value3 = other.value3;
-            value4 = other.value4;
-            value5 = other.value5;
-        }
-        return *this;
-    }
+    inline __attribute__((always_inline)) constexpr Float6() : value(0), value1(0), value2(0), value3(0), value4(0), value5(0) {}
 
     inline __attribute__((always_inline)) Float6 times2() const {
         #ifdef DEBUG_OVERFLOWS
@@ -165,7 +152,20 @@ public:
                                          value5 & notmask);
     }
 
-    inline __attribute__((always_inline)) static int num_params() {
+    inline __attribute__((always_inline)) static Float6 fromPlanes(const VECTOR *planes) {
+        return Float6(planes[0], planes[1], planes[2], planes[3], planes[4], planes[5]);
+    }
+
+    inline __attribute__((always_inline)) void toPlanes(VECTOR *planes) const {
+        planes[0] = value;
+        planes[1] = value1;
+        planes[2] = value2;
+        planes[3] = value3;
+        planes[4] = value4;
+        planes[5] = value5;
+    }
+
+    inline __attribute__((always_inline)) static constexpr int num_params() {
         return 6;
     }
 
@@ -234,7 +234,73 @@ public:
         if(ANY(v)) {
             ret += 1;
         }
-        return ret/32.0;
+        return ret/64.0;
+    }
+
+    inline __attribute__((always_inline)) VECTOR argmaxMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & value5;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value4;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value3;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value2;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) VECTOR argminMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & ~value5;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value4;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value3;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value2;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) int argmax(const VECTOR &mask) const {
+        return FIRSTONE(argmaxMask(mask));
+    }
+
+    inline __attribute__((always_inline)) int argmax() const {
+        return FIRSTONE(argmaxMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) int argmin() const {
+        return FIRSTONE(argminMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) double max() const {
+        return get(argmax());
+    }
+
+    inline __attribute__((always_inline)) double min() const {
+        return get(argmin());
     }
 
     inline __attribute__((always_inline)) const double sum() const {
@@ -244,7 +310,7 @@ public:
         ret += bitcount(value3)*8;
         ret += bitcount(value4)*16;
         ret += bitcount(value5)*32;
-        return ret/32.0;
+        return ret/64.0;
     }
 
     inline __attribute__((always_inline)) const double sum(const VECTOR &mask) const {
@@ -254,7 +320,7 @@ public:
         ret += bitcount(value3 & mask)*8;
         ret += bitcount(value4 & mask)*16;
         ret += bitcount(value5 & mask)*32;
-        return ret/32.0;
+        return ret/64.0;
     }
     
     inline __attribute__((always_inline)) const double get(int i) const {
@@ -264,7 +330,7 @@ public:
         ret += GETAT(value3, i)*8;
         ret += GETAT(value4, i)*16;
         ret += GETAT(value5, i)*32;
-        return ret/32.0;
+        return ret/64.0;
     }
 
     inline __attribute__((always_inline)) const Float6& set(int i, double val) {
@@ -357,13 +423,76 @@ public:
             (other.value^value) | (other.value1^value1) | (other.value2^value2) | (other.value3^value3) | (other.value4^value4) | (other.value5^value5));
     }
 
+    inline __attribute__((always_inline)) void compareWithCarry(const Float6 &other, VECTOR &greater, VECTOR &equal) const {
+        COUNT_PLANES(2*num_params());
+        greater |= equal & value5 & ~other.value5;
+        equal &= ~(value5 ^ other.value5);
+        greater |= equal & value4 & ~other.value4;
+        equal &= ~(value4 ^ other.value4);
+        greater |= equal & value3 & ~other.value3;
+        equal &= ~(value3 ^ other.value3);
+        greater |= equal & value2 & ~other.value2;
+        equal &= ~(value2 ^ other.value2);
+        greater |= equal & value1 & ~other.value1;
+        equal &= ~(value1 ^ other.value1);
+        greater |= equal & value & ~other.value;
+        equal &= ~(value ^ other.value);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>(const Float6 &other) const {
+        VECTOR greater = 0;
+        VECTOR equal = ~(VECTOR)0;
+        compareWithCarry(other, greater, equal);
+        return greater;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<(const Float6 &other) const {
+        return other > *this;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>=(const Float6 &other) const {
+        return ~(other > *this);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<=(const Float6 &other) const {
+        return ~(*this > other);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator==(const Float6 &other) const {
+        return ~((other.value^value) | (other.value1^value1) | (other.value2^value2) | (other.value3^value3) | (other.value4^value4) | (other.value5^value5));
+    }
+
+    inline __attribute__((always_inline)) Float6 operator/(const Float6 &other) const {
+        return planeDivide(*this, other);
+    }
+
+    inline __attribute__((always_inline)) Float6 reciprocal() const {
+        return planeDivide(broadcast(1), *this);
+    }
+
+    inline __attribute__((always_inline)) Float6 sqrt() const {
+        return planeSqrt(*this);
+    }
+
+    inline __attribute__((always_inline)) Float6 merge(const Float6 &other, const VECTOR &mask) const {
+        COUNT_PLANES(2*num_params());
+        VECTOR notmask = ~mask;
+        return Float6((value&mask) | (other.value & notmask), 
+                      (value1&mask) | (other.value1 & notmask),
+                      (value2&mask) | (other.value2 & notmask),
+                      (value3&mask) | (other.value3 & notmask),
+                      (value4&mask) | (other.value4 & notmask),
+                      (value5&mask) | (other.value5 & notmask)
+                      );
+    }
+
     inline __attribute__((always_inline)) Float6 operator*(const Float6 &other) const {
-        Float6 ret = Float6(value5&other.value, value5&other.value1, value5&other.value2, value5&other.value3, value5&other.value4, value5&other.value5);
-        ret += Float6(value4&other.value1, value4&other.value2, value4&other.value3, value4&other.value4, value4&other.value5, 0);
-        ret += Float6(value3&other.value2, value3&other.value3, value3&other.value4, value3&other.value5, 0, 0);
-        ret += Float6(value2&other.value3, value2&other.value4, value2&other.value5, 0, 0, 0);
-        ret += Float6(value1&other.value4, value1&other.value5, 0, 0, 0, 0);
-        ret += Float6(value&other.value5, 0, 0, 0, 0, 0);
+        COUNT_PLANES(2*num_params());
+        Float6 ret = Float6(value5&other.value1, value5&other.value2, value5&other.value3, value5&other.value4, value5&other.value5, 0);
+        ret += Float6(value4&other.value2, value4&other.value3, value4&other.value4, value4&other.value5, 0, 0);
+        ret += Float6(value3&other.value3, value3&other.value4, value3&other.value5, 0, 0, 0);
+        ret += Float6(value2&other.value4, value2&other.value5, 0, 0, 0, 0);
+        ret += Float6(value1&other.value5, 0, 0, 0, 0, 0);
 
         return ret;
     }
@@ -400,6 +529,7 @@ public:
     }
 
     inline __attribute__((always_inline)) Float6 twosComplement(const VECTOR &mask) const {
+        COUNT_PLANES(num_params());
         VECTOR notmask = ~mask;
         return Float6((mask&~value) | (notmask&value), 
                       (mask&~value1) | (notmask&value1),
@@ -432,6 +562,7 @@ public:
     }
 
     inline __attribute__((always_inline)) Float6 operator+(const Float6 &other) const {
+        COUNT_PLANES(2*num_params());
         VECTOR carry = other.value&value;
         VECTOR carry1 = (value1 & other.value1) | (carry & (value1 ^ other.value1));
         VECTOR carry2 = (value2 & other.value2) | (carry1 & (value2 ^ other.value2));
@@ -475,12 +606,11 @@ public:
     }
     
     inline __attribute__((always_inline)) const Float6& operator*=(const Float6 &other) {
-        Float6 ret = Float6(value5&other.value, value5&other.value1, value5&other.value2, value5&other.value3, value5&other.value4, value5&other.value5);
-        ret += Float6(value4&other.value1, value4&other.value2, value4&other.value3, value4&other.value4, value4&other.value5, 0);
-        ret += Float6(value3&other.value2, value3&other.value3, value3&other.value4, value3&other.value5, 0, 0);
-        ret += Float6(value2&other.value3, value2&other.value4, value2&other.value5, 0, 0, 0);
-        ret += Float6(value1&other.value4, value1&other.value5, 0, 0, 0, 0);
-        ret += Float6(value&other.value5, 0, 0, 0, 0, 0);
+        Float6 ret = Float6(value5&other.value1, value5&other.value2, value5&other.value3, value5&other.value4, value5&other.value5, 0);
+        ret += Float6(value4&other.value2, value4&other.value3, value4&other.value4, value4&other.value5, 0, 0);
+        ret += Float6(value3&other.value3, value3&other.value4, value3&other.value5, 0, 0, 0);
+        ret += Float6(value2&other.value4, value2&other.value5, 0, 0, 0, 0);
+        ret += Float6(value1&other.value5, 0, 0, 0, 0, 0);
         value = ret.value;
         value1 = ret.value1;
         value2 = ret.value2;
@@ -490,15 +620,15 @@ public:
         return *this;
     }
 
-    inline __attribute__((always_inline)) static double sup() {
+    inline __attribute__((always_inline)) static constexpr double sup() {
         return 0.984375;
     }
     
-    static double eps() {
-        return 0.0078125;
+    static constexpr double eps() {
+        return 0.015625;
     }
 
-    inline __attribute__((always_inline)) static double inf() {
+    inline __attribute__((always_inline)) static constexpr double inf() {
         return 0;
     }
 
@@ -511,6 +641,9 @@ public:
         return Float6(value&notmask, value1&notmask, value2&notmask, value3&notmask, value4&notmask, value5&notmask);
     }
 };
+
+static_assert(std::is_trivially_copyable<Float6>::value, "packed types are copied as plain bit-planes");
+
 }
 
 #endif // Float6_H
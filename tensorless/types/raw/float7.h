@@ -22,7 +22,9 @@ limitations under the License.
 #include <bitset>
 #include <cstdlib>
 #include <random>
+#include <type_traits>
 #include "../vecutils.h"
+#include "../arithmetic.h"
 
 namespace tensorless {
 
@@ -35,12 +37,12 @@ private:
     VECTOR value4;
     VECTOR value5;
     VECTOR value6;
-    explicit Float7(VECTOR v, VECTOR v1, VECTOR v2, VECTOR v3, VECTOR v4, VECTOR v5, VECTOR v6) : 
+    constexpr explicit Float7(VECTOR v, VECTOR v1, VECTOR v2, VECTOR v3, VECTOR v4, VECTOR v5, VECTOR v6) : 
         value(v), value1(v1), value2(v2), value3(v3), value4(v4), value5(v5), value6(v6) {}
 public:
     static inline __attribute__((always_inline)) Float7 random() {return Float7(lrand(), lrand(), lrand(), lrand(), lrand(), lrand(), 0);}
     
-    static inline __attribute__((always_inline)) Float7 broadcast(double val) {
+    static inline __attribute__((always_inline)) constexpr Float7 broadcast(double val) {
         if(val<0 || val>1)
             throw std::logic_error("can only set values in range [0,1]");
         VECTOR value6 = 0;
@@ -86,23 +88,7 @@ public:
                 set(i, vec[i]);
     }
     
-    inline __attribute__((always_inline)) Float7(const Float7 &other) : 
-        value(other.value), value1(other.value1), value2(other.value2), value3(other.value3), value4(other.value4), value5(other.value5), value6(other.value6) {}
-    
-    inline __attribute__((always_inline)) Float7() : value(0), value1(0), value2(0), value3(0), value4(0), value5(0), value6(0) {}
-
-    inline __attribute__((always_inline)) Float7& operator=(const Float7 &other) {
-        if (this != &other) {
-            value = other.value;
-            value1 = other.value1;
-            value2 = other.value2;
-            value3 = other.value3;
-            value4 = other.value4;
-            value5 = other.value5;
-            value6 = other.value6;
-        }
-        return *this;
-    }
+    inline __attribute__((always_inline)) constexpr Float7() : value(0), value1(0), value2(0), value3(0), value4(0), value5(0), value6(0) {}
 
     inline __attribute__((always_inline)) Float7 times2() const {
         #ifdef DEBUG_OVERFLOWS
@@ -176,7 +162,21 @@ public:
                                          value6 & notmask);
     }
 
-    inline __attribute__((always_inline)) static int num_params() {
+    inline __attribute__((always_inline)) static Float7 fromPlanes(const VECTOR *planes) {
+        return Float7(planes[0], planes[1], planes[2], planes[3], planes[4], planes[5], planes[6]);
+    }
+
+    inline __attribute__((always_inline)) void toPlanes(VECTOR *planes) const {
+        planes[0] = value;
+        planes[1] = value1;
+        planes[2] = value2;
+        planes[3] = value3;
+        planes[4] = value4;
+        planes[5] = value5;
+        planes[6] = value6;
+    }
+
+    inline __attribute__((always_inline)) static constexpr int num_params() {
         return 7;
     }
 
@@ -250,7 +250,79 @@ public:
         if(ANY(v)) {
             ret += 1;
         }
-        return ret/64.0;
+        return ret/128.0;
+    }
+
+    inline __attribute__((always_inline)) VECTOR argmaxMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & value6;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value5;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value4;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value3;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value2;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) VECTOR argminMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & ~value6;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value5;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value4;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value3;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value2;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) int argmax(const VECTOR &mask) const {
+        return FIRSTONE(argmaxMask(mask));
+    }
+
+    inline __attribute__((always_inline)) int argmax() const {
+        return FIRSTONE(argmaxMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) int argmin() const {
+        return FIRSTONE(argminMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) double max() const {
+        return get(argmax());
+    }
+
+    inline __attribute__((always_inline)) double min() const {
+        return get(argmin());
     }
 
     inline __attribute__((always_inline)) const double sum() const {
@@ -261,7 +333,7 @@ public:
         ret += bitcount(value4)*16;
         ret += bitcount(value5)*32;
         ret += bitcount(value6)*64;
-        return ret/64.0;
+        return ret/128.0;
     }
 
     inline __attribute__((always_inline)) const double sum(const VECTOR &mask) const {
@@ -272,7 +344,7 @@ public:
         ret += bitcount(value4 & mask)*16;
         ret += bitcount(value5 & mask)*32;
         ret += bitcount(value6 & mask)*64;
-        return ret/64.0;
+        return ret/128.0;
     }
     
     inline __attribute__((always_inline)) const double get(int i) const {
@@ -283,7 +355,7 @@ public:
         ret += GETAT(value4, i)*16;
         ret += GETAT(value5, i)*32;
         ret += GETAT(value6, i)*64;
-        return ret/64.0;
+        return ret/128.0;
     }
 
     inline __attribute__((always_inline)) const Float7& set(int i, double val) {
@@ -385,14 +457,80 @@ public:
             (other.value^value) | (other.value1^value1) | (other.value2^value2) | (other.value3^value3) | (other.value4^value4) | (other.value5^value5) | (other.value6^value6));
     }
 
+    inline __attribute__((always_inline)) void compareWithCarry(const Float7 &other, VECTOR &greater, VECTOR &equal) const {
+        COUNT_PLANES(2*num_params());
+        greater |= equal & value6 & ~other.value6;
+        equal &= ~(value6 ^ other.value6);
+        greater |= equal & value5 & ~other.value5;
+        equal &= ~(value5 ^ other.value5);
+        greater |= equal & value4 & ~other.value4;
+        equal &= ~(value4 ^ other.value4);
+        greater |= equal & value3 & ~other.value3;
+        equal &= ~(value3 ^ other.value3);
+        greater |= equal & value2 & ~other.value2;
+        equal &= ~(value2 ^ other.value2);
+        greater |= equal & value1 & ~other.value1;
+        equal &= ~(value1 ^ other.value1);
+        greater |= equal & value & ~other.value;
+        equal &= ~(value ^ other.value);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>(const Float7 &other) const {
+        VECTOR greater = 0;
+        VECTOR equal = ~(VECTOR)0;
+        compareWithCarry(other, greater, equal);
+        return greater;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<(const Float7 &other) const {
+        return other > *this;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>=(const Float7 &other) const {
+        return ~(other > *this);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<=(const Float7 &other) const {
+        return ~(*this > other);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator==(const Float7 &other) const {
+        return ~((other.value^value) | (other.value1^value1) | (other.value2^value2) | (other.value3^value3) | (other.value4^value4) | (other.value5^value5) | (other.value6^value6));
+    }
+
+    inline __attribute__((always_inline)) Float7 operator/(const Float7 &other) const {
+        return planeDivide(*this, other);
+    }
+
+    inline __attribute__((always_inline)) Float7 reciprocal() const {
+        return planeDivide(broadcast(1), *this);
+    }
+
+    inline __attribute__((always_inline)) Float7 sqrt() const {
+        return planeSqrt(*this);
+    }
+
+    inline __attribute__((always_inline)) Float7 merge(const Float7 &other, const VECTOR &mask) const {
+        COUNT_PLANES(2*num_params());
+        VECTOR notmask = ~mask;
+        return Float7((value&mask) | (other.value & notmask), 
+                      (value1&mask) | (other.value1 & notmask),
+                      (value2&mask) | (other.value2 & notmask),
+                      (value3&mask) | (other.value3 & notmask),
+                      (value4&mask) | (other.value4 & notmask),
+                      (value5&mask) | (other.value5 & notmask),
+                      (value6&mask) | (other.value6 & notmask)
+                      );
+    }
+
     inline __attribute__((always_inline)) Float7 operator*(const Float7 &other) const {
-        Float7 ret = Float7(value6&other.value, value6&other.value1, value6&other.value2, value6&other.value3, value6&other.value4, value6&other.value5, value6&other.value6);
-        ret.selfAdd(value5&other.value1, value5&other.value2, value5&other.value3, value5&other.value4, value5&other.value5, value5&other.value6);
-        ret.selfAdd(value4&other.value2, value4&other.value3, value4&other.value4, value4&other.value5, value4&other.value6);
-        ret.selfAdd(value3&other.value3, value3&other.value4, value3&other.value5, value3&other.value6);
-        ret.selfAdd(value2&other.value4, value2&other.value5, value2&other.value6);
-        ret.selfAdd(value1&other.value5, value1&other.value6);
-        ret.selfAdd(value&other.value6);
+        COUNT_PLANES(2*num_params());
+        Float7 ret = Float7(value6&other.value1, value6&other.value2, value6&other.value3, value6&other.value4, value6&other.value5, value6&other.value6, 0);
+        ret.selfAdd(value5&other.value2, value5&other.value3, value5&other.value4, value5&other.value5, value5&other.value6);
+        ret.selfAdd(value4&other.value3, value4&other.value4, value4&other.value5, value4&other.value6);
+        ret.selfAdd(value3&other.value4, value3&other.value5, value3&other.value6);
+        ret.selfAdd(value2&other.value5, value2&other.value6);
+        ret.selfAdd(value1&other.value6);
 
         return ret;
     }
@@ -433,6 +571,7 @@ public:
     }
 
     inline __attribute__((always_inline)) Float7 twosComplement(const VECTOR &mask) const {
+        COUNT_PLANES(num_params());
         VECTOR notmask = ~mask;
         return Float7((mask&~value) | (notmask&value), 
                       (mask&~value1) | (notmask&value1),
@@ -467,6 +606,7 @@ public:
     }
 
     inline __attribute__((always_inline)) Float7 operator+(const Float7 &other) const {
+        COUNT_PLANES(2*num_params());
         VECTOR carry = other.value&value;
         VECTOR carry1 = (value1 & other.value1) | (carry & (value1 ^ other.value1));
         VECTOR carry2 = (value2 & other.value2) | (carry1 & (value2 ^ other.value2));
@@ -685,13 +825,12 @@ public:
     }
     
     inline __attribute__((always_inline)) const Float7& operator*=(const Float7 &other) {
-        Float7 ret = Float7(value6&other.value, value6&other.value1, value6&other.value2, value6&other.value3, value6&other.value4, value6&other.value5, value6&other.value6);
-        ret.selfAdd(value5&other.value1, value5&other.value2, value5&other.value3, value5&other.value4, value5&other.value5, value5&other.value6);
-        ret.selfAdd(value4&other.value2, value4&other.value3, value4&other.value4, value4&other.value5, value4&other.value6);
-        ret.selfAdd(value3&other.value3, value3&other.value4, value3&other.value5, value3&other.value6);
-        ret.selfAdd(value2&other.value4, value2&other.value5, value2&other.value6);
-        ret.selfAdd(value1&other.value5, value1&other.value6);
-        ret.selfAdd(value&other.value6);
+        Float7 ret = Float7(value6&other.value1, value6&other.value2, value6&other.value3, value6&other.value4, value6&other.value5, value6&other.value6, 0);
+        ret.selfAdd(value5&other.value2, value5&other.value3, value5&other.value4, value5&other.value5, value5&other.value6);
+        ret.selfAdd(value4&other.value3, value4&other.value4, value4&other.value5, value4&other.value6);
+        ret.selfAdd(value3&other.value4, value3&other.value5, value3&other.value6);
+        ret.selfAdd(value2&other.value5, value2&other.value6);
+        ret.selfAdd(value1&other.value6);
         value = ret.value;
         value1 = ret.value1;
         value2 = ret.value2;
@@ -702,15 +841,15 @@ public:
         return *this;
     }
 
-    inline __attribute__((always_inline)) static double sup() {
+    inline __attribute__((always_inline)) static constexpr double sup() {
         return 0.9921875;
     }
     
-    static double eps() {
+    static constexpr double eps() {
         return 0.0078125;
     }
 
-    inline __attribute__((always_inline)) static double inf() {
+    inline __attribute__((always_inline)) static constexpr double inf() {
         return 0;
     }
 
@@ -723,6 +862,9 @@ public:
         return Float7(value&notmask, value1&notmask, value2&notmask, value3&notmask, value4&notmask, value5&notmask, value6&notmask);
     }
 };
+
+static_assert(std::is_trivially_copyable<Float7>::value, "packed types are copied as plain bit-planes");
+
 }
 
 #endif // Float7_H
@@ -22,7 +22,9 @@ limitations under the License.
 #include <bitset>
 #include <cstdlib>
 #include <random>
+#include <type_traits>
 #include "../vecutils.h"
+#include "../arithmetic.h"
 
 namespace tensorless {
 
@@ -36,12 +38,12 @@ private:
     VECTOR value5;
     VECTOR value6;
     VECTOR value7;
-    explicit Float8(VECTOR v, VECTOR v1, VECTOR v2, VECTOR v3, VECTOR v4, VECTOR v5, VECTOR v6, VECTOR v7) : 
+    constexpr explicit Float8(VECTOR v, VECTOR v1, VECTOR v2, VECTOR v3, VECTOR v4, VECTOR v5, VECTOR v6, VECTOR v7) : 
         value(v), value1(v1), value2(v2), value3(v3), value4(v4), value5(v5), value6(v6), value7(v7) {}
 public:
     static inline __attribute__((always_inline)) Float8 random() {return Float8(lrand(), lrand(), lrand(), lrand(), lrand(), lrand(), lrand(), 0);}
     
-    static inline __attribute__((always_inline)) Float8 broadcast(double val) {
+    static inline __attribute__((always_inline)) constexpr Float8 broadcast(double val) {
         if(val<0 || val>2)
             throw std::logic_error("can only set values in range [0,2]");
         VECTOR value7 = 0;
@@ -92,24 +94,7 @@ public:
                 set(i, vec[i]);
     }
     
-    inline __attribute__((always_inline)) Float8(const Float8 &other) : 
-        value(other.value), value1(other.value1), value2(other.value2), value3(other.value3), value4(other.value4), value5(other.value5), value6(other.value6), value7(other.value7) {}
-    
-    inline __attribute__((always_inline)) Float8() : value(0), value1(0), value2(0), value3(0), value4(0), value5(0), value6(0), value7(0) {}
-
-    inline __attribute__((always_inline)) Float8& operator=(const Float8 &other) {
-        if (this != &other) {
-            value = other.value;
-            value1 = other.value1;
-            value2 = other.value2;
-            value3 = other.value3;
-            value4 = other.value4;
-            value5 = other.value5;
-            value6 = other.value6;
-            value7 = other.value7;
-        }
-        return *this;
-    }
+    inline __attribute__((always_inline)) constexpr Float8() : value(0), value1(0), value2(0), value3(0), value4(0), value5(0), value6(0), value7(0) {}
 
     inline __attribute__((always_inline)) Float8 times2() const {
         #ifdef DEBUG_OVERFLOWS
@@ -187,7 +172,22 @@ public:
                                          value7 & notmask);
     }
 
-    inline __attribute__((always_inline)) static int num_params() {
+    inline __attribute__((always_inline)) static Float8 fromPlanes(const VECTOR *planes) {
+        return Float8(planes[0], planes[1], planes[2], planes[3], planes[4], planes[5], planes[6], planes[7]);
+    }
+
+    inline __attribute__((always_inline)) void toPlanes(VECTOR *planes) const {
+        planes[0] = value;
+        planes[1] = value1;
+        planes[2] = value2;
+        planes[3] = value3;
+        planes[4] = value4;
+        planes[5] = value5;
+        planes[6] = value6;
+        planes[7] = value7;
+    }
+
+    inline __attribute__((always_inline)) static constexpr int num_params() {
         return 8;
     }
 
@@ -269,6 +269,84 @@ public:
         return ret/128.0;
     }
 
+    inline __attribute__((always_inline)) VECTOR argmaxMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & value7;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value6;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value5;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value4;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value3;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value2;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) VECTOR argminMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & ~value7;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value6;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value5;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value4;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value3;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value2;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) int argmax(const VECTOR &mask) const {
+        return FIRSTONE(argmaxMask(mask));
+    }
+
+    inline __attribute__((always_inline)) int argmax() const {
+        return FIRSTONE(argmaxMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) int argmin() const {
+        return FIRSTONE(argminMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) double max() const {
+        return get(argmax());
+    }
+
+    inline __attribute__((always_inline)) double min() const {
+        return get(argmin());
+    }
+
     inline __attribute__((always_inline)) const double sum() const {
         int ret = bitcount(value);
         ret += bitcount(value1)*2;
@@ -414,7 +492,77 @@ public:
             (other.value^value) | (other.value1^value1) | (other.value2^value2) | (other.value3^value3) | (other.value4^value4) | (other.value5^value5) | (other.value6^value6) | (other.value7^value7));
     }
 
+    inline __attribute__((always_inline)) void compareWithCarry(const Float8 &other, VECTOR &greater, VECTOR &equal) const {
+        COUNT_PLANES(2*num_params());
+        greater |= equal & value7 & ~other.value7;
+        equal &= ~(value7 ^ other.value7);
+        greater |= equal & value6 & ~other.value6;
+        equal &= ~(value6 ^ other.value6);
+        greater |= equal & value5 & ~other.value5;
+        equal &= ~(value5 ^ other.value5);
+        greater |= equal & value4 & ~other.value4;
+        equal &= ~(value4 ^ other.value4);
+        greater |= equal & value3 & ~other.value3;
+        equal &= ~(value3 ^ other.value3);
+        greater |= equal & value2 & ~other.value2;
+        equal &= ~(value2 ^ other.value2);
+        greater |= equal & value1 & ~other.value1;
+        equal &= ~(value1 ^ other.value1);
+        greater |= equal & value & ~other.value;
+        equal &= ~(value ^ other.value);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>(const Float8 &other) const {
+        VECTOR greater = 0;
+        VECTOR equal = ~(VECTOR)0;
+        compareWithCarry(other, greater, equal);
+        return greater;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<(const Float8 &other) const {
+        return other > *this;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>=(const Float8 &other) const {
+        return ~(other > *this);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<=(const Float8 &other) const {
+        return ~(*this > other);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator==(const Float8 &other) const {
+        return ~((other.value^value) | (other.value1^value1) | (other.value2^value2) | (other.value3^value3) | (other.value4^value4) | (other.value5^value5) | (other.value6^value6) | (other.value7^value7));
+    }
+
+    inline __attribute__((always_inline)) Float8 operator/(const Float8 &other) const {
+        return planeDivide(*this, other);
+    }
+
+    inline __attribute__((always_inline)) Float8 reciprocal() const {
+        return planeDivide(broadcast(1), *this);
+    }
+
+    inline __attribute__((always_inline)) Float8 sqrt() const {
+        return planeSqrt(*this);
+    }
+
+    inline __attribute__((always_inline)) Float8 merge(const Float8 &other, const VECTOR &mask) const {
+        COUNT_PLANES(2*num_params());
+        VECTOR notmask = ~mask;
+        return Float8((value&mask) | (other.value & notmask), 
+                      (value1&mask) | (other.value1 & notmask),
+                      (value2&mask) | (other.value2 & notmask),
+                      (value3&mask) | (other.value3 & notmask),
+                      (value4&mask) | (other.value4 & notmask),
+                      (value5&mask) | (other.value5 & notmask),
+                      (value6&mask) | (other.value6 & notmask),
+                      (value7&mask) | (other.value7 & notmask)
+                      );
+    }
+
     inline __attribute__((always_inline)) Float8 operator*(const Float8 &other) const {
+        COUNT_PLANES(2*num_params());
         Float8 ret = Float8(value7&other.value, value7&other.value1, value7&other.value2, value7&other.value3, value7&other.value4, value7&other.value5, value7&other.value6, value7&other.value7);
         ret += Float8(value6&other.value1, value6&other.value2, value6&other.value3, value6&other.value4, value6&other.value5, value6&other.value6, value6&other.value7, 0);
         ret += Float8(value5&other.value2, value5&other.value3, value5&other.value4, value5&other.value5, value5&other.value6, value5&other.value7, 0, 0);
@@ -467,6 +615,7 @@ public:
     }
 
     inline __attribute__((always_inline)) Float8 twosComplement(const VECTOR &mask) const {
+        COUNT_PLANES(num_params());
         VECTOR notmask = ~mask;
         return Float8((mask&~value) | (notmask&value), 
                       (mask&~value1) | (notmask&value1),
@@ -503,6 +652,7 @@ public:
     }
 
     inline __attribute__((always_inline)) Float8 operator+(const Float8 &other) const {
+        COUNT_PLANES(2*num_params());
         VECTOR carry = other.value&value;
         VECTOR carry1 = (value1 & other.value1) | (carry & (value1 ^ other.value1));
         VECTOR carry2 = (value2 & other.value2) | (carry1 & (value2 ^ other.value2));
@@ -573,15 +723,15 @@ public:
         return *this;
     }
 
-    inline __attribute__((always_inline)) static double sup() {
+    inline __attribute__((always_inline)) static constexpr double sup() {
         return 1.9921875;
     }
     
-    static double eps() {
+    static constexpr double eps() {
         return 0.0078125;
     }
 
-    inline __attribute__((always_inline)) static double inf() {
+    inline __attribute__((always_inline)) static constexpr double inf() {
         return 0;
     }
 
@@ -594,6 +744,9 @@ public:
         return Float8(value&notmask, value1&notmask, value2&notmask, value3&notmask, value4&notmask, value5&notmask, value6&notmask, value7&notmask);
     }
 };
+
+static_assert(std::is_trivially_copyable<Float8>::value, "packed types are copied as plain bit-planes");
+
 }
 
 #endif // Float8_H
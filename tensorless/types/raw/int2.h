@@ -22,7 +22,9 @@ limitations under the License.
 #include <bitset>
 #include <cstdlib>
 #include <random>
+#include <type_traits>
 #include "../vecutils.h"
+#include "../arithmetic.h"
 
 
 namespace tensorless {
@@ -30,10 +32,10 @@ class Int2 {
 private:
     VECTOR value;
     VECTOR value1;
-    explicit Int2(VECTOR v, VECTOR v1) : value(v), value1(v1) {}
+    constexpr explicit Int2(VECTOR v, VECTOR v1) : value(v), value1(v1) {}
 public:
     static Int2 random() {return Int2(lrand(), 0);}
-    static Int2 broadcast(double value) {
+    static constexpr Int2 broadcast(double value) {
         int val = (int)value;
         return Int2(val&1?~(VECTOR)0:0, val&2?~(VECTOR)0:0);
     }
@@ -42,7 +44,16 @@ public:
         return Int2(mask, 0);
     }
 
-    static int num_params() {
+    inline __attribute__((always_inline)) static Int2 fromPlanes(const VECTOR *planes) {
+        return Int2(planes[0], planes[1]);
+    }
+
+    inline __attribute__((always_inline)) void toPlanes(VECTOR *planes) const {
+        planes[0] = value;
+        planes[1] = value1;
+    }
+
+    static constexpr int num_params() {
         return 2;
     }
 
@@ -56,22 +67,12 @@ public:
                 set(i, vec[i]);
     }
     
-    Int2(const Int2 &other) : value(other.value), value1(other.value1) {}
-    
-    Int2() : value(0), value1(0) {}
+    constexpr Int2() : value(0), value1(0) {}
 
     const int size() const {
         return sizeof(VECTOR)*8;
     }
 
-    Int2& operator=(const Int2 &other) {
-        if (this != &other) {
-            value = other.value;
-            value1 = other.value1;
-        }
-        return *this;
-    }
-
     explicit operator bool() const {
         return ANY(value) || ANY(value1);
     }
@@ -94,11 +95,11 @@ public:
         return GETAT(a, i);
     }
 
-    const int sum() {
+    const int sum() const {
         return bitcount(value) + bitcount(value1)*2;
     }
 
-    const int sum(VECTOR mask) {
+    const int sum(VECTOR mask) const {
         return bitcount(value&mask) + bitcount(value1&mask)*2;
     }
     
@@ -168,7 +169,51 @@ public:
         return Int2((other.value^value) | (other.value1^value1), 0);
     }
 
+    inline __attribute__((always_inline)) void compareWithCarry(const Int2 &other, VECTOR &greater, VECTOR &equal) const {
+        COUNT_PLANES(2*num_params());
+        greater |= equal & value1 & ~other.value1;
+        equal &= ~(value1 ^ other.value1);
+        greater |= equal & value & ~other.value;
+        equal &= ~(value ^ other.value);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>(const Int2 &other) const {
+        VECTOR greater = 0;
+        VECTOR equal = ~(VECTOR)0;
+        compareWithCarry(other, greater, equal);
+        return greater;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<(const Int2 &other) const {
+        return other > *this;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>=(const Int2 &other) const {
+        return ~(other > *this);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<=(const Int2 &other) const {
+        return ~(*this > other);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator==(const Int2 &other) const {
+        return ~((other.value^value) | (other.value1^value1));
+    }
+
+    inline __attribute__((always_inline)) Int2 operator/(const Int2 &other) const {
+        return planeDivide(*this, other);
+    }
+
+    inline __attribute__((always_inline)) Int2 reciprocal() const {
+        return planeDivide(broadcast(1), *this);
+    }
+
+    inline __attribute__((always_inline)) Int2 sqrt() const {
+        return planeSqrt(*this);
+    }
+
     inline __attribute__((always_inline)) Int2 operator*(const Int2 &other) const {
+        COUNT_PLANES(2*num_params());
         return Int2(other.value&value, (other.value1&value) | (other.value&value1));
     }
 
@@ -180,6 +225,7 @@ public:
     }
  
     inline __attribute__((always_inline)) Int2 twosComplement(const VECTOR &mask) const {
+        COUNT_PLANES(num_params());
         VECTOR notmask = ~mask;
         return Int2(mask&~value | (notmask&value), 
                       mask&~value1 | (notmask&value1)
@@ -210,20 +256,15 @@ public:
     }
 
     inline __attribute__((always_inline)) Int2 maximum(const Int2 &other) const {
-        VECTOR vSelector = value1 & ~other.value1;
-        VECTOR v1 = value1 | other.value1;
-        VECTOR v = (vSelector&value) | (other.value & ~vSelector);
-        return Int2(v, v1);
+        return merge(other, *this > other);
     }
 
     inline __attribute__((always_inline)) Int2 minimum(const Int2 &other) const {
-        VECTOR vSelector = ~value1 & other.value1;
-        VECTOR v1 = value1 & other.value1;
-        VECTOR v = (vSelector&value) | (other.value & ~vSelector);
-        return Int2(v, v1);
+        return merge(other, *this < other);
     }
 
     inline __attribute__((always_inline)) Int2 merge(const Int2 &other, const VECTOR &mask) const {
+        COUNT_PLANES(2*num_params());
         VECTOR notmask = ~mask;
         return Int2((value&mask) | (other.value & notmask), 
                     (value1&mask) | (other.value1 & notmask)
@@ -231,6 +272,7 @@ public:
     }
 
     inline __attribute__((always_inline)) Int2 operator+(const Int2 &other) const {
+        COUNT_PLANES(2*num_params());
         VECTOR carry = other.value&value;
         return Int2(other.value^value, 
                     other.value1^value1^carry
@@ -251,15 +293,15 @@ public:
         return *this;
     }
 
-    inline __attribute__((always_inline)) static int sup() {
+    inline __attribute__((always_inline)) static constexpr int sup() {
         return 3;
     }
     
-    inline __attribute__((always_inline)) static int eps() {
+    inline __attribute__((always_inline)) static constexpr int eps() {
         return 1;
     }
 
-    inline __attribute__((always_inline)) static int inf() {
+    inline __attribute__((always_inline)) static constexpr int inf() {
         return 0;
     }
 
@@ -294,8 +336,52 @@ public:
             ret += 1;
         return ret;
     }
+
+    inline __attribute__((always_inline)) VECTOR argmaxMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) VECTOR argminMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & ~value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) int argmax(const VECTOR &mask) const {
+        return FIRSTONE(argmaxMask(mask));
+    }
+
+    inline __attribute__((always_inline)) int argmax() const {
+        return FIRSTONE(argmaxMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) int argmin() const {
+        return FIRSTONE(argminMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) int max() const {
+        return get(argmax());
+    }
+
+    inline __attribute__((always_inline)) int min() const {
+        return get(argmin());
+    }
 };
 
+static_assert(std::is_trivially_copyable<Int2>::value, "packed types are copied as plain bit-planes");
+
 
 }
 
@@ -22,7 +22,9 @@ limitations under the License.
 #include <bitset>
 #include <cstdlib>
 #include <random>
+#include <type_traits>
 #include "../vecutils.h"
+#include "../arithmetic.h"
 
 namespace tensorless {
 
@@ -31,7 +33,7 @@ private:
     VECTOR value;
     VECTOR value1;
     VECTOR value2;
-    explicit Int3(VECTOR v, VECTOR v1, VECTOR v2) : value(v), value1(v1), value2(v2) {}
+    constexpr explicit Int3(VECTOR v, VECTOR v1, VECTOR v2) : value(v), value1(v1), value2(v2) {}
 
 public:
     static Int3 random() {
@@ -42,7 +44,7 @@ public:
         return Int3(mask, 0, 0);
     }
 
-    static Int3 broadcast(int val) {
+    static constexpr Int3 broadcast(int val) {
         if (val < 0 || val > 7) {
             throw std::logic_error("can only set values in range [0,7], given " + std::to_string(val));
         }
@@ -61,7 +63,17 @@ public:
         return Int3(value, value1, value2);
     }
 
-    static int num_params() {
+    inline __attribute__((always_inline)) static Int3 fromPlanes(const VECTOR *planes) {
+        return Int3(planes[0], planes[1], planes[2]);
+    }
+
+    inline __attribute__((always_inline)) void toPlanes(VECTOR *planes) const {
+        planes[0] = value;
+        planes[1] = value1;
+        planes[2] = value2;
+    }
+
+    static constexpr int num_params() {
         return 3;
     }
     
@@ -77,9 +89,7 @@ public:
         }
     }
     
-    Int3(const Int3 &other) : value(other.value), value1(other.value1), value2(other.value2) {}
-    
-    Int3() : value(0), value1(0), value2(0) {}
+    constexpr Int3() : value(0), value1(0), value2(0) {}
 
     Int3 zerolike() const {
         return Int3();
@@ -94,15 +104,6 @@ public:
         return sizeof(VECTOR) * 8;
     }
 
-    Int3& operator=(const Int3 &other) {
-        if (this != &other) {
-            value = other.value;
-            value1 = other.value1;
-            value2 = other.value2;
-        }
-        return *this;
-    }
-
     explicit operator bool() const {
         return ANY(value) || ANY(value1) || ANY(value2);
     }
@@ -145,12 +146,12 @@ public:
 
     template <typename RetNumber>
     inline __attribute__((always_inline)) RetNumber applyHalf(const RetNumber &number) const {
-        return number.eighth(value2).quarter(value1).half(value);
+        return number.eighth(value2).half(value2).quarter(value1).half(value);
     }
 
     template <typename RetNumber>
     inline __attribute__((always_inline)) RetNumber applyHalf(const RetNumber &number, const VECTOR &mask) const {
-        return number.eighth(value2 & mask).quarter(value1 & mask).half(value & mask);
+        return number.eighth(value2 & mask).half(value2 & mask).quarter(value1 & mask).half(value & mask);
     }
     
     template <typename RetNumber>
@@ -218,13 +219,60 @@ public:
         return Int3((other.value ^ value), (other.value1 ^ value1), (other.value2 ^ value2));
     }
 
+    inline __attribute__((always_inline)) void compareWithCarry(const Int3 &other, VECTOR &greater, VECTOR &equal) const {
+        COUNT_PLANES(2*num_params());
+        greater |= equal & value2 & ~other.value2;
+        equal &= ~(value2 ^ other.value2);
+        greater |= equal & value1 & ~other.value1;
+        equal &= ~(value1 ^ other.value1);
+        greater |= equal & value & ~other.value;
+        equal &= ~(value ^ other.value);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>(const Int3 &other) const {
+        VECTOR greater = 0;
+        VECTOR equal = ~(VECTOR)0;
+        compareWithCarry(other, greater, equal);
+        return greater;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<(const Int3 &other) const {
+        return other > *this;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>=(const Int3 &other) const {
+        return ~(other > *this);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<=(const Int3 &other) const {
+        return ~(*this > other);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator==(const Int3 &other) const {
+        return ~((other.value^value) | (other.value1^value1) | (other.value2^value2));
+    }
+
+    inline __attribute__((always_inline)) Int3 operator/(const Int3 &other) const {
+        return planeDivide(*this, other);
+    }
+
+    inline __attribute__((always_inline)) Int3 reciprocal() const {
+        return planeDivide(broadcast(1), *this);
+    }
+
+    inline __attribute__((always_inline)) Int3 sqrt() const {
+        return planeSqrt(*this);
+    }
+
     inline __attribute__((always_inline)) Int3 operator*(const Int3 &other) const {
+        COUNT_PLANES(2*num_params());
         return Int3(other.value & value, 
                     (other.value1 & value) | (other.value & value1),
                     (other.value2 & value) | (other.value & value2) | (other.value1 & value1));
     }
  
     inline __attribute__((always_inline)) Int3 twosComplement(const VECTOR &mask) const {
+        COUNT_PLANES(num_params());
         VECTOR notmask = ~mask;
         return Int3(mask & ~value | (notmask & value), 
                     mask & ~value1 | (notmask & value1),
@@ -266,6 +314,7 @@ public:
     }
 
     inline __attribute__((always_inline)) Int3 operator+(const Int3 &other) const {
+        COUNT_PLANES(2*num_params());
         VECTOR carry = value & other.value;
         VECTOR carry1 = (value1 & other.value1) | (carry & (value1 ^ other.value1));
         return Int3(value ^ other.value, 
@@ -290,6 +339,7 @@ public:
     }
     
     inline __attribute__((always_inline)) Int3 merge(const Int3 &other, const VECTOR &mask) const {
+        COUNT_PLANES(2*num_params());
         VECTOR notmask = ~mask;
         return Int3((value&mask) | (other.value & notmask), 
                     (value1&mask) | (other.value1 & notmask),
@@ -297,15 +347,15 @@ public:
                     );
     }
 
-    inline __attribute__((always_inline)) static int sup() {
+    inline __attribute__((always_inline)) static constexpr int sup() {
         return 7;
     }
 
-    inline __attribute__((always_inline)) static int eps() {
+    inline __attribute__((always_inline)) static constexpr int eps() {
         return 1;
     }
 
-    inline __attribute__((always_inline)) static int inf() {
+    inline __attribute__((always_inline)) static constexpr int inf() {
         return 0;
     }
 
@@ -327,8 +377,58 @@ public:
         }
         return ret;
     }
+
+    inline __attribute__((always_inline)) VECTOR argmaxMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & value2;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) VECTOR argminMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & ~value2;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) int argmax(const VECTOR &mask) const {
+        return FIRSTONE(argmaxMask(mask));
+    }
+
+    inline __attribute__((always_inline)) int argmax() const {
+        return FIRSTONE(argmaxMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) int argmin() const {
+        return FIRSTONE(argminMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) int max() const {
+        return get(argmax());
+    }
+
+    inline __attribute__((always_inline)) int min() const {
+        return get(argmin());
+    }
 };
 
+static_assert(std::is_trivially_copyable<Int3>::value, "packed types are copied as plain bit-planes");
+
 } // namespace tensorless
 
 #endif // INT3_H
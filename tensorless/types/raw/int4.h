@@ -22,7 +22,9 @@ limitations under the License.
 #include <bitset>
 #include <cstdlib>
 #include <random>
+#include <type_traits>
 #include "../vecutils.h"
+#include "../arithmetic.h"
 
 
 namespace tensorless {
@@ -32,16 +34,16 @@ private:
     VECTOR value1;
     VECTOR value2;
     VECTOR value3;
-    explicit Int4(VECTOR v, VECTOR v1, VECTOR v2, VECTOR v3) : value(v), value1(v1), value2(v2), value3(v3) {}
+    constexpr explicit Int4(VECTOR v, VECTOR v1, VECTOR v2, VECTOR v3) : value(v), value1(v1), value2(v2), value3(v3) {}
 public:
     static Int4 random() {return Int4(lrand(), lrand(), lrand(), lrand());}
-    static Int4 broadcast(int val) {
+    static constexpr Int4 broadcast(int val) {
         if(val<0 || val>15)
             throw std::logic_error("can only set values in range [0,15], given "+std::to_string(val));
-        VECTOR value;
-        VECTOR value1;
-        VECTOR value2;
-        VECTOR value3;
+        VECTOR value = 0;
+        VECTOR value1 = 0;
+        VECTOR value2 = 0;
+        VECTOR value3 = 0;
         if(val>=8) {
             value3 = ~value3;
             val -= 8;
@@ -59,7 +61,18 @@ public:
         return Int4(value, value1, value2, value3);
     }
 
-    static int num_params() {
+    inline __attribute__((always_inline)) static Int4 fromPlanes(const VECTOR *planes) {
+        return Int4(planes[0], planes[1], planes[2], planes[3]);
+    }
+
+    inline __attribute__((always_inline)) void toPlanes(VECTOR *planes) const {
+        planes[0] = value;
+        planes[1] = value1;
+        planes[2] = value2;
+        planes[3] = value3;
+    }
+
+    static constexpr int num_params() {
         return 4;
     }
     
@@ -73,9 +86,7 @@ public:
                 set(i, vec[i]);
     }
     
-    Int4(const Int4 &other) : value(other.value), value1(other.value1), value2(other.value2), value3(other.value3) {}
-    
-    Int4() : value(0), value1(0), value2(0), value3(0) {}
+    constexpr Int4() : value(0), value1(0), value2(0), value3(0) {}
 
     Int4 zerolike() const {
         return Int4();
@@ -90,16 +101,6 @@ public:
         return sizeof(VECTOR)*8;
     }
 
-    Int4& operator=(const Int4 &other) {
-        if (this != &other) {
-            value = other.value;
-            value1 = other.value1;
-            value2 = other.value2;
-            value3 = other.value3;
-        }
-        return *this;
-    }
-
     explicit operator bool() const {
         return ANY(value) || ANY(value1) || ANY(value2) || ANY(value3);
     }
@@ -122,12 +123,12 @@ public:
         return GETAT(a, i);
     }
 
-    const int sum() {
-        return bitcount(value) + bitcount(value1)<<1 + bitcount(value2)<<2 + bitcount(value3)<<3;
+    const int sum() const {
+        return bitcount(value) + bitcount(value1)*2 + bitcount(value2)*4 + bitcount(value3)*8;
     }
 
-    const int sum(VECTOR mask) {
-        return bitcount(value&mask) + bitcount(value1&mask)<<1 + bitcount(value2&mask)<<2 + bitcount(value3&mask)<<3;
+    const int sum(VECTOR mask) const {
+        return bitcount(value&mask) + bitcount(value1&mask)*2 + bitcount(value2&mask)*4 + bitcount(value3&mask)*8;
     }
     
     const int get(int i) const {
@@ -147,11 +148,11 @@ public:
     }
 
     template <typename RetNumber> inline __attribute__((always_inline)) RetNumber applyHalf(const RetNumber &number) const {
-        return number.half(value3).eighth(value3).eighth(value2).quarter(value1).half(value);
+        return number.eighth(value3).eighth(value3).quarter(value3).eighth(value2).half(value2).quarter(value1).half(value);
     }
 
     template <typename RetNumber> inline __attribute__((always_inline)) RetNumber applyHalf(const RetNumber &number, const VECTOR &mask) const {
-        return number.half(value3&mask).eighth(value3&mask).eighth(value2&mask).quarter(value1&mask).half(value&mask);
+        return number.eighth(value3&mask).eighth(value3&mask).quarter(value3&mask).eighth(value2&mask).half(value2&mask).quarter(value1&mask).half(value&mask);
     }
     
     template <typename RetNumber> inline __attribute__((always_inline)) RetNumber applyTimes2(const RetNumber &number) const {
@@ -232,8 +233,65 @@ public:
     inline __attribute__((always_inline)) Int4 operator!=(const Int4 &other) const {
         return Int4((other.value^value) | (other.value1^value1) | (other.value2^value2) | (other.value3^value3), 0, 0, 0);
     }
+
+    inline __attribute__((always_inline)) void compareWithCarry(const Int4 &other, VECTOR &greater, VECTOR &equal) const {
+        COUNT_PLANES(2*num_params());
+        greater |= equal & value3 & ~other.value3;
+        equal &= ~(value3 ^ other.value3);
+        greater |= equal & value2 & ~other.value2;
+        equal &= ~(value2 ^ other.value2);
+        greater |= equal & value1 & ~other.value1;
+        equal &= ~(value1 ^ other.value1);
+        greater |= equal & value & ~other.value;
+        equal &= ~(value ^ other.value);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>(const Int4 &other) const {
+        VECTOR greater = 0;
+        VECTOR equal = ~(VECTOR)0;
+        compareWithCarry(other, greater, equal);
+        return greater;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<(const Int4 &other) const {
+        return other > *this;
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator>=(const Int4 &other) const {
+        return ~(other > *this);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator<=(const Int4 &other) const {
+        return ~(*this > other);
+    }
+
+    inline __attribute__((always_inline)) VECTOR operator==(const Int4 &other) const {
+        return ~((other.value^value) | (other.value1^value1) | (other.value2^value2) | (other.value3^value3));
+    }
+
+    inline __attribute__((always_inline)) Int4 operator/(const Int4 &other) const {
+        return planeDivide(*this, other);
+    }
+
+    inline __attribute__((always_inline)) Int4 reciprocal() const {
+        return planeDivide(broadcast(1), *this);
+    }
+
+    inline __attribute__((always_inline)) Int4 sqrt() const {
+        return planeSqrt(*this);
+    }
+
+    // keeps the lowest four bits of the product
+    inline __attribute__((always_inline)) Int4 operator*(const Int4 &other) const {
+        COUNT_PLANES(2*num_params());
+        return Int4(value&other.value, value1&other.value, value2&other.value, value3&other.value)
+             + Int4(0, value&other.value1, value1&other.value1, value2&other.value1)
+             + Int4(0, 0, value&other.value2, value1&other.value2)
+             + Int4(0, 0, 0, value&other.value3);
+    }
  
     inline __attribute__((always_inline)) Int4 twosComplement(const VECTOR &mask) const {
+        COUNT_PLANES(num_params());
         VECTOR notmask = ~mask;
         return Int4(mask&~value | (notmask&value), 
                       mask&~value1 | (notmask&value1),
@@ -283,6 +341,7 @@ public:
     }
 
     inline __attribute__((always_inline)) Int4 operator+(const Int4 &other) const {
+        COUNT_PLANES(2*num_params());
         VECTOR carry = other.value&value;
         VECTOR carry1 = (value1 & other.value1) | (carry & (value1 ^ other.value1));
         VECTOR carry2 = (value2 & other.value2) | (carry1 & (value2 ^ other.value2));
@@ -348,19 +407,20 @@ public:
         return *this;
     }
 
-    inline __attribute__((always_inline)) static int sup() {
+    inline __attribute__((always_inline)) static constexpr int sup() {
         return 15;
     }
 
-    inline __attribute__((always_inline)) static int eps() {
+    inline __attribute__((always_inline)) static constexpr int eps() {
         return 1;
     }
 
-    inline __attribute__((always_inline)) static int inf() {
+    inline __attribute__((always_inline)) static constexpr int inf() {
         return 0;
     }
     
     inline __attribute__((always_inline)) Int4 merge(const Int4 &other, const VECTOR &mask) const {
+        COUNT_PLANES(2*num_params());
         VECTOR notmask = ~mask;
         return Int4((value&mask) | (other.value & notmask), 
                     (value1&mask) | (other.value1 & notmask),
@@ -393,8 +453,64 @@ public:
             ret += 1;
         return ret;
     }
+
+    inline __attribute__((always_inline)) VECTOR argmaxMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & value3;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value2;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) VECTOR argminMask(VECTOR mask) const {
+        VECTOR candidates;
+        candidates = mask & ~value3;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value2;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value1;
+        if(ANY(candidates))
+            mask = candidates;
+        candidates = mask & ~value;
+        if(ANY(candidates))
+            mask = candidates;
+        return mask;
+    }
+
+    inline __attribute__((always_inline)) int argmax(const VECTOR &mask) const {
+        return FIRSTONE(argmaxMask(mask));
+    }
+
+    inline __attribute__((always_inline)) int argmax() const {
+        return FIRSTONE(argmaxMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) int argmin() const {
+        return FIRSTONE(argminMask(~(VECTOR)0));
+    }
+
+    inline __attribute__((always_inline)) int max() const {
+        return get(argmax());
+    }
+
+    inline __attribute__((always_inline)) int min() const {
+        return get(argmin());
+    }
 };
 
+static_assert(std::is_trivially_copyable<Int4>::value, "packed types are copied as plain bit-planes");
+
 
 }
 
@@ -0,0 +1,115 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUCTIONS_H
+#define REDUCTIONS_H
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+#include "vecutils.h"
+#include "threadpool.h"
+#include <omp.h>
+
+namespace tensorless {
+
+#define REDUCTIONS_PARALLEL_BLOCKS 64
+
+// multi-block reductions treat consecutive blocks as one long vector, so that the
+// returned positions are block*size()+lane
+
+// Per-block reductions of at least REDUCTIONS_PARALLEL_BLOCKS blocks are split among the threads of
+// ThreadPool::global() (see ThreadPool::shouldSplit). Blocks are then combined in order, so positions and ties do
+// not depend on threads.
+inline bool parallelBlocks(std::size_t count) {
+    return ThreadPool::shouldSplit(count, REDUCTIONS_PARALLEL_BLOCKS);
+}
+
+// positions of the k largest lanes of one block, largest first, from argmax over the lanes not yet taken; every
+// type provides argmax(mask) from its own packed comparisons
+template <typename Number>
+inline std::vector<int> topk(const Number &block, int k) {
+    std::vector<int> ret;
+    VECTOR mask = ~(VECTOR)0;
+    for(int i=0;i<k && i<block.size();++i) {
+        int pos = block.argmax(mask);
+        ret.push_back(pos);
+        mask &= ~ONEHOT(pos);
+    }
+    return ret;
+}
+
+template <typename Number>
+inline long argmax(const std::vector<Number> &blocks) {
+    if(blocks.empty())
+        throw std::logic_error("argmax of no blocks");
+    std::vector<int> positions;
+    if(parallelBlocks(blocks.size())) {
+        positions.resize(blocks.size());
+        ThreadPool::global().parallelFor(0, blocks.size(), [&](int begin, int end) {
+            for(int block=begin;block<end;++block)
+                positions[block] = blocks[block].argmax();
+        }, REDUCTIONS_PARALLEL_BLOCKS);
+    }
+    long ret = 0;
+    double best = 0;
+    for(std::size_t block=0;block<blocks.size();++block) {
+        int pos = positions.empty() ? blocks[block].argmax() : positions[block];
+        double val = blocks[block].get(pos);
+        if(block==0 || val>best) {
+            best = val;
+            ret = (long)block*blocks[block].size()+pos;
+        }
+    }
+    return ret;
+}
+
+template <typename Number>
+inline double max(const std::vector<Number> &blocks) {
+    long pos = argmax(blocks);
+    int size = blocks[0].size();
+    return blocks[pos/size].get(pos%size);
+}
+
+template <typename Number>
+inline std::vector<long> topk(const std::vector<Number> &blocks, int k) {
+    // the global top-k is contained in the union of per-block top-k
+    std::vector<std::vector<int>> positions;
+    if(parallelBlocks(blocks.size())) {
+        positions.resize(blocks.size());
+        ThreadPool::global().parallelFor(0, blocks.size(), [&](int begin, int end) {
+            for(int block=begin;block<end;++block)
+                positions[block] = topk(blocks[block], k);
+        }, REDUCTIONS_PARALLEL_BLOCKS);
+    }
+    std::vector<std::pair<double, long>> candidates;
+    for(std::size_t block=0;block<blocks.size();++block) {
+        long offset = (long)block*blocks[block].size();
+        for(int pos : positions.empty() ? topk(blocks[block], k) : positions[block])
+            candidates.push_back(std::make_pair(-blocks[block].get(pos), offset+pos));
+    }
+    if(k>(int)candidates.size())
+        k = candidates.size();
+    std::partial_sort(candidates.begin(), candidates.begin()+k, candidates.end());
+    std::vector<long> ret;
+    for(int i=0;i<k;++i)
+        ret.push_back(candidates[i].second);
+    return ret;
+}
+
+}
+#endif  // REDUCTIONS_H
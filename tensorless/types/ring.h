@@ -0,0 +1,139 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef RING_H
+#define RING_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace tensorless {
+
+// Bounded single-producer single-consumer queue of reusable slots. The producer fills claim() in place and
+// publishes it, the consumer reads front() in place and releases it; both sides only exchange two atomic
+// positions, which sit on separate cache lines. The waiting variants spin for a while and then park until the
+// other side makes progress or stop is set.
+template <typename T>
+class SpscRing {
+private:
+    std::vector<T> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head; // next slot to consume
+    alignas(64) std::atomic<size_t> tail; // next slot to produce
+    alignas(64) std::atomic<int> sleepers;
+    std::mutex mutex;
+    std::condition_variable changed;
+    int spins;
+
+    static void pause() {
+        #if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+        #else
+        std::this_thread::yield();
+        #endif
+    }
+
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(sleepers.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            changed.notify_all();
+        }
+    }
+
+    template <typename Get>
+    T* wait(const Get &get, const std::atomic<bool> &stop) {
+        for(int spin=0;spin<spins;++spin) {
+            if(T* slot = get())
+                return slot;
+            if(stop.load(std::memory_order_relaxed))
+                return nullptr;
+            pause();
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        sleepers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        T* slot = nullptr;
+        changed.wait(lock, [&]() {return (slot = get()) || stop.load();});
+        sleepers.fetch_sub(1);
+        return slot;
+    }
+
+public:
+    // capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity, int spins=2000) : head(0), tail(0), sleepers(0), spins(spins) {
+        size_t size = 1;
+        while(size<capacity)
+            size *= 2;
+        slots.resize(size);
+        mask = size-1;
+    }
+
+    size_t capacity() const {
+        return slots.size();
+    }
+
+    // producer side: the slot to fill, or nullptr if the ring is full
+    T* claim() {
+        size_t position = tail.load(std::memory_order_relaxed);
+        if(position-head.load(std::memory_order_acquire)==slots.size())
+            return nullptr;
+        return &slots[position & mask];
+    }
+
+    void publish() {
+        tail.store(tail.load(std::memory_order_relaxed)+1, std::memory_order_release);
+        notify();
+    }
+
+    // consumer side: the oldest published slot, or nullptr if the ring is empty
+    T* front() {
+        size_t position = head.load(std::memory_order_relaxed);
+        if(position==tail.load(std::memory_order_acquire))
+            return nullptr;
+        return &slots[position & mask];
+    }
+
+    void release() {
+        head.store(head.load(std::memory_order_relaxed)+1, std::memory_order_release);
+        notify();
+    }
+
+    // blocking variants, which return nullptr once stop is set
+    T* claimWait(const std::atomic<bool> &stop) {
+        return wait([this]() {return claim();}, stop);
+    }
+
+    T* frontWait(const std::atomic<bool> &stop) {
+        return wait([this]() {return front();}, stop);
+    }
+
+    // wakes parked waiters so that they notice a stop flag
+    void wake() {
+        std::lock_guard<std::mutex> lock(mutex);
+        changed.notify_all();
+    }
+};
+
+}
+#endif  // RING_H
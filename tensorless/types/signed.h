@@ -22,7 +22,9 @@ limitations under the License.
 #include <bitset>
 #include <cstdlib>
 #include <random>
+#include <algorithm>
 #include "vecutils.h"
+#include "arithmetic.h"
 
 namespace tensorless {
 
@@ -31,16 +33,24 @@ class Signed {
 private:
     VECTOR isNegative;
     Number value;
-    Signed(const Number &value, const VECTOR &isNeg) : value(value), isNegative(isNeg) {}
+    constexpr Signed(const Number &value, const VECTOR &isNeg) : value(value), isNegative(isNeg) {}
+    // arithmetic right shifts of two's complement lanes need ones shifted into the top planes
+    inline static Number signFill(const Number &number, const VECTOR &mask, int count) {
+        VECTOR planes[MAX_ARITHMETIC_PLANES];
+        number.toPlanes(planes);
+        for(int j=std::max(0, Number::num_params()-count);j<Number::num_params();++j)
+            planes[j] |= mask;
+        return Number::fromPlanes(planes);
+    }
 public:
     inline static Signed<Number> random() {
         VECTOR isNegative = lrand();
         return Signed(Number::random(), 0).twosComplement(isNegative);
     }
 
-    inline static Signed<Number> broadcast(double value) {
+    inline static constexpr Signed<Number> broadcast(double value) {
         if(value<0)
-            return Signed(Number::broadcast(-value), 0).twosComplement();
+            return Signed(Number::broadcast(Number::sup()+Number::eps()+value), ~(VECTOR)0);
         return Signed(Number::broadcast(value), 0);
     }
 
@@ -48,7 +58,16 @@ public:
         return Signed(Number::broadcastOnes(mask), 0);
     }
 
-    inline static int num_params() {
+    inline static Signed<Number> fromPlanes(const VECTOR *planes) {
+        return Signed(Number::fromPlanes(planes), planes[Number::num_params()]);
+    }
+
+    inline void toPlanes(VECTOR *planes) const {
+        value.toPlanes(planes);
+        planes[Number::num_params()] = isNegative;
+    }
+
+    inline static constexpr int num_params() {
         return 1+Number::num_params();
     }
 
@@ -56,50 +75,73 @@ public:
         return Number::num_bits() + VECTOR_SIZE;
     }
 
+    // a plane shift of the two's complement, so that lanes that overflow wrap like additions do
     inline Signed<Number> times2() const {
-        Number abs = value.twosComplement(isNegative);
-        return Signed(abs.times2().twosComplement(isNegative), isNegative);
+        return times2(~(VECTOR)0);
     }
 
     inline Signed<Number> half() const {
-        //Number abs = value.twosComplement(isNegative);
-        //return Signed(abs.half().twosComplement(isNegative), isNegative);
-        return Signed(value.half(), isNegative);
+        return half(~(VECTOR)0);
     }
 
     inline Signed<Number> quarter() const {
-        //Number abs = value.twosComplement(isNegative);
-        //return Signed(abs.quarter().twosComplement(isNegative), isNegative);
-        return Signed(value.quarter(), isNegative);
+        return quarter(~(VECTOR)0);
     }
 
     inline Signed<Number> eighth() const {
-        //Number abs = value.twosComplement(isNegative);
-        //return Signed(abs.eighth().twosComplement(isNegative), isNegative);
-        return Signed(value.eighth(), isNegative);
+        return eighth(~(VECTOR)0);
     }
 
     inline Signed<Number> times2(const VECTOR &mask) const {
-        Number abs = value.twosComplement(isNegative);
-        return Signed(abs.times2(mask).twosComplement(isNegative), isNegative);
+        VECTOR planes[MAX_ARITHMETIC_PLANES];
+        toPlanes(planes);
+        #ifdef DEBUG_OVERFLOWS
+            if(ANY((planes[Number::num_params()-1]^isNegative) & mask))
+                throw std::logic_error("arithmetic overflow");
+        #endif
+        for(int j=Number::num_params();j>0;--j)
+            planes[j] = (planes[j-1] & mask) | (planes[j] & ~mask);
+        planes[0] &= ~mask;
+        return fromPlanes(planes);
     }
 
     inline Signed<Number> half(const VECTOR &mask) const {
-        //Number abs = value.twosComplement(isNegative);
-        //return Signed(abs.half(mask).twosComplement(isNegative), isNegative);
-        return Signed(value.half(mask), isNegative);
+        return Signed(signFill(value.half(mask), mask & isNegative, 1), isNegative);
     }
 
     inline Signed<Number> quarter(const VECTOR &mask) const {
-        //Number abs = value.twosComplement(isNegative);
-        //return Signed(abs.quarter(mask).twosComplement(isNegative), isNegative);
-        return Signed(value.quarter(mask), isNegative);
+        return Signed(signFill(value.quarter(mask), mask & isNegative, 2), isNegative);
     }
 
     inline Signed<Number> eighth(const VECTOR &mask) const {
-        //Number abs = value.twosComplement(isNegative);
-        //return Signed(abs.eighth(mask).twosComplement(isNegative), isNegative);
-        return Signed(value.eighth(mask), isNegative);
+        return Signed(signFill(value.eighth(mask), mask & isNegative, 3), isNegative);
+    }
+
+    // multiplication by a constant as shift-and-add of its canonical signed digits, e.g. scale(0.75) is x-x/4
+    inline Signed<Number> scale(double factor) const {
+        const int fraction = fractionBits<Number>();
+        long long numerator = std::llround(std::ldexp(factor, fraction));
+        return saturated(shiftAdd(*this, signedDigits(numerator, fraction)), std::ldexp((double)numerator, -fraction));
+    }
+
+    // multiplication by numerator*2^-shift, decomposed while compiling
+    template <long long numerator, int shift=0>
+    inline Signed<Number> mul_const() const {
+        constexpr SignedDigits digits = signedDigits(numerator, shift);
+        return saturated(shiftAdd(*this, digits), std::ldexp((double)numerator, -shift));
+    }
+
+    // shifted additions wrap, which leaves every product that fits exact, so lanes whose product by a factor
+    // above one exceeds the range are found from their magnitude and replaced by the nearest bound
+    inline Signed<Number> saturated(const Signed<Number> &product, double factor) const {
+        if(std::abs(factor)<=1)
+            return product;
+        double largest = std::floor(sup()/std::abs(factor)/eps())*eps();
+        VECTOR over = abs() > Number::broadcast(largest);
+        if(!ANY(over))
+            return product;
+        Signed<Number> bound = broadcast(sup()).twosComplement(factor<0 ? ~isNegative : isNegative);
+        return bound.merge(product, over);
     }
 
     inline Signed<Number> relu() const {
@@ -111,41 +153,30 @@ public:
     }
 
     inline Signed<Number> zerolike(const VECTOR &mask) const {
-        return Signed(value.zerolike(mask), isNegative);
-    }
-
-    inline Signed<Number>& operator=(const Signed<Number>& other) {
-        if (this != &other) {
-            this->value = other.value;
-            this->isNegative = other.isNegative;
-        }
-        return *this;
+        return Signed(value.zerolike(mask), isNegative & ~mask);
     }
 
-    inline Signed(): isNegative(0), value() {}
+    inline constexpr Signed(): isNegative(0), value() {}
 
-    inline Signed(const std::vector<double>& vec) {
-        value = Number();
+    // lanes are set like set() does, so negatives below eps round down to -eps instead of complementing to -2
+    inline Signed(const std::vector<double>& vec): isNegative(0), value() {
         for (int i = 0; i < vec.size(); ++i) 
-            if (vec[i]) {
-                if(vec[i]>0)
-                    value.set(i, vec[i]);
-                else {
-                    value.set(i, -vec[i]);
-                    isNegative |= ONEHOT(i);
-                }
-            }
-        value = value.twosComplement(isNegative);
-    }
-
-    inline static const double sup() {
+            if (vec[i]) 
+                set(i, vec[i]);
+    }
+
+    inline static constexpr double sup() {
         return Number::sup();
     }
 
-    inline static const double inf() {
+    inline static constexpr double inf() {
         return -Number::sup();
     }
 
+    inline static constexpr double eps() {
+        return Number::eps();
+    }
+
     inline const double sum() const {
         return value.sum(~isNegative) - value.twosComplement(isNegative).sum(isNegative);
     }
@@ -227,6 +258,7 @@ public:
         Number result = value.addWithCarry(other.value, carryOut);
         VECTOR finalSign = isNegative ^ other.isNegative ^ carryOut;
         underflow = isNegative & other.isNegative & ~finalSign;
+        COUNT_LANES(overflows, ~isNegative & ~other.isNegative & finalSign);
         #ifdef DEBUG_OVERFLOWS
             if(ANY(~isNegative & ~other.isNegative & finalSign))
                 throw std::logic_error("arithmetic overflow");
@@ -234,16 +266,99 @@ public:
         return Signed(result, finalSign);
     }
 
+    inline void compareWithCarry(const Signed<Number> &other, VECTOR &greater, VECTOR &equal) const {
+        greater |= equal & ~isNegative & other.isNegative;
+        equal &= ~(isNegative ^ other.isNegative);
+        value.compareWithCarry(other.value, greater, equal);
+    }
+
+    inline VECTOR operator>(const Signed<Number> &other) const {
+        VECTOR greater = 0;
+        VECTOR equal = ~(VECTOR)0;
+        compareWithCarry(other, greater, equal);
+        return greater;
+    }
+
+    inline VECTOR operator<(const Signed<Number> &other) const {
+        return other > *this;
+    }
+
+    inline VECTOR operator>=(const Signed<Number> &other) const {
+        return ~(other > *this);
+    }
+
+    inline VECTOR operator<=(const Signed<Number> &other) const {
+        return ~(*this > other);
+    }
+
+    inline VECTOR operator==(const Signed<Number> &other) const {
+        return ~(isNegative ^ other.isNegative) & (value == other.value);
+    }
+
+    inline Signed<Number> merge(const Signed<Number> &other, const VECTOR &mask) const {
+        return Signed(value.merge(other.value, mask), (isNegative&mask) | (other.isNegative&~mask));
+    }
+
     inline Signed<Number> minimum(const Signed<Number> &other) const {
-        Signed<Number> diff = *this-other;
-        VECTOR isNeg = diff.isNegative;
-        return Signed(value.merge(other.value, isNeg), (isNeg&isNegative) | (other.isNegative&~isNeg));
+        return merge(other, *this < other);
     }
 
     inline Signed<Number> maximum(const Signed<Number> &other) const {
-        Signed<Number> diff = *this-other;
-        VECTOR isNeg = ~diff.isNegative;
-        return Signed(value.merge(other.value, isNeg), (isNeg&isNegative) | (other.isNegative&~isNeg));
+        return merge(other, *this > other);
+    }
+
+    inline VECTOR argmaxMask(const VECTOR &mask) const {
+        VECTOR candidates = mask & ~isNegative;
+        return value.argmaxMask(ANY(candidates) ? candidates : mask);
+    }
+
+    inline VECTOR argminMask(const VECTOR &mask) const {
+        VECTOR candidates = mask & isNegative;
+        return value.argminMask(ANY(candidates) ? candidates : mask);
+    }
+
+    inline int argmax(const VECTOR &mask) const {
+        return FIRSTONE(argmaxMask(mask));
+    }
+
+    inline int argmax() const {
+        return FIRSTONE(argmaxMask(~(VECTOR)0));
+    }
+
+    inline int argmin() const {
+        return FIRSTONE(argminMask(~(VECTOR)0));
+    }
+
+    inline const double max() const {
+        return get(argmax());
+    }
+
+    inline const double min() const {
+        return get(argmin());
+    }
+
+    // this+other, or this-other, in lanes where it fits and half of it, rounded towards minus infinity, in the
+    // lanes marked as halved, from a sum with one more plane, so that no lane overflows
+    inline Signed<Number> sumOrHalf(const Signed<Number> &other, bool subtract, VECTOR &halved) const {
+        VECTOR a[MAX_ARITHMETIC_PLANES];
+        VECTOR b[MAX_ARITHMETIC_PLANES];
+        VECTOR sum[MAX_ARITHMETIC_PLANES];
+        toPlanes(a);
+        other.toPlanes(b);
+        const int planes = num_params();
+        VECTOR flip = subtract ? ~(VECTOR)0 : 0;
+        VECTOR carry = flip;
+        for(int j=0;j<planes;++j) {
+            VECTOR bj = b[j]^flip;
+            sum[j] = a[j]^bj^carry;
+            carry = (a[j]&bj) | (carry&(a[j]^bj));
+        }
+        VECTOR sign = a[planes-1]^b[planes-1]^flip^carry;
+        halved = sign^sum[planes-1];
+        for(int j=0;j<planes-1;++j)
+            sum[j] = (sum[j+1]&halved) | (sum[j]&~halved);
+        sum[planes-1] = sign;
+        return fromPlanes(sum);
     }
 
     inline Signed<Number> operator+(const Signed<Number> &other) const {
@@ -252,6 +367,7 @@ public:
         VECTOR finalSign = isNegative ^ other.isNegative ^ carryOut;
 
         // Detect overflow
+        COUNT_LANES(overflows, (finalSign ^ isNegative) & ~(isNegative ^ other.isNegative));
         #ifdef DEBUG_OVERFLOWS
         VECTOR overflow = (finalSign ^ isNegative) & ~(isNegative ^ other.isNegative);
         if (ANY(overflow)) {
@@ -279,11 +395,31 @@ public:
     }
 
     inline Signed<Number> operator*(const Signed<Number> &other) const {
-        Number ret1 = value.twosComplement(isNegative);
-        Number ret2 = other.value.twosComplement(other.isNegative);
-        Number ret = ret1*ret2;
+        Number ret = abs()*other.abs();
         VECTOR neg = isNegative ^ other.isNegative;
-        return Signed<Number>(ret.twosComplement(neg), neg);
+        return Signed(ret, 0).twosComplement(neg);
+    }
+    
+    inline Signed<Number> operator/(const Signed<Number> &other) const {
+        return Signed(abs()/other.abs(), 0).twosComplement(isNegative ^ other.isNegative);
+    }
+
+    // lanes in mask multiply their quotient by 2^shift while dividing, see planeDivide
+    inline Signed<Number> divide(const Signed<Number> &other, int shift, const VECTOR &mask) const {
+        return Signed(planeDivide(abs(), other.abs(), shift, mask), 0).twosComplement(isNegative ^ other.isNegative);
+    }
+
+    inline Signed<Number> reciprocal() const {
+        return Signed(abs().reciprocal(), 0).twosComplement(isNegative);
+    }
+
+    inline Signed<Number> sqrt() const {
+        return Signed(abs().sqrt().zerolike(isNegative), 0);
+    }
+
+    // lanes in mask take the root of their value times 2^shift, see planeSqrt
+    inline Signed<Number> sqrt(int shift, const VECTOR &mask) const {
+        return Signed(planeSqrt(abs(), shift, mask).zerolike(isNegative), 0);
     }
     
     /*template <typename RetNumber> inline RetNumber applyShifts(const RetNumber &number) const {
@@ -302,6 +438,23 @@ public:
         return value.applyHalf(number, mask&~isNegative);
     }
 
+    // the most negative value has no positive counterpart, so its magnitude saturates to sup()
+    inline Number abs() const {
+        VECTOR planes[MAX_ARITHMETIC_PLANES];
+        value.twosComplement(isNegative).toPlanes(planes);
+        VECTOR overflow = isNegative;
+        for(int j=0;j<Number::num_params();++j)
+            overflow &= ~planes[j];
+        for(int j=0;j<Number::num_params();++j)
+            planes[j] |= overflow;
+        COUNT_LANES(saturations, overflow);
+        return Number::fromPlanes(planes);
+    }
+
+    inline VECTOR sign() const {
+        return isNegative;
+    }
+
     inline Number nonNegatives() const {
         return value.zerolike(~isNegative);
     }
@@ -0,0 +1,88 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <string>
+#include <mutex>
+#include "vecutils.h"
+
+namespace tensorless {
+
+// Quantization health counters. When TELEMETRY is defined, arithmetic popcounts the lanes of its overflow,
+// underflow and saturation masks into thread-local counters; otherwise the counting macro compiles to nothing.
+//   overflows:   additions whose result exceeded the signed range and wrapped around
+//   underflows:  floating products or quotients whose exponent fell below range and were flushed to zero
+//   saturations: results clamped to the range (divisions and magnitudes of the most negative value)
+//   zeros:       zero lanes among layer outputs, out of lanes (counted by Layered)
+struct Telemetry {
+    long long overflows = 0;
+    long long underflows = 0;
+    long long saturations = 0;
+    long long zeros = 0;
+    long long lanes = 0;
+
+    Telemetry& operator+=(const Telemetry &other) {
+        overflows += other.overflows;
+        underflows += other.underflows;
+        saturations += other.saturations;
+        zeros += other.zeros;
+        lanes += other.lanes;
+        return *this;
+    }
+
+    Telemetry operator-(const Telemetry &other) const {
+        Telemetry ret = *this;
+        ret.overflows -= other.overflows;
+        ret.underflows -= other.underflows;
+        ret.saturations -= other.saturations;
+        ret.zeros -= other.zeros;
+        ret.lanes -= other.lanes;
+        return ret;
+    }
+
+    std::string describe() const {
+        return "overflows " + std::to_string(overflows)
+              + ", underflows " + std::to_string(underflows)
+              + ", saturations " + std::to_string(saturations)
+              + ", zeros " + std::to_string(zeros) + "/" + std::to_string(lanes);
+    }
+};
+
+// guards counters that several threads add to, e.g. those of one model shared by threads; copies get a lock of
+// their own, as locks cannot be copied
+struct TelemetryLock {
+    std::mutex mutex;
+    TelemetryLock() {}
+    TelemetryLock(const TelemetryLock&) {}
+    TelemetryLock& operator=(const TelemetryLock&) {return *this;}
+};
+
+inline Telemetry& threadTelemetry() {
+    static thread_local Telemetry telemetry;
+    return telemetry;
+}
+
+#ifdef TELEMETRY
+    #define COUNT_LANES(counter, mask) (tensorless::threadTelemetry().counter += POPCOUNT(mask))
+#else
+    #define COUNT_LANES(counter, mask)
+#endif
+
+}
+#endif  // TELEMETRY_H
@@ -0,0 +1,278 @@
+/*
+Copyright 2024 Emmanouil Krasanakis
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <omp.h>
+#include "vecutils.h"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace tensorless {
+
+// restricts a thread to one core (where the platform supports it) so that it keeps its caches
+inline void pinThread(std::thread &thread, int core) {
+    #ifdef __linux__
+    cpu_set_t cores;
+    CPU_ZERO(&cores);
+    CPU_SET(core, &cores);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cores);
+    #endif
+}
+
+// Persistent work-stealing scheduler for loops too small to amortize an OpenMP fork/join. Workers stay alive
+// between calls, each pinned to a core; parallelFor splits a range into chunks spread over per-worker queues,
+// workers that run out of chunks steal from the others, and the calling thread runs chunks too until all are
+// done. Idle workers spin for a few microseconds before parking on a condition variable, so that back-to-back
+// calls (e.g. consecutive layers) are dispatched without waking threads from the kernel.
+class ThreadPool {
+private:
+    struct Group {
+        std::atomic<int> remaining;
+        std::exception_ptr error;
+        std::mutex errorMutex;
+    };
+
+    struct Task {
+        const std::function<void(int, int)> *body;
+        int begin;
+        int end;
+        Group *group;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<int> pending;
+    std::atomic<int> parked;
+    std::atomic<bool> stopping;
+    std::atomic<unsigned> nextQueue;
+    std::mutex parkMutex;
+    std::condition_variable wake;
+    int spins;
+
+    // index of the worker running on this thread in the pool it belongs to, and the tasks it is nested in
+    static int& workerIndex() {
+        thread_local int index = -1;
+        return index;
+    }
+
+    static const ThreadPool*& workerPool() {
+        thread_local const ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    static int& taskDepth() {
+        thread_local int depth = 0;
+        return depth;
+    }
+
+    static void pause() {
+        #if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+        #else
+        std::this_thread::yield();
+        #endif
+    }
+
+    static void run(const Task &task) {
+        taskDepth()++;
+        try {
+            (*task.body)(task.begin, task.end);
+        }
+        catch(...) {
+            std::lock_guard<std::mutex> lock(task.group->errorMutex);
+            if(!task.group->error)
+                task.group->error = std::current_exception();
+        }
+        taskDepth()--;
+        task.group->remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    // own queue first (newest task, whose data is still in cache), then the oldest task of any other queue
+    bool runOne(int self) {
+        Task task;
+        int count = queues.size();
+        for(int k=0;k<count;++k) {
+            int index = self<0 ? (int)((nextQueue.load(std::memory_order_relaxed)+k)%count) : (self+k)%count;
+            Queue &queue = *queues[index];
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if(queue.tasks.empty())
+                    continue;
+                if(k==0 && self>=0) {
+                    task = queue.tasks.back();
+                    queue.tasks.pop_back();
+                }
+                else {
+                    task = queue.tasks.front();
+                    queue.tasks.pop_front();
+                }
+            }
+            pending.fetch_sub(1, std::memory_order_acq_rel);
+            run(task);
+            return true;
+        }
+        return false;
+    }
+
+    void work(int index) {
+        workerIndex() = index;
+        workerPool() = this;
+        while(!stopping.load(std::memory_order_acquire)) {
+            if(runOne(index))
+                continue;
+            int spin = 0;
+            while(spin<spins && !pending.load(std::memory_order_acquire) && !stopping.load(std::memory_order_relaxed)) {
+                pause();
+                ++spin;
+            }
+            if(spin<spins)
+                continue;
+            std::unique_lock<std::mutex> lock(parkMutex);
+            parked.fetch_add(1);
+            wake.wait(lock, [this]() {return stopping.load() || pending.load()>0;});
+            parked.fetch_sub(1);
+        }
+    }
+
+public:
+    // threads counts the calling thread, so a pool of one thread runs everything inline; spins is how many
+    // pause instructions idle workers wait before parking
+    explicit ThreadPool(int threads, bool pinned=true, int spins=2000)
+        : pending(0), parked(0), stopping(false), nextQueue(0), spins(spins) {
+        if(threads<1)
+            throw std::logic_error("a thread pool needs at least one thread");
+        int cores = std::thread::hardware_concurrency();
+        for(int i=0;i<threads-1;++i)
+            queues.emplace_back(new Queue());
+        for(int i=0;i<threads-1;++i) {
+            workers.emplace_back(&ThreadPool::work, this, i);
+            if(pinned && cores>=threads)
+                pinThread(workers.back(), (i+1)%cores);
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            stopping.store(true);
+        }
+        wake.notify_all();
+        for(auto& worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // shared pool of TENSORLESS_THREADS threads, or of omp_get_max_threads() if that is not set
+    static ThreadPool& global() {
+        static ThreadPool pool([]() {
+            const char *threads = std::getenv("TENSORLESS_THREADS");
+            return threads && std::atoi(threads)>0 ? std::atoi(threads) : omp_get_max_threads();
+        }());
+        return pool;
+    }
+
+    int size() const {
+        return workers.size()+1;
+    }
+
+    // whether this thread is running a pool task or a Sequential scope, where nested loops are better run inline
+    static bool insideTask() {
+        return taskDepth()>0;
+    }
+
+    // whether a loop over count items, worth splitting from threshold items on, should go to the global pool: not
+    // when this thread already runs a pool task or an OpenMP parallel region (e.g. one model replica per thread),
+    // and not in builds that gather profiling or telemetry counters, which are per thread
+    static bool shouldSplit(std::size_t count, std::size_t threshold) {
+        #if defined(PROFILING) || defined(TELEMETRY)
+        return false;
+        #else
+        return count>=threshold && global().size()>1 && !insideTask() && !omp_in_parallel();
+        #endif
+    }
+
+    // marks the current thread as busy for its lifetime, e.g. threads that already own a core
+    struct Sequential {
+        Sequential() {taskDepth()++;}
+        ~Sequential() {taskDepth()--;}
+        Sequential(const Sequential&) = delete;
+        Sequential& operator=(const Sequential&) = delete;
+    };
+
+    // runs body(chunkBegin, chunkEnd) over chunks of at least grain indices that cover [begin, end), and
+    // returns when all have finished; the first exception thrown by a chunk is rethrown here
+    void parallelFor(int begin, int end, const std::function<void(int, int)> &body, int grain=1) {
+        int count = end-begin;
+        if(count<=0)
+            return;
+        grain = std::max(grain, 1);
+        int chunks = std::min((count+grain-1)/grain, 4*size());
+        if(chunks<=1 || workers.empty()) {
+            body(begin, end);
+            return;
+        }
+        Group group;
+        group.remaining.store(chunks);
+        int self = workerPool()==this ? workerIndex() : -1;
+        unsigned first = nextQueue.fetch_add(chunks, std::memory_order_relaxed);
+        for(int chunk=0;chunk<chunks;++chunk) {
+            Task task{&body, begin+(int)((long long)count*chunk/chunks), begin+(int)((long long)count*(chunk+1)/chunks), &group};
+            Queue &queue = *queues[(first+chunk)%queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(task);
+        }
+        pending.fetch_add(chunks);
+        if(parked.load()) {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            wake.notify_all();
+        }
+        while(group.remaining.load(std::memory_order_acquire)>0)
+            if(!runOne(self))
+                pause();
+        if(group.error)
+            std::rethrow_exception(group.error);
+    }
+};
+
+}
+#endif  // THREADPOOL_H
@@ -18,6 +18,8 @@ limitations under the License.
 #define VECUTILS_H
 
 //#define DEBUG_OVERFLOWS  // enable for a slow but logically safe execution environment
+//#define TELEMETRY  // enable to count overflows, underflows and saturations (see telemetry.h)
+//#define PROFILING  // enable to count plane ops and popcounts and to time Layered calls (see profiling.h)
 //#define SUPERLONG
 #ifdef __SIZEOF_INT128__
     #define INT128
@@ -28,12 +30,15 @@ limitations under the License.
 #include <bitset>
 #include <cstdlib>
 #include <random>
+#include <climits>
+#include <cstdint>
+#include "profiling.h"
 
 namespace tensorless {
 
-std::random_device rd;
-std::mt19937_64 generator(rd());
-std::uniform_int_distribution<long long> distribution(0, LONG_LONG_MAX);
+inline std::random_device rd;
+inline std::mt19937_64 generator(rd());
+inline std::uniform_int_distribution<long long> distribution(0, LLONG_MAX);
 
 #ifdef SUPERLONG
     #ifdef INT128
@@ -41,6 +46,14 @@ std::uniform_int_distribution<long long> distribution(0, LONG_LONG_MAX);
     #else
         #define INTERNALVECTOR long long
     #endif
+    inline constexpr int ctz(INTERNALVECTOR x) {
+        #ifdef INT128
+        uint64_t low = static_cast<uint64_t>(x);
+        return low ? __builtin_ctzll(low) : 64 + __builtin_ctzll(static_cast<uint64_t>(x >> 64));
+        #else
+        return __builtin_ctzll(x);
+        #endif
+    }
     class FourLongs {
         private:
             INTERNALVECTOR l1;
@@ -48,60 +61,59 @@ std::uniform_int_distribution<long long> distribution(0, LONG_LONG_MAX);
             INTERNALVECTOR l3;
             INTERNALVECTOR l4;
         public:
-            inline FourLongs(INTERNALVECTOR val): l1(val), l2(0), l3(0), l4(0) {}
-            inline FourLongs(): l1(0), l2(0), l3(0), l4(0) {}
-            inline FourLongs(const FourLongs& other): l1(other.l1), l2(other.l2), l3(other.l3), l4(other.l4) {}
-            inline FourLongs& operator=(const FourLongs& other) {
-                if (this == &other) {
-                    return *this; // handle self assignment
-                }
-                l1 = other.l1;
-                l2 = other.l2;
-                l3 = other.l3;
-                l4 = other.l4;
-                return *this;
-            }
-            inline FourLongs(INTERNALVECTOR l1, INTERNALVECTOR l2, INTERNALVECTOR l3, INTERNALVECTOR l4): l1(l1), l2(l2), l3(l3), l4(l4) {}
-            inline int count() const {
+            inline constexpr FourLongs(INTERNALVECTOR val): l1(val), l2(0), l3(0), l4(0) {}
+            inline constexpr FourLongs(): l1(0), l2(0), l3(0), l4(0) {}
+            inline constexpr FourLongs(INTERNALVECTOR l1, INTERNALVECTOR l2, INTERNALVECTOR l3, INTERNALVECTOR l4): l1(l1), l2(l2), l3(l3), l4(l4) {}
+            inline constexpr int count() const {
                 return __builtin_popcountll(l1) + __builtin_popcountll(l2)+__builtin_popcountll(l3)+__builtin_popcountll(l4);
             }
-            inline bool any() const {
+            inline constexpr bool any() const {
                 return l1 || l2 || l3 || l4;
             }
-            inline FourLongs operator&(const FourLongs &other) const {
+            inline constexpr int firstOne() const {
+                if (l1) 
+                    return ctz(l1);
+                else if (l2) 
+                    return 64 + ctz(l2);
+                else if (l3) 
+                    return 128 + ctz(l3);
+                else 
+                    return 192 + ctz(l4);
+            }
+            inline constexpr FourLongs operator&(const FourLongs &other) const {
                 return FourLongs(l1 & other.l1, l2 & other.l2, l3 & other.l3, l4 & other.l4);
             }
-            inline FourLongs operator|(const FourLongs &other) const {
+            inline constexpr FourLongs operator|(const FourLongs &other) const {
                 return FourLongs(l1 | other.l1, l2 | other.l2, l3 | other.l3, l4 | other.l4);
             }
-            inline FourLongs operator^(const FourLongs &other) const {
+            inline constexpr FourLongs operator^(const FourLongs &other) const {
                 return FourLongs(l1 ^ other.l1, l2 ^ other.l2, l3 ^ other.l3, l4 ^ other.l4);
             }
-            inline FourLongs operator~() const {
+            inline constexpr FourLongs operator~() const {
                 return FourLongs(~l1, ~l2, ~l3, ~l4);
             }
-            inline FourLongs& operator&=(const FourLongs &other) {
+            inline constexpr FourLongs& operator&=(const FourLongs &other) {
                 l1 &= other.l1;
                 l2 &= other.l2;
                 l3 &= other.l3;
                 l4 &= other.l4;
                 return *this;
             }
-            inline FourLongs& operator|=(const FourLongs &other) {
+            inline constexpr FourLongs& operator|=(const FourLongs &other) {
                 l1 |= other.l1;
                 l2 |= other.l2;
                 l3 |= other.l3;
                 l4 |= other.l4;
                 return *this;
             }
-            inline FourLongs& operator^=(const FourLongs &other) {
+            inline constexpr FourLongs& operator^=(const FourLongs &other) {
                 l1 ^= other.l1;
                 l2 ^= other.l2;
                 l3 ^= other.l3;
                 l4 ^= other.l4;
                 return *this;
             }
-            inline int operator[](int index) const {
+            inline constexpr int operator[](int index) const {
                 /*if (index < 0 || index >= 256) {
                     throw std::out_of_range("Index out of range");
                 }*/
@@ -114,7 +126,7 @@ std::uniform_int_distribution<long long> distribution(0, LONG_LONG_MAX);
                 else 
                     return (l4 >> (index - 192)) & 1;
             }
-            inline const FourLongs& toggleOn(int index) {
+            inline constexpr const FourLongs& toggleOn(int index) {
                 /*if (index < 0 || index >= 256) {
                     throw std::out_of_range("Index out of range");
                 }*/
@@ -125,16 +137,17 @@ std::uniform_int_distribution<long long> distribution(0, LONG_LONG_MAX);
                 else if (index < 192) 
                     l3 |= ((INTERNALVECTOR)1) << (index-128);
                 else 
-                    l3 |= ((INTERNALVECTOR)1) << (index-192);
+                    l4 |= ((INTERNALVECTOR)1) << (index-192);
                 return *this;
             }
     };
 
 
     #define VECTOR FourLongs 
-    #define bitcount(x) ((x).count())  
+    #define POPCOUNT(x) ((x).count())  
     #define GETAT(x, i) (x)[i]
     #define ANY(x) (x).any()
+    #define FIRSTONE(x) ((x).firstOne())
     inline VECTOR lrand() {
         return FourLongs(distribution(generator),
                          distribution(generator),
@@ -146,25 +159,38 @@ std::uniform_int_distribution<long long> distribution(0, LONG_LONG_MAX);
 #ifdef INT128
     #define VECTOR __int128 
     #define GETAT(x, i) ((int)((x >> i) & 1))
-    #define bitcount(x) (__builtin_popcountll(static_cast<uint64_t>(x))+__builtin_popcountll(static_cast<uint64_t>((x) >> 64)))
+    #define POPCOUNT(x) (__builtin_popcountll(static_cast<uint64_t>(x))+__builtin_popcountll(static_cast<uint64_t>((x) >> 64)))
     #define ANY(x) (x)
     inline VECTOR lrand() {
         return (((VECTOR)distribution(generator))<<64 | (VECTOR)distribution(generator));
     }
+    inline int firstOne(VECTOR x) {
+        uint64_t low = static_cast<uint64_t>(x);
+        return low ? __builtin_ctzll(low) : 64 + __builtin_ctzll(static_cast<uint64_t>(x >> 64));
+    }
+    #define FIRSTONE(x) firstOne(x)
     #define ONEHOT(i) (((VECTOR)1) << i)
 #else
     #define VECTOR long long int
     #define GETAT(x, i) ((x >> i) & 1)
-    #define bitcount(x) __builtin_popcountll(x)
+    #define POPCOUNT(x) __builtin_popcountll(x)
     #define ANY(x) (x)
     inline VECTOR lrand() {
         return distribution(generator);
     }
+    #define FIRSTONE(x) __builtin_ctzll(x)
     #define ONEHOT(i) (((VECTOR)1) << i)
 #endif
 #endif
 
+#ifdef PROFILING
+    #define bitcount(x) (++tensorless::threadOpCounters().popcounts, POPCOUNT(x))
+#else
+    #define bitcount(x) POPCOUNT(x)
+#endif
+
 #define VECTOR_SIZE (sizeof(VECTOR)*8);
+// FIRSTONE(x) is the lane index of the lowest set bit and is undefined for x==0
 
 }
 #endif  // VECUTILS_H
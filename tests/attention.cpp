@@ -0,0 +1,117 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+
+// SelfAttention decoding against a double implementation with the weights returned by weight(), over a
+// sequence that spans several blocks of cached positions. The relative RMS error of all outputs includes
+// the rounding of projections, scores, exponents and the attended values to the packed type.
+
+using namespace tensorless;
+
+#define DIM 64
+#define HEADS 4
+#define POSITIONS 300
+
+class Reference {
+private:
+    std::vector<double> weights;  // query, key, value and output projections
+    std::vector<double> keys;
+    std::vector<double> values;
+
+public:
+    double low;
+    double high;
+
+    template <typename Layer>
+    Reference(const Layer &layer, double low, double high): weights(4*DIM*DIM), low(low), high(high) {
+        for(int m=0;m<4;++m)
+            for(int out=0;out<DIM;++out)
+                for(int in=0;in<DIM;++in)
+                    weights[(m*DIM+out)*DIM+in] = layer.weight(m, out, in);
+    }
+
+    double clip(double value) const {
+        return std::min(std::max(value, low), high);
+    }
+
+    void forward(const double *input, double *out) {
+        double projected[3][DIM];
+        for(int m=0;m<3;++m)
+            for(int i=0;i<DIM;++i) {
+                projected[m][i] = 0;
+                for(int in=0;in<DIM;++in)
+                    projected[m][i] += weights[(m*DIM+i)*DIM+in]*input[in];
+                projected[m][i] = clip(projected[m][i]);
+            }
+        keys.insert(keys.end(), projected[1], projected[1]+DIM);
+        values.insert(values.end(), projected[2], projected[2]+DIM);
+        int positions = keys.size()/DIM;
+        int headDim = DIM/HEADS;
+        double attended[DIM] = {0};
+        std::vector<double> scores(positions);
+        for(int h=0;h<HEADS;++h) {
+            double max = -INFINITY;
+            for(int t=0;t<positions;++t) {
+                scores[t] = 0;
+                for(int j=h*headDim;j<(h+1)*headDim;++j)
+                    scores[t] += projected[0][j]*keys[t*DIM+j];
+                scores[t] /= std::sqrt((double)headDim);
+                max = std::max(max, scores[t]);
+            }
+            double total = 0;
+            for(int t=0;t<positions;++t) {
+                scores[t] = std::exp(scores[t]-max);
+                total += scores[t];
+            }
+            for(int t=0;t<positions;++t)
+                for(int j=h*headDim;j<(h+1)*headDim;++j)
+                    attended[j] += scores[t]/total*values[t*DIM+j];
+        }
+        for(int i=0;i<DIM;++i) {
+            out[i] = 0;
+            for(int in=0;in<DIM;++in)
+                out[i] += weights[(3*DIM+i)*DIM+in]*clip(attended[in]);
+            out[i] = clip(out[i]);
+        }
+    }
+};
+
+template <typename T>
+int check(const char *name, double tolerance) {
+    SelfAttention<T, DIM, HEADS> attention;
+    Reference reference(attention, T::inf(), T::sup());
+    double error = 0;
+    double norm = 0;
+    for(int position=0;position<POSITIONS;++position) {
+        T input;
+        double values[DIM];
+        double expected[DIM];
+        // small enough that projections of 64 lanes stay within the range of sfloat9
+        for(int lane=0;lane<DIM;++lane)
+            input.set(lane, std::sin(position*31+lane)*0.2);
+        for(int lane=0;lane<DIM;++lane)
+            values[lane] = input.get(lane);
+        reference.forward(values, expected);
+        T output = attention.forward(input);
+        for(int i=0;i<DIM;++i) {
+            error += (output.get(i)-expected[i])*(output.get(i)-expected[i]);
+            norm += expected[i]*expected[i];
+        }
+    }
+    double relative = std::sqrt(error/norm);
+    int failures = relative>tolerance;
+    if(failures)
+        printf("%s relative error %g exceeds %g\n", name, relative, tolerance);
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += check<sfloat9>("sfloat9", 0.05);
+    failures += check<dfloat10>("dfloat10", 0.14);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// BinaryDense outputs against 1/ins times the sum of the signs of the input values returned by get() times the
+// binarized weights, before and after training, and the error it propagates against the same sum of output
+// errors, which must be zero for inputs beyond the straight-through clip.
+
+using namespace tensorless;
+
+#define INS 64
+#define OUTS 100
+
+std::mt19937_64 rng(43);
+
+template <typename T>
+T randomInput(double scale) {
+    std::uniform_real_distribution<double> value(-scale, scale);
+    T ret;
+    for(int j=0;j<INS;++j)
+        ret.set(j, value(rng));
+    return ret;
+}
+
+// outputs are multiples of 1/ins, so they must recover the count of agreeing signs
+template <typename T, typename Layer>
+int compare(const char *name, const char *stage, Layer &layer, const T &input) {
+    int failures = 0;
+    T output = layer.forward(input);
+    VECTOR inputNegative = 0;
+    for(int j=0;j<INS;++j)
+        if(input.get(j)<0)
+            inputNegative |= ONEHOT(j);
+    VECTOR signs = layer.forwardSigns(inputNegative);
+    for(int i=0;i<output.size();++i) {
+        int dot = 0;
+        for(int j=0;j<INS && i<OUTS;++j)
+            dot += (input.get(j)<0 ? -1 : 1)*layer.weight(i, j);
+        double expected = (double)dot/INS;
+        if(std::abs(output.get(i)-expected)>0.5/INS && failures++<5)
+            printf("%s output %d %s: %g instead of %g\n", name, i, stage, output.get(i), expected);
+        if(i<OUTS && (bool)GETAT(signs, i)!=(dot<0) && failures++<5)
+            printf("%s output %d %s: sign mask disagrees with %d\n", name, i, stage, dot);
+    }
+    return failures;
+}
+
+template <typename T>
+int checkBackward(const char *name, BinaryDense<T, INS, OUTS> &layer, double clip, double tolerance) {
+    int failures = 0;
+    T input = randomInput<T>(2*clip);
+    layer.forward(input);
+    std::vector<double> errors(OUTS);
+    T error = randomInput<T>(0.5);
+    for(int i=0;i<OUTS;++i)
+        errors[i] = error.get(i);
+    double weights[OUTS][INS];
+    for(int i=0;i<OUTS;++i)
+        for(int j=0;j<INS;++j)
+            weights[i][j] = layer.weight(i, j);
+    SGD<T> optimizer(0.1);
+    T propagated = layer.backward(error, optimizer);
+    for(int j=0;j<INS;++j) {
+        double expected = 0;
+        if(std::abs(input.get(j))<=clip)
+            for(int i=0;i<OUTS;++i)
+                expected += errors[i]*weights[i][j]/INS;
+        if(std::abs(input.get(j))>clip && propagated.get(j)!=0 && failures++<5)
+            printf("%s input %d beyond the clip: error %g\n", name, j, propagated.get(j));
+        if(std::abs(propagated.get(j)-expected)>tolerance && failures++<5)
+            printf("%s input %d: error %g instead of %g\n", name, j, propagated.get(j), expected);
+    }
+    return failures;
+}
+
+// each output adds its error over ins rounded to a step of the type, which Signed types floor and Dynamic sums
+// round to a step of their growing mantisa
+template <typename T>
+int check(const char *name, double tolerance) {
+    int failures = 0;
+    BinaryDense<T, INS, OUTS> layer(0.5);
+    T input = randomInput<T>(1);
+    failures += compare(name, "before training", layer, input);
+    for(int step=0;step<5;++step)
+        failures += checkBackward(name, layer, 0.5, tolerance);
+    failures += compare(name, "after training", layer, input);
+    failures += compare(name, "on new inputs", layer, randomInput<T>(1));
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += check<sfloat9>("sfloat9", OUTS*sfloat9::eps());
+    failures += check<dfloat10>("dfloat10", 0.1);
+    failures += check<float12>("float12", 0.05);
+    return failures ? 1 : 0;
+}
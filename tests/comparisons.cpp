@@ -0,0 +1,73 @@
+#include "../tensorless/types/all.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// Lane-wise comparisons, minimum and maximum of Floating types against the values returned by get(), on
+// random lanes whose exponents span the whole mantisa range, including zeros and values that differ only
+// in their lowest body bits.
+
+using namespace tensorless;
+
+std::mt19937_64 rng(7);
+
+template <typename T>
+void fill(T &value, T &close) {
+    int minExponent = (int)T::inf()==0 ? 0 : -(int)std::log2(-T::inf());
+    int maxExponent = (int)std::log2(T::sup());
+    std::uniform_int_distribution<int> exponent(minExponent-4, maxExponent);
+    std::uniform_real_distribution<double> significand(0.5, 1);
+    for(int i=0;i<value.size();++i) {
+        double x = i%17==0 ? 0 : significand(rng)*std::ldexp(1, exponent(rng))*(rng()%2 ? -1 : 1);
+        value.set(i, x);
+        // a neighbouring value, equal or just above or below
+        close.set(i, x*(1+(double)((int)(rng()%3)-1)/64));
+    }
+}
+
+template <typename T>
+int check(const char *name) {
+    int failures = 0;
+    for(int round=0;round<200;++round) {
+        T a, b;
+        T c, d;
+        fill(a, c);
+        fill(b, d);
+        const T pairs[][2] = {{a, b}, {a, c}, {b, d}, {a, a}};
+        for(const auto &pair : pairs) {
+            const T &x = pair[0];
+            const T &y = pair[1];
+            VECTOR greater = x > y;
+            VECTOR less = x < y;
+            VECTOR equal = x == y;
+            VECTOR greaterEqual = x >= y;
+            VECTOR lessEqual = x <= y;
+            T low = x.minimum(y);
+            T high = x.maximum(y);
+            for(int i=0;i<x.size();++i) {
+                double u = x.get(i);
+                double v = y.get(i);
+                bool ok = GETAT(greater, i)==(u>v) && GETAT(less, i)==(u<v) && GETAT(equal, i)==(u==v)
+                          && GETAT(greaterEqual, i)==(u>=v) && GETAT(lessEqual, i)==(u<=v)
+                          && low.get(i)==std::min(u, v) && high.get(i)==std::max(u, v);
+                if(!ok && failures++<5)
+                    printf("%s lane %d: %g vs %g compares wrongly\n", name, i, u, v);
+            }
+        }
+    }
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += check<float7>("float7");
+    failures += check<float8>("float8");
+    failures += check<float9>("float9");
+    failures += check<float10>("float10");
+    failures += check<float11>("float11");
+    failures += check<float12>("float12");
+    failures += check<float13>("float13");
+    failures += check<float15>("float15");
+    return failures ? 1 : 0;
+}
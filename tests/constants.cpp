@@ -0,0 +1,43 @@
+#include "../tensorless/types/all.h"
+#include <cstdio>
+
+// Compile-time constants against runtime broadcasts of the same values. CMake also builds this test with
+// SUPERLONG, whose FourLongs planes must be usable in constant expressions too.
+
+using namespace tensorless;
+
+template <typename T>
+int compare(const char *name, double value, const T &constant) {
+    T broadcast = T::broadcast(value);
+    int failures = 0;
+    for(int i=0;i<broadcast.size();++i)
+        if(constant.get(i)!=broadcast.get(i) && failures++<5)
+            printf("%s lane %d: constant %g but broadcast %g\n", name, i, constant.get(i), broadcast.get(i));
+    return failures;
+}
+
+// each value goes through constant() in a constexpr variable and through TENSORLESS_CONSTANT
+#define CHECK(Type, value) { \
+        constexpr Type ret = constant<Type>(value); \
+        failures += compare<Type>(#Type, value, ret); \
+        failures += compare<Type>(#Type, value, TENSORLESS_CONSTANT(Type, value)); \
+    }
+
+#define CHECK_TYPE(Type) { \
+        int failures = 0; \
+        CHECK(Type, 0.25) \
+        CHECK(Type, -0.5) \
+        CHECK(Type, 0) \
+        printf("%-8s %s\n", #Type, failures ? "FAILED" : "ok"); \
+        total += failures; \
+    }
+
+int main() {
+    int total = 0;
+    CHECK_TYPE(sfloat4)
+    CHECK_TYPE(sfloat9)
+    CHECK_TYPE(dfloat8)
+    CHECK_TYPE(float8)
+    CHECK_TYPE(float12)
+    return total ? 1 : 0;
+}
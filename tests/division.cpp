@@ -0,0 +1,181 @@
+#include "../tensorless/types/all.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// Division, reciprocals and square roots of every type family against the values returned by get(). Raw and
+// Signed types truncate magnitudes exactly and saturate to sup(), Dynamic types keep every quotient within one
+// body step of their shared scale, and Floating types keep every quotient within one body step of its own
+// normalized body.
+
+using namespace tensorless;
+
+std::mt19937_64 rng(37);
+
+template <typename T>
+int levels() {
+    return (int)std::lround((T::sup()-T::inf())/T::eps())+1;
+}
+
+// lanes cycle through every representable value, starting from the offset-th one
+template <typename T>
+T everyValue(int offset=0) {
+    T ret;
+    for(int i=0;i<ret.size();++i)
+        ret.set(i, T::inf()+((i+offset)%levels<T>())*T::eps());
+    return ret;
+}
+
+template <typename T>
+double truncated(double magnitude) {
+    if(!(magnitude<T::sup()))
+        return T::sup();
+    return std::floor(magnitude/T::eps()+1e-9)*T::eps();
+}
+
+template <typename T>
+void expect(const char *name, const char *what, int lane, double result, double expected, double tolerance,
+            int &failures) {
+    if(!(std::abs(result-expected)<=tolerance) && failures++<5)
+        printf("%s %s lane %d: %g instead of %g\n", name, what, lane, result, expected);
+}
+
+// magnitudes go through abs(), so the most negative Signed value divides as -sup()
+template <typename T>
+int checkFixed(const char *name) {
+    int failures = 0;
+    T x = everyValue<T>();
+    double one = std::min(1.0, (double)T::sup());
+    for(int offset=1;offset<levels<T>();offset+=3) {
+        T y = everyValue<T>(offset);
+        T quotient = x/y;
+        for(int i=0;i<x.size();++i) {
+            double a = x.get(i);
+            double b = y.get(i);
+            double magnitude = b==0 ? T::sup() : truncated<T>(std::min(std::abs(a), (double)T::sup())/std::min(std::abs(b), (double)T::sup()));
+            double sign = (a<0)!=(b<0) ? -1 : 1;
+            expect<T>(name, "x/y", i, quotient.get(i), a==0 && b!=0 ? 0 : sign*magnitude, 0, failures);
+        }
+    }
+    T reciprocal = x.reciprocal();
+    T root = x.sqrt();
+    for(int i=0;i<x.size();++i) {
+        double a = x.get(i);
+        double magnitude = a==0 ? T::sup() : truncated<T>(one/std::min(std::abs(a), (double)T::sup()));
+        expect<T>(name, "reciprocal", i, reciprocal.get(i), a<0 ? -magnitude : magnitude, 0, failures);
+        expect<T>(name, "sqrt", i, root.get(i), a<0 ? 0 : truncated<T>(std::sqrt(a)), 0, failures);
+    }
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+// values with random signs and magnitudes in [1/2, 2), whose quotients stay within every type's range
+std::vector<double> randomValues(int size) {
+    std::uniform_real_distribution<double> exponent(-1, 1);
+    std::vector<double> ret(size);
+    for(int i=0;i<size;++i)
+        ret[i] = (rng()%2 ? -1 : 1)*std::exp2(exponent(rng));
+    return ret;
+}
+
+template <typename T>
+T fromValues(const std::vector<double> &values) {
+    T ret;
+    for(int i=0;i<ret.size();++i)
+        ret.set(i, values[i]);
+    return ret;
+}
+
+// the shared scale reaches the largest quotient, so errors are measured against that
+template <typename T, typename Body>
+int checkDynamic(const char *name) {
+    int failures = 0;
+    for(int repeat=0;repeat<20;++repeat) {
+        T x = T(randomValues(T().size()));
+        T y = T(randomValues(T().size()));
+        T quotient = x/y;
+        T reciprocal = y.reciprocal();
+        T root = (x*x).sqrt();
+        double largestQuotient = 0;
+        double largestReciprocal = 0;
+        for(int i=0;i<x.size();++i) {
+            largestQuotient = std::max(largestQuotient, std::abs(x.get(i)/y.get(i)));
+            largestReciprocal = std::max(largestReciprocal, std::abs(1/y.get(i)));
+        }
+        double step = 2*Body::eps()/Body::sup();
+        for(int i=0;i<x.size();++i) {
+            expect<T>(name, "x/y", i, quotient.get(i), x.get(i)/y.get(i), step*largestQuotient, failures);
+            expect<T>(name, "reciprocal", i, reciprocal.get(i), 1/y.get(i), step*largestReciprocal, failures);
+            expect<T>(name, "sqrt", i, root.get(i), std::sqrt((x*x).get(i)), 2*step, failures);
+        }
+    }
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+// normalized bodies are at least half of their range, where one body step is the relative step
+template <typename T, typename Body>
+int checkFloating(const char *name) {
+    int failures = 0;
+    double step = 2*Body::eps()/Body::sup();
+    for(int repeat=0;repeat<20;++repeat) {
+        T x = fromValues<T>(randomValues(T().size()));
+        T y = fromValues<T>(randomValues(T().size()));
+        T quotient = x/y;
+        T reciprocal = y.reciprocal();
+        T root = x.sqrt();
+        for(int i=0;i<x.size();++i) {
+            double a = x.get(i);
+            double b = y.get(i);
+            expect<T>(name, "x/y", i, quotient.get(i), a/b, step*std::abs(a/b), failures);
+            expect<T>(name, "reciprocal", i, reciprocal.get(i), 1/b, step*std::abs(1/b), failures);
+            expect<T>(name, "sqrt", i, root.get(i), a<0 ? 0 : std::sqrt(a), step*std::sqrt(std::abs(a)), failures);
+        }
+    }
+    for(auto pair : {std::make_pair(2.0, 2.0), std::make_pair(2.0, 3.0), std::make_pair(-3.06, 0.547)}) {
+        T x = T::broadcast(pair.first);
+        T y = T::broadcast(pair.second);
+        double expected = x.get(0)/y.get(0);
+        expect<T>(name, "broadcast x/y", 0, (x/y).get(0), expected, step*std::abs(expected), failures);
+    }
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += checkFixed<Int2>("Int2");
+    failures += checkFixed<Int3>("Int3");
+    failures += checkFixed<Int4>("Int4");
+    failures += checkFixed<Float3>("Float3");
+    failures += checkFixed<Float4>("Float4");
+    failures += checkFixed<Float5>("Float5");
+    failures += checkFixed<Float6>("Float6");
+    failures += checkFixed<Float7>("Float7");
+    failures += checkFixed<Float8>("Float8");
+    failures += checkFixed<int3>("int3");
+    failures += checkFixed<int4>("int4");
+    failures += checkFixed<int5>("int5");
+    failures += checkFixed<sfloat4>("sfloat4");
+    failures += checkFixed<sfloat5>("sfloat5");
+    failures += checkFixed<sfloat6>("sfloat6");
+    failures += checkFixed<sfloat7>("sfloat7");
+    failures += checkFixed<sfloat8>("sfloat8");
+    failures += checkFixed<sfloat9>("sfloat9");
+    failures += checkDynamic<dfloat5, sfloat4>("dfloat5");
+    failures += checkDynamic<dfloat6, sfloat5>("dfloat6");
+    failures += checkDynamic<dfloat7, sfloat6>("dfloat7");
+    failures += checkDynamic<dfloat8, sfloat7>("dfloat8");
+    failures += checkDynamic<dfloat9, sfloat8>("dfloat9");
+    failures += checkDynamic<dfloat10, sfloat9>("dfloat10");
+    failures += checkFloating<float7, sfloat4>("float7");
+    failures += checkFloating<float8, sfloat4>("float8");
+    failures += checkFloating<float9, sfloat5>("float9");
+    failures += checkFloating<float10, sfloat6>("float10");
+    failures += checkFloating<float11, sfloat7>("float11");
+    failures += checkFloating<float12, sfloat8>("float12");
+    failures += checkFloating<float13, sfloat8>("float13");
+    failures += checkFloating<float14, sfloat9>("float14");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,152 @@
+#include "../tensorless/types/all.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// Dynamic lanes against the values returned by get(). Operands with different mantisas are rescaled to
+// the larger one with shifted additions, which truncate up to one eps of the larger mantisa per body
+// plane; lanes of the operand with the larger mantisa are kept exactly.
+
+using namespace tensorless;
+
+std::mt19937_64 rng(13);
+
+template <typename T>
+T randomLanes(double scale) {
+    std::uniform_real_distribution<double> value(-scale, scale);
+    std::vector<double> lanes(T().size());
+    for(double &lane : lanes)
+        lane = value(rng);
+    return T(lanes);
+}
+
+template <typename T, typename Body>
+int checkMerge(const char *name) {
+    int failures = 0;
+    const double scales[] = {0.25, 1, 3, 100};
+    for(double xScale : scales)
+        for(double yScale : scales) {
+            T x = randomLanes<T>(xScale);
+            T y = randomLanes<T>(yScale);
+            VECTOR mask = lrand();
+            T merged = x.merge(y, mask);
+            bool xLarger = x.getMantisa()>=y.getMantisa();
+            double tolerance = Body::num_params()*Body::eps()*std::max(x.getMantisa(), y.getMantisa());
+            for(int i=0;i<x.size();++i) {
+                double expected = GETAT(mask, i) ? x.get(i) : y.get(i);
+                if(GETAT(mask, i)==xLarger && merged.get(i)!=expected && failures++<5)
+                    printf("%s merge lane %d: %g instead of exactly %g\n", name, i, merged.get(i), expected);
+                if(std::abs(merged.get(i)-expected)>tolerance && failures++<5)
+                    printf("%s merge lane %d: %g instead of %g\n", name, i, merged.get(i), expected);
+            }
+        }
+    return failures;
+}
+
+// running sums of same-signed lanes outgrow the body range, and mixed signs cancel, against the same sums of
+// the values returned by get(); each addition may truncate a few steps of the mantisa it ends with
+template <typename T, typename Body>
+int checkSums(const char *name) {
+    int failures = 0;
+    for(double sign : {1.0, -1.0}) {
+        T total;
+        std::vector<double> expected(total.size(), 0);
+        for(int round=0;round<12;++round) {
+            std::uniform_real_distribution<double> value(0.5, 1);
+            std::vector<double> lanes(total.size());
+            for(int i=0;i<total.size();++i)
+                lanes[i] = value(rng)*(i%2 ? sign : 1)*(round%3+1);
+            T term(lanes);
+            for(int i=0;i<total.size();++i)
+                expected[i] = round%4==3 ? expected[i]-term.get(i) : expected[i]+term.get(i);
+            total = round%4==3 ? total-term : total+term;
+            double tolerance = (round+1)*4*Body::eps()*total.getMantisa();
+            for(int i=0;i<total.size();++i)
+                if(std::abs(total.get(i)-expected[i])>tolerance && failures++<5)
+                    printf("%s sum %d lane %d: %g instead of %g\n", name, round, i, total.get(i), expected[i]);
+        }
+    }
+    return failures;
+}
+
+// differences of close operands leave bodies far below the body range, which products and roots would truncate
+// away; products must keep a few steps of the largest result, and roots of squares the root of that
+template <typename T, typename Body>
+int checkProducts(const char *name) {
+    int failures = 0;
+    std::uniform_real_distribution<double> value(0.5, 1);
+    std::uniform_real_distribution<double> noise(-0.05, 0.05);
+    for(int round=0;round<10;++round) {
+        std::vector<double> lanes(T().size());
+        std::vector<double> close(lanes.size());
+        for(int i=0;i<lanes.size();++i) {
+            lanes[i] = value(rng);
+            close[i] = lanes[i]+noise(rng);
+        }
+        T x = T(lanes)-T(close);
+        T y = T(close)-T(lanes);
+        T product = x*y;
+        T root = (x*x).sqrt();
+        double largest = 0;
+        for(int i=0;i<x.size();++i)
+            largest = std::max(largest, std::abs(x.get(i)));
+        for(int i=0;i<x.size();++i) {
+            double expected = x.get(i)*y.get(i);
+            if(std::abs(product.get(i)-expected)>4*Body::eps()*largest*largest && failures++<5)
+                printf("%s product lane %d: %g instead of %g\n", name, i, product.get(i), expected);
+            if(std::abs(root.get(i)-std::abs(x.get(i)))>std::sqrt(4*Body::eps())*largest && failures++<5)
+                printf("%s root lane %d: %g instead of %g\n", name, i, root.get(i), std::abs(x.get(i)));
+        }
+    }
+    return failures;
+}
+
+// operands with different mantisas compare after rescaling, so lanes that hold the same value are equal and lanes
+// more than a step of the larger mantisa apart are not
+template <typename T, typename Body>
+int checkEquality(const char *name) {
+    int failures = 0;
+    std::uniform_real_distribution<double> value(-1, 1);
+    for(int round=0;round<10;++round) {
+        std::vector<double> lanes(T().size());
+        for(double &lane : lanes)
+            lane = value(rng);
+        T x(lanes);
+        for(int i=0;i<x.size();++i)
+            lanes[i] = i%3 ? x.get(i) : value(rng);
+        lanes[1] = 4;
+        T y(lanes);
+        double step = Body::num_params()*Body::eps()*y.getMantisa();
+        VECTOR equal = x==y;
+        VECTOR reversed = y==x;
+        for(int i=0;i<x.size();++i) {
+            bool same = x.get(i)==y.get(i);
+            bool apart = std::abs(x.get(i)-y.get(i))>step;
+            if(((same && !GETAT(equal, i)) || (apart && GETAT(equal, i))) && failures++<5)
+                printf("%s lane %d: %g==%g is %d\n", name, i, x.get(i), y.get(i), (int)GETAT(equal, i));
+            if(GETAT(equal, i)!=GETAT(reversed, i) && failures++<5)
+                printf("%s lane %d: equality of %g and %g depends on the order\n", name, i, x.get(i), y.get(i));
+        }
+    }
+    return failures;
+}
+
+template <typename T, typename Body>
+int check(const char *name) {
+    int failures = 0;
+    failures += checkMerge<T, Body>(name);
+    failures += checkSums<T, Body>(name);
+    failures += checkProducts<T, Body>(name);
+    failures += checkEquality<T, Body>(name);
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += check<dfloat7, sfloat6>("dfloat7");
+    failures += check<dfloat8, sfloat7>("dfloat8");
+    failures += check<dfloat9, sfloat8>("dfloat9");
+    failures += check<dfloat10, sfloat9>("dfloat10");
+    return failures ? 1 : 0;
+}
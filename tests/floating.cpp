@@ -0,0 +1,247 @@
+#include "../tensorless/types/all.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// Floating reductions and arithmetic against the values returned by get(), on random lanes whose
+// exponents span the whole mantisa range.
+
+using namespace tensorless;
+
+std::mt19937_64 rng(11);
+
+template <typename T>
+T randomLanes() {
+    int minExponent = (int)T::inf()==0 ? 0 : -(int)std::log2(-T::inf());
+    int maxExponent = (int)std::log2(T::sup());
+    std::uniform_int_distribution<int> exponent(minExponent-4, maxExponent);
+    std::uniform_real_distribution<double> significand(0.5, 1);
+    T ret;
+    for(int i=0;i<ret.size();++i)
+        ret.set(i, i%13==0 ? 0 : significand(rng)*std::ldexp(1, exponent(rng))*(rng()%2 ? -1 : 1));
+    return ret;
+}
+
+// lanes with different mantisas are summed at their own scale
+template <typename T>
+int checkSums(const char *name) {
+    int failures = 0;
+    for(int round=0;round<100;++round) {
+        T x = randomLanes<T>();
+        VECTOR mask = lrand();
+        double expected = 0;
+        double expectedMasked = 0;
+        for(int i=0;i<x.size();++i) {
+            expected += x.get(i);
+            if(GETAT(mask, i))
+                expectedMasked += x.get(i);
+        }
+        if((x.sum()!=expected || x.sum(mask)!=expectedMasked) && failures++<5)
+            printf("%s sum: %g instead of %g, masked %g instead of %g\n", name, x.sum(), expected, x.sum(mask), expectedMasked);
+    }
+    return failures;
+}
+
+// one step of the body at the lane's exponent
+template <typename T>
+double ulp(const T &x, int i) {
+    typedef decltype(x.getBody()) Body;
+    return std::ldexp(Body::eps(), (int)x.getMantisa().get(i));
+}
+
+// results are renormalized, so chains of operations whose exact results stay in range lose at most the lowest
+// body bit once instead of one bit per operation; lanes next to the mantisa limits are skipped
+template <typename T>
+int checkChains(const char *name) {
+    typedef decltype(T().getMantisa()) Mantisa;
+    int failures = 0;
+    for(int round=0;round<20;++round) {
+        T x = randomLanes<T>();
+        T sum = x;
+        T product = x;
+        for(int step=0;step<8;++step) {
+            sum = (sum+x)-x;
+            product = (product*T::broadcast(0.5)).times2();
+        }
+        for(int i=0;i<x.size();++i) {
+            int mantisa = (int)x.getMantisa().get(i);
+            if(mantisa<=(int)Mantisa::inf()+1 || mantisa>=(int)Mantisa::sup()-1)
+                continue;
+            double tolerance = 2*ulp(x, i);
+            if((std::abs(sum.get(i)-x.get(i))>tolerance || std::abs(product.get(i)-x.get(i))>tolerance) && failures++<5)
+                printf("%s lane %d: %g drifts to %g after 8 (x+y)-y and to %g after 8 (x*0.5)*2\n",
+                       name, i, x.get(i), sum.get(i), product.get(i));
+        }
+    }
+    return failures;
+}
+
+// sums and differences of lanes of either sign are within two body steps of the larger operand, and products
+// within the error of the truncating body product, eight body steps at the sum of the exponents, for lanes
+// whose exponents and their differences stay away from the mantisa limits
+template <typename T>
+int checkArithmetic(const char *name) {
+    typedef decltype(T().getMantisa()) Mantisa;
+    int failures = 0;
+    for(int round=0;round<20;++round) {
+        // broadcasts and results of other operations have larger bodies than set() writes
+        T x = randomLanes<T>();
+        T y = round%2 ? randomLanes<T>() : T::broadcast(randomLanes<T>().get(round));
+        T sum = x+y;
+        T difference = x-y;
+        T product = x*y;
+        for(int i=0;i<x.size();++i) {
+            int mantisas[2] = {(int)x.getMantisa().get(i), (int)y.getMantisa().get(i)};
+            if(std::min(mantisas[0], mantisas[1])<=(int)Mantisa::inf()+1 || std::max(mantisas[0], mantisas[1])>=(int)Mantisa::sup()-1
+               || std::abs(mantisas[0]-mantisas[1])>(int)Mantisa::sup() || std::abs(mantisas[0]+mantisas[1])>=(int)Mantisa::sup())
+                continue;
+            double a = x.get(i);
+            double b = y.get(i);
+            double tolerance = 2*std::max(ulp(x, i), ulp(y, i));
+            if(std::abs(sum.get(i)-(a+b))>tolerance && failures++<5)
+                printf("%s lane %d: %g+%g gives %g\n", name, i, a, b, sum.get(i));
+            if(std::abs(difference.get(i)-(a-b))>tolerance && failures++<5)
+                printf("%s lane %d: %g-%g gives %g\n", name, i, a, b, difference.get(i));
+            if(std::abs(product.get(i)-a*b)>8*ulp(x, i)*std::ldexp(1, mantisas[1]) && failures++<5)
+                printf("%s lane %d: %g*%g gives %g\n", name, i, a, b, product.get(i));
+        }
+    }
+    return failures;
+}
+
+// mantisas further apart than the mantisa range are aligned in two steps, and zeros left by cancellations keep
+// the mantisa of their operands without shifting away the bodies they are added to
+template <typename T>
+int checkAlignment(const char *name) {
+    typedef decltype(T().getMantisa()) Mantisa;
+    int failures = 0;
+    T large = T::broadcast(T::sup()/4);
+    T zero = large-large;
+    for(int round=0;round<20;++round) {
+        T x = randomLanes<T>();
+        T y = randomLanes<T>();
+        T sum = x+y;
+        T difference = x-y;
+        T sums[4] = {x+zero, zero+x, x-zero, zero-x};
+        for(int i=0;i<x.size();++i) {
+            double a = x.get(i);
+            double b = y.get(i);
+            double cancelled[4] = {a, a, a, -a};
+            for(int k=0;k<4;++k)
+                if(sums[k].get(i)!=cancelled[k] && failures++<5)
+                    printf("%s lane %d: %g with a cancelled zero gives %g\n", name, i, a, sums[k].get(i));
+            if(std::max(x.getMantisa().get(i), y.getMantisa().get(i))>=Mantisa::sup()-1)
+                continue;
+            double tolerance = 2*std::max(ulp(x, i), ulp(y, i));
+            if(std::abs(sum.get(i)-(a+b))>tolerance && failures++<5)
+                printf("%s lane %d: %g+%g gives %g\n", name, i, a, b, sum.get(i));
+            if(std::abs(difference.get(i)-(a-b))>tolerance && failures++<5)
+                printf("%s lane %d: %g-%g gives %g\n", name, i, a, b, difference.get(i));
+        }
+    }
+    return failures;
+}
+
+// constant multiplies start from fully normalized bodies, so small bodies keep their bits through the right
+// shifts of shift-and-add and results are relative to the product
+template <typename T>
+int checkScale(const char *name) {
+    typedef decltype(T().getBody()) Body;
+    typedef decltype(T().getMantisa()) Mantisa;
+    int failures = 0;
+    for(double factor : {23.07, -0.3, 0.7212, 3.0}) {
+        T x = randomLanes<T>();
+        T scaled = x.scale(factor);
+        int exponent = (int)std::ceil(std::log2(std::abs(factor)));
+        for(int i=0;i<x.size();++i) {
+            int mantisa = (int)x.getMantisa().get(i);
+            if(mantisa<=(int)Mantisa::inf()+Body::num_params() || mantisa+exponent>=(int)Mantisa::sup()-1)
+                continue;
+            double expected = x.get(i)*factor;
+            double tolerance = 8*Body::eps()/std::min(1.0, (double)Body::sup())*std::abs(expected);
+            if(std::abs(scaled.get(i)-expected)>tolerance && failures++<5)
+                printf("%s lane %d: %g scaled by %g gives %g\n", name, i, x.get(i), factor, scaled.get(i));
+        }
+    }
+    return failures;
+}
+
+// constant multiplies whose results leave the mantisa range saturate, or round to the lowest mantisa, where
+// they change the values they are added to by at most the step of those values; lanes whose normalized
+// bodies reach the lowest mantisa have fewer bits than the body, which large factors magnify
+template <typename T>
+int checkScaleLimits(const char *name) {
+    typedef decltype(T().getBody()) Body;
+    typedef decltype(T().getMantisa()) Mantisa;
+    int failures = 0;
+    double step = 2*Body::eps()/std::min(1.0, (double)Body::sup());
+    for(double factor : {1.0/1000, 1.0/64, 64.0, 1000.0}) {
+        T x = randomLanes<T>();
+        T scaled = x.scale(factor);
+        T shifted = T::broadcast(0.5)+scaled;
+        for(int i=0;i<x.size();++i) {
+            if(x.getMantisa().get(i)<=Mantisa::inf()+1)
+                continue;
+            double expected = x.get(i)*factor;
+            if(std::abs(expected)>T::sup() && (scaled.get(i)*expected<=0 || std::abs(scaled.get(i))<T::sup()/2) && failures++<5)
+                printf("%s lane %d: %g scaled by %g gives %g instead of saturating\n", name, i, x.get(i), factor, scaled.get(i));
+            if(std::abs(expected)<T::sup()/2 && std::abs(shifted.get(i)-0.5-expected)>step*0.5+4*step*std::abs(expected) && failures++<5)
+                printf("%s lane %d: 0.5 plus %g scaled by %g gives %g\n", name, i, x.get(i), factor, shifted.get(i));
+        }
+    }
+    return failures;
+}
+
+// exponents beyond the mantisa range are clamped, so tiny broadcasts round instead of throwing
+template <typename T>
+int checkBroadcast(const char *name) {
+    typedef decltype(T().getBody()) Body;
+    typedef decltype(T().getMantisa()) Mantisa;
+    int failures = 0;
+    int minExponent = (int)Mantisa::inf();
+    int maxExponent = (int)std::log2(T::sup());
+    for(int exponent=minExponent-6;exponent<=maxExponent;++exponent)
+        for(double value : {0.75, -0.75, 0.5, -1.0}) {
+            value = std::ldexp(value, exponent);
+            if(std::abs(value)>T::sup())
+                continue;
+            try {
+                double result = T::broadcast(value).get(0);
+                double tolerance = 2*Body::eps()*std::ldexp(1, std::max(exponent, minExponent));
+                if(std::abs(result-value)>tolerance && failures++<5)
+                    printf("%s broadcast: %g instead of %g\n", name, result, value);
+            }
+            catch(const std::exception &e) {
+                if(failures++<5)
+                    printf("%s broadcast of %g: %s\n", name, value, e.what());
+            }
+        }
+    return failures;
+}
+
+template <typename T>
+int check(const char *name) {
+    int failures = 0;
+    failures += checkSums<T>(name);
+    failures += checkChains<T>(name);
+    failures += checkArithmetic<T>(name);
+    failures += checkAlignment<T>(name);
+    failures += checkScale<T>(name);
+    failures += checkScaleLimits<T>(name);
+    failures += checkBroadcast<T>(name);
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += check<float7>("float7");
+    failures += check<float8>("float8");
+    failures += check<float9>("float9");
+    failures += check<float10>("float10");
+    failures += check<float11>("float11");
+    failures += check<float12>("float12");
+    failures += check<float13>("float13");
+    failures += check<float15>("float15");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+#include "../tensorless/types/all.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+
+// gemm against double sums of the products of the values returned by get(), for shapes that are not multiples
+// of the micro-kernel, the output tiles, the packed lanes or GEMM_BLOCK_DEPTH blocks. Plane weights and the
+// mantisas of Dynamic blocks are powers of two, so every partial sum is exact in double and the products must
+// match whatever order they are summed in.
+
+using namespace tensorless;
+
+std::mt19937_64 rng(53);
+
+// Dynamic blocks get mantisas from 1/4 to 4, so that the per-block scales differ within a row
+template <typename Type>
+void rescale(PackedMatrix<Type> &matrix) {
+}
+
+template <typename Number>
+void rescale(PackedMatrix<Dynamic<Number>> &matrix) {
+    std::uniform_int_distribution<int> exponent(-2, 2);
+    for(int row=0;row<matrix.rows();++row)
+        for(int block=0;block<matrix.blocks();++block)
+            matrix.block(row, block) = matrix.block(row, block).scale(std::ldexp(1.0, exponent(rng)));
+}
+
+template <typename TypeA, typename TypeB>
+int compare(const char *name, int rowsA, int rowsB, int cols) {
+    PackedMatrix<TypeA> a = PackedMatrix<TypeA>::random(rowsA, cols);
+    PackedMatrix<TypeB> b = PackedMatrix<TypeB>::random(rowsB, cols);
+    rescale(a);
+    rescale(b);
+    std::vector<double> out = gemm(a, b);
+    int failures = 0;
+    if(out.size()!=(size_t)rowsA*rowsB && failures++<5)
+        printf("%s %dx%d times %dx%d: %zu outputs\n", name, rowsA, cols, cols, rowsB, out.size());
+    for(int i=0;i<rowsA;++i)
+        for(int j=0;j<rowsB;++j) {
+            double expected = 0;
+            for(int k=0;k<cols;++k)
+                expected += a.get(i, k)*b.get(j, k);
+            if(out[(size_t)i*rowsB+j]!=expected && failures++<5)
+                printf("%s %dx%d times %dx%d output (%d,%d): %g instead of %g\n", name, rowsA, cols, cols, rowsB,
+                       i, j, out[(size_t)i*rowsB+j], expected);
+        }
+    return failures;
+}
+
+template <typename TypeA, typename TypeB>
+int check(const char *name) {
+    int lanes = PackedMatrix<TypeA>::lanes();
+    int failures = 0;
+    failures += compare<TypeA, TypeB>(name, 1, 1, 1);
+    failures += compare<TypeA, TypeB>(name, 3, 5, lanes-1);
+    failures += compare<TypeA, TypeB>(name, 33, 31, lanes+1);
+    failures += compare<TypeA, TypeB>(name, GEMM_TILE+5, 2*GEMM_TILE+1, 2*lanes+44);
+    failures += compare<TypeA, TypeB>(name, 5, 3, (GEMM_BLOCK_DEPTH+1)*lanes+7);
+    failures += compare<TypeA, TypeB>(name, 0, 7, lanes);
+    try {
+        gemm(PackedMatrix<TypeA>(2, lanes), PackedMatrix<TypeB>(2, lanes+1));
+        if(failures++<5)
+            printf("%s: no error for different numbers of columns\n", name);
+    }
+    catch(const std::logic_error &e) {
+    }
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += check<int5, int5>("int5");
+    failures += check<sfloat9, sfloat9>("sfloat9");
+    failures += check<dfloat10, dfloat10>("dfloat10");
+    failures += check<sfloat9, int3>("sfloat9 times int3");
+    failures += check<dfloat6, sfloat5>("dfloat6 times sfloat5");
+    return failures ? 1 : 0;
+}
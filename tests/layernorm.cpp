@@ -0,0 +1,67 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+// LayerNorm forward against a double layer norm of the values returned by get(), clamped to the range of the
+// type, for spreads whose normalization factor is well above one and inputs with one outlier, whose normalized
+// value exceeds two. Backward must run on the same inputs.
+
+using namespace tensorless;
+
+template <typename T, int size>
+int check(const char *name, double spread, double outlier) {
+    LayerNorm<T, size> norm;
+    T input;
+    for(int i=0;i<size;++i)
+        input.set(i, 0.1+spread*std::sin(i*2.1));
+    input.set(size/2, outlier);
+    double mean = 0;
+    for(int i=0;i<size;++i)
+        mean += input.get(i);
+    mean /= size;
+    double variance = 0;
+    for(int i=0;i<size;++i)
+        variance += (input.get(i)-mean)*(input.get(i)-mean);
+    variance /= size;
+    int failures = 0;
+    try {
+        T output = norm.forward(input);
+        for(int i=0;i<size;++i) {
+            double expected = (input.get(i)-mean)/std::sqrt(variance+0.001);
+            expected = std::max((double)T::inf(), std::min((double)T::sup(), expected));
+            // inputs and the broadcast mean are quantized, and the normalization factor magnifies that; squares
+            // truncate small lanes, which leaves a relative error in the normalization factor
+            if(std::abs(output.get(i)-expected)>0.1+0.05*std::abs(expected) && failures++<5)
+                printf("%s spread %g outlier %g lane %d: %g instead of %g\n", name, spread, outlier, i, output.get(i), expected);
+        }
+        SGD<T> optimizer(0.01);
+        norm.backward(output, optimizer);
+    }
+    catch(const std::exception &e) {
+        printf("%s: %s\n", name, e.what());
+        failures++;
+    }
+    return failures;
+}
+
+template <typename T>
+int check(const char *name) {
+    int failures = 0;
+    for(double spread : {0.2, 0.5})
+        for(double outlier : {0.1, 0.9, -0.9}) {
+            failures += check<T, 8>(name, spread, outlier);
+            failures += check<T, 16>(name, spread/4, outlier);
+        }
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += check<sfloat9>("sfloat9");
+    failures += check<dfloat10>("dfloat10");
+    failures += check<float12>("float12");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,67 @@
+#include <cstdlib>
+#include "../tensorless/types/all.h"
+#include <cmath>
+#include <cstdio>
+
+// Lookup tables against the tabulated function on every representable value, where lanes cycle through all
+// plane encodings. Tables are applied from several pool threads at once, each with its own node slots.
+
+using namespace tensorless;
+
+template <typename T>
+T everyEncoding(int offset) {
+    VECTOR planes[MAX_ARITHMETIC_PLANES];
+    for(int j=0;j<T::num_params();++j) {
+        planes[j] = 0;
+        for(int i=0;i<T().size();++i)
+            if(((i+offset)>>j)&1)
+                planes[j] |= ONEHOT(i);
+    }
+    return T::fromPlanes(planes);
+}
+
+template <typename T, typename Function>
+int checkFunction(const char *name, const char *function, Function f) {
+    Lut<T> lut = Lut<T>::fromFunction(f);
+    int encodings = 1<<T::num_params();
+    int lanes = T().size();
+    std::vector<int> failures(encodings/lanes+1);
+    ThreadPool::global().parallelFor(0, failures.size(), [&](int begin, int end) {
+        for(int block=begin;block<end;++block) {
+            T x = everyEncoding<T>(block*lanes);
+            T y = lut(x);
+            for(int i=0;i<lanes;++i) {
+                T expected;
+                expected.set(0, std::max(T::inf(), std::min(T::sup(), f(x.get(i)))));
+                if(y.get(i)!=expected.get(0))
+                    failures[block]++;
+            }
+        }
+    });
+    int total = 0;
+    for(int count : failures)
+        total += count;
+    if(total)
+        printf("%s %s: %d lanes differ from the tabulated values (%d nodes)\n", name, function, total, lut.num_nodes());
+    return total;
+}
+
+template <typename T>
+int check(const char *name) {
+    int failures = 0;
+    failures += checkFunction<T>(name, "exp", [](double x) {return std::exp(x);});
+    failures += checkFunction<T>(name, "square", [](double x) {return x*x;});
+    failures += checkFunction<T>(name, "negate", [](double x) {return -x;});
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    setenv("TENSORLESS_THREADS", "4", 0);
+    int failures = 0;
+    failures += check<int5>("int5");
+    failures += check<sfloat6>("sfloat6");
+    failures += check<sfloat9>("sfloat9");
+    failures += check<float8>("float8");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <algorithm>
+
+// MixedDense outputs against its biases plus its weights times the input values returned by get(), before and
+// after training, and the packed requantization of master weights against rounding their values to the nearest
+// step of the weight type. Weights beyond the input lanes must stay zero. Floating activations are not supported
+// by the dot kernel.
+
+using namespace tensorless;
+
+#define INS 48
+#define OUTS 100
+
+std::mt19937_64 rng(41);
+
+template <typename T>
+T randomInput() {
+    std::uniform_real_distribution<double> value(-0.5, 0.5);
+    T ret;
+    for(int j=0;j<INS;++j)
+        ret.set(j, value(rng));
+    return ret;
+}
+
+// the dot kernel sums exact products of lanes, so setting the same sums in the same order must reproduce the
+// output exactly
+template <typename T, typename Layer>
+int compare(const char *name, const char *stage, Layer &layer, const T &input) {
+    int failures = 0;
+    T output = layer.forward(input);
+    T expected;
+    for(int i=0;i<OUTS;++i) {
+        double sum = layer.bias(i);
+        for(int j=0;j<INS;++j)
+            sum += layer.weight(i, j)*input.get(j);
+        if(sum>0) // relu
+            expected.set(i, sum);
+        for(int j=INS;j<output.size();++j)
+            if(layer.weight(i, j)!=0 && failures++<5)
+                printf("%s output %d %s: weight %g beyond the inputs\n", name, i, stage, layer.weight(i, j));
+    }
+    for(int i=0;i<OUTS;++i)
+        if(output.get(i)!=expected.get(i) && failures++<5)
+            printf("%s output %d %s: %g instead of %g\n", name, i, stage, output.get(i), expected.get(i));
+    return failures;
+}
+
+// values are clipped to the symmetric range of the weights and rounded to their step, where the arithmetic of
+// the source may move ties by one of its own steps
+template <typename WeightT, typename ActT>
+int checkRequantize(const char *name, double step, double sourceStep) {
+    int failures = 0;
+    std::uniform_real_distribution<double> value(-1.2*WeightT::sup(), 1.2*WeightT::sup());
+    double limit = std::min((double)ActT::sup(), 2.0);
+    for(int round=0;round<20;++round) {
+        ActT master;
+        for(int i=0;i<master.size();++i)
+            master.set(i, std::max(-limit, std::min(limit, value(rng))));
+        VECTOR mask = lrand();
+        WeightT weights = requantize<WeightT>(master, mask);
+        for(int i=0;i<master.size();++i) {
+            double clipped = std::max(-(double)WeightT::sup(), std::min((double)WeightT::sup(), master.get(i)));
+            double expected = GETAT(mask, i) ? clipped : 0;
+            if(std::abs(weights.get(i)-expected)>step/2+sourceStep*std::abs(master.get(i)) && failures++<5)
+                printf("%s requantize lane %d: %g to %g instead of %g\n", name, i, master.get(i), weights.get(i), expected);
+        }
+    }
+    return failures;
+}
+
+template <typename WeightT, typename ActT>
+int check(const char *name, double step, double sourceStep) {
+    int failures = 0;
+    MixedDense<WeightT, ActT, INS, OUTS> layer;
+    ActT input = randomInput<ActT>();
+    failures += compare(name, "before training", layer, input);
+    SGD<ActT> optimizer(0.5);
+    ActT error = randomInput<ActT>();
+    for(int step=0;step<5;++step) {
+        layer.forward(input);
+        layer.backward(error, optimizer);
+    }
+    failures += compare(name, "after training", layer, input);
+    failures += compare(name, "on new inputs", layer, randomInput<ActT>());
+    failures += checkRequantize<WeightT, ActT>(name, step, sourceStep);
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += check<sfloat5, sfloat9>("sfloat5 weights, sfloat9", 0.125, 0);
+    failures += check<sfloat4, sfloat9>("sfloat4 weights, sfloat9", 0.25, 0);
+    failures += check<sfloat5, dfloat10>("sfloat5 weights, dfloat10", 0.125, sfloat9::eps());
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,111 @@
+#include "../tensorless/types/all.h"
+#include <cmath>
+#include <cstdio>
+
+// Raw unsigned types against exact arithmetic on the values returned by get().
+
+using namespace tensorless;
+
+template <typename T>
+int levels() {
+    return (int)std::lround(T::sup()/T::eps())+1;
+}
+
+// lanes cycle through every representable value, starting from the offset-th one
+template <typename T>
+T everyValue(int offset=0) {
+    T ret;
+    for(int i=0;i<ret.size();++i)
+        ret.set(i, ((i+offset)%levels<T>())*T::eps());
+    return ret;
+}
+
+// get, sum, absmax and eps read values on the same scale that set and broadcast write them
+template <typename T>
+int checkScale(const char *name) {
+    int failures = 0;
+    T x = everyValue<T>();
+    double sum = 0;
+    double absmax = 0;
+    for(int i=0;i<x.size();++i) {
+        double expected = (i%levels<T>())*T::eps();
+        sum += expected;
+        absmax = std::max(absmax, expected);
+        if((x.get(i)!=expected || T::broadcast(expected).get(i)!=expected) && failures++<5)
+            printf("%s lane %d: reads %g (broadcast %g) instead of %g\n", name, i, x.get(i), T::broadcast(expected).get(i), expected);
+    }
+    if((x.sum()!=sum || x.absmax()!=absmax || (levels<T>()-1)*T::eps()!=T::sup()) && failures++<5)
+        printf("%s: sum %g instead of %g, absmax %g instead of %g\n", name, x.sum(), sum, x.absmax(), absmax);
+    return failures;
+}
+
+// products of [0,1) types truncate each partial product, so they stay below the exact product by less
+// than one eps per plane
+template <typename T>
+int checkProducts(const char *name) {
+    int failures = 0;
+    for(int offset=0;offset<levels<T>();++offset) {
+        T x = everyValue<T>();
+        T y = everyValue<T>(offset);
+        T product = x*y;
+        T inplace = x;
+        inplace *= y;
+        for(int i=0;i<x.size();++i) {
+            double exact = x.get(i)*y.get(i);
+            double error = exact-product.get(i);
+            if((error<0 || error>=T::num_params()*T::eps() || inplace.get(i)!=product.get(i)) && failures++<5)
+                printf("%s lane %d: %g*%g gives %g (in place %g)\n", name, i, x.get(i), y.get(i), product.get(i), inplace.get(i));
+        }
+    }
+    return failures;
+}
+
+// applyHalf divides a number by two to the power of each lane's integer
+template <typename T>
+int checkApplyHalf(const char *name) {
+    int failures = 0;
+    T shifts;
+    for(int i=0;i<shifts.size();++i)
+        shifts.set(i, i%(T::sup()+1));
+    Float8 number = Float8::broadcast(Float8::sup());
+    VECTOR mask = 0;
+    for(int i=0;i<shifts.size();i+=3)
+        mask |= ONEHOT(i);
+    Float8 halved = shifts.applyHalf(number);
+    Float8 maskedHalved = shifts.applyHalf(number, mask);
+    for(int i=0;i<shifts.size();++i) {
+        double expected = std::floor(Float8::sup()/Float8::eps()/(1<<shifts.get(i)))*Float8::eps();
+        double expectedMasked = i%3 ? Float8::sup() : expected;
+        if((halved.get(i)!=expected || maskedHalved.get(i)!=expectedMasked) && failures++<5)
+            printf("%s lane %d: halving %d times gives %g (masked %g) instead of %g\n",
+                   name, i, shifts.get(i), halved.get(i), maskedHalved.get(i), expected);
+    }
+    return failures;
+}
+
+template <typename T>
+int checkInteger(const char *name) {
+    int failures = 0;
+    failures += checkApplyHalf<T>(name);
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+template <typename T>
+int check(const char *name) {
+    int failures = 0;
+    failures += checkScale<T>(name);
+    failures += checkProducts<T>(name);
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += checkInteger<Int2>("Int2");
+    failures += checkInteger<Int3>("Int3");
+    failures += checkInteger<Int4>("Int4");
+    failures += check<Float6>("Float6");
+    failures += check<Float7>("Float7");
+    return failures ? 1 : 0;
+}
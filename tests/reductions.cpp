@@ -0,0 +1,80 @@
+#include <cstdlib>
+#include "../tensorless/types/all.h"
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+
+// Multi-block argmax, max and topk against a scan of the values returned by get(). Vectors of blocks both
+// below and above REDUCTIONS_PARALLEL_BLOCKS are checked, the latter on a pool of several threads, and no blocks
+// at all must throw instead of reading past the vector.
+
+using namespace tensorless;
+
+std::mt19937_64 rng(19);
+
+template <typename T>
+std::vector<T> randomBlocks(int count, double step) {
+    // few distinct values, so that ties between blocks are common
+    std::uniform_int_distribution<int> value(-8, 8);
+    std::vector<T> blocks(count);
+    for(T &block : blocks)
+        for(int i=0;i<block.size();++i)
+            block.set(i, value(rng)*step);
+    return blocks;
+}
+
+template <typename T>
+int checkBlocks(const char *name, int count, double step) {
+    int failures = 0;
+    std::vector<T> blocks = randomBlocks<T>(count, step);
+    int size = blocks[0].size();
+    // the first position of each value in descending order
+    std::vector<std::pair<double, long>> lanes;
+    for(long pos=0;pos<(long)count*size;++pos)
+        lanes.push_back(std::make_pair(-blocks[pos/size].get(pos%size), pos));
+    std::stable_sort(lanes.begin(), lanes.end(), [](const std::pair<double, long> &a, const std::pair<double, long> &b) {
+        return a.first<b.first;
+    });
+    long pos = argmax(blocks);
+    if((pos!=lanes[0].second || max(blocks)!=-lanes[0].first) && failures++<5)
+        printf("%s %d blocks: argmax %ld instead of %ld\n", name, count, pos, lanes[0].second);
+    std::vector<long> top = topk(blocks, 10);
+    for(int i=0;i<10;++i)
+        if(blocks[top[i]/size].get(top[i]%size)!=-lanes[i].first && failures++<5)
+            printf("%s %d blocks: top %d is %g instead of %g\n", name, count, i, blocks[top[i]/size].get(top[i]%size), -lanes[i].first);
+    return failures;
+}
+
+template <typename T>
+int checkEmpty(const char *name) {
+    int failures = 0;
+    std::vector<T> blocks;
+    try {
+        max(blocks);
+        if(failures++<5)
+            printf("%s: max of no blocks did not throw\n", name);
+    }
+    catch(const std::logic_error &) {}
+    if(!topk(blocks, 3).empty() && failures++<5)
+        printf("%s: top-k of no blocks is not empty\n", name);
+    return failures;
+}
+
+template <typename T>
+int check(const char *name, double step) {
+    int failures = 0;
+    failures += checkBlocks<T>(name, 3, step);
+    failures += checkBlocks<T>(name, 4*REDUCTIONS_PARALLEL_BLOCKS+5, step);
+    failures += checkEmpty<T>(name);
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    setenv("TENSORLESS_THREADS", "4", 0);
+    int failures = 0;
+    failures += check<sfloat9>("sfloat9", 1.0/16);
+    failures += check<int5>("int5", 1);
+    failures += check<float12>("float12", 1.0/16);
+    return failures ? 1 : 0;
+}
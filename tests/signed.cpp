@@ -0,0 +1,154 @@
+#include "../tensorless/types/all.h"
+#include <cmath>
+#include <cstdio>
+
+// Signed lanes against exact arithmetic on the values returned by get(). Lanes cycle through every
+// representable value, from the most negative one -sup()-eps() up to sup().
+
+using namespace tensorless;
+
+template <typename T>
+T everyValue(int offset=0) {
+    int levels = (int)std::lround(2*(T::sup()+T::eps())/T::eps());
+    T ret;
+    for(int i=0;i<ret.size();++i)
+        ret.set(i, ((i+offset)%levels)*T::eps()-T::sup()-T::eps());
+    return ret;
+}
+
+template <typename T>
+int expect(const char *name, const char *what, const T &result, int lane, double expected, int &failures) {
+    if(result.get(lane)!=expected && failures++<5)
+        printf("%s %s lane %d: %g instead of %g\n", name, what, lane, result.get(lane), expected);
+    return failures;
+}
+
+// half, quarter and eighth are arithmetic right shifts, so they round towards minus infinity
+template <typename T>
+int checkShifts(const char *name) {
+    int failures = 0;
+    T x = everyValue<T>();
+    T half = x.half();
+    T quarter = x.quarter();
+    T eighth = x.eighth();
+    VECTOR mask = 0;
+    for(int i=0;i<x.size();i+=2)
+        mask |= ONEHOT(i);
+    T maskedHalf = x.half(mask);
+    for(int i=0;i<x.size();++i) {
+        double steps = x.get(i)/T::eps();
+        expect(name, "half", half, i, std::floor(steps/2)*T::eps(), failures);
+        expect(name, "quarter", quarter, i, std::floor(steps/4)*T::eps(), failures);
+        expect(name, "eighth", eighth, i, std::floor(steps/8)*T::eps(), failures);
+        expect(name, "masked half", maskedHalf, i, i%2 ? x.get(i) : std::floor(steps/2)*T::eps(), failures);
+    }
+    return failures;
+}
+
+// zeroed lanes and products with zero must also clear the sign plane, or they read back as -sup()-eps()
+template <typename T>
+int checkZeros(const char *name) {
+    int failures = 0;
+    T x = everyValue<T>();
+    VECTOR mask = 0;
+    for(int i=0;i<x.size();i+=3)
+        mask |= ONEHOT(i);
+    T zeroed = x.zerolike(mask);
+    T relu = x.relu();
+    T product = x*T();
+    T reversed = T()*x;
+    for(int i=0;i<x.size();++i) {
+        expect(name, "zerolike", zeroed, i, i%3 ? x.get(i) : 0, failures);
+        expect(name, "relu", relu, i, std::max(x.get(i), 0.0), failures);
+        expect(name, "x*0", product, i, 0, failures);
+        expect(name, "0*x", reversed, i, 0, failures);
+    }
+    if(zeroed.sum()!=x.sum(~mask) && failures++<5)
+        printf("%s zerolike sum: %g instead of %g\n", name, zeroed.sum(), x.sum(~mask));
+    return failures;
+}
+
+// broadcasts reach every representable value, including -sup()-eps() which has no positive counterpart
+template <typename T>
+int checkBroadcast(const char *name) {
+    int failures = 0;
+    T x = everyValue<T>();
+    for(int i=0;i<x.size();++i)
+        expect(name, "broadcast", T::broadcast(x.get(i)), i, x.get(i), failures);
+    return failures;
+}
+
+// the most negative value has no positive counterpart, so its magnitude saturates to sup()
+template <typename T>
+int checkAbs(const char *name) {
+    int failures = 0;
+    T x = everyValue<T>();
+    auto abs = x.abs();
+    T product = x*T::broadcast(std::min(1.0, T::sup()));
+    for(int i=0;i<x.size();++i) {
+        double expected = std::min(std::abs(x.get(i)), T::sup());
+        if(abs.get(i)!=expected && failures++<5)
+            printf("%s abs lane %d: %g instead of %g\n", name, i, (double)abs.get(i), expected);
+        if(x.get(i)<-T::sup() && product.get(i)>=0 && failures++<5)
+            printf("%s product lane %d: %g from %g\n", name, i, product.get(i), x.get(i));
+    }
+    return failures;
+}
+
+// shift-and-add products are within one step per signed digit of the exact product of the factor rounded to
+// eps(), and products beyond the range saturate to the bound with their own sign instead of wrapping
+template <typename T>
+int checkScale(const char *name) {
+    int failures = 0;
+    T x = everyValue<T>();
+    for(double factor : {0.75, -0.75, 0.9, 1.5, -1.5, 2.7, 3.0, 5.0, -5.0, 31.6}) {
+        double rounded = std::round(factor/T::eps())*T::eps();
+        int steps = signedDigits<T>(factor).count;
+        T product = x.scale(factor);
+        for(int i=0;i<x.size();++i) {
+            double expected = std::max(-T::sup(), std::min(T::sup(), std::max(x.get(i), -T::sup())*rounded));
+            if(std::abs(product.get(i)-expected)>steps*T::eps() && failures++<5)
+                printf("%s %g*%g lane %d: %g instead of %g\n", name, x.get(i), factor, i, product.get(i), expected);
+        }
+    }
+    T tripled = x.template mul_const<3>();
+    for(int i=0;i<x.size();++i)
+        expect(name, "mul_const<3>", tripled, i, std::max(-T::sup(), std::min(T::sup(), std::max(x.get(i), -T::sup())*3)), failures);
+    return failures;
+}
+
+template <typename T>
+int checkInteger(const char *name) {
+    int failures = 0;
+    failures += checkZeros<T>(name);
+    failures += checkBroadcast<T>(name);
+    failures += checkAbs<T>(name);
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+template <typename T>
+int check(const char *name) {
+    int failures = 0;
+    failures += checkShifts<T>(name);
+    failures += checkZeros<T>(name);
+    failures += checkBroadcast<T>(name);
+    failures += checkAbs<T>(name);
+    failures += checkScale<T>(name);
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += checkInteger<int3>("int3");
+    failures += checkInteger<int4>("int4");
+    failures += checkInteger<int5>("int5");
+    failures += check<sfloat4>("sfloat4");
+    failures += check<sfloat5>("sfloat5");
+    failures += check<sfloat6>("sfloat6");
+    failures += check<sfloat7>("sfloat7");
+    failures += check<sfloat8>("sfloat8");
+    failures += check<sfloat9>("sfloat9");
+    return failures ? 1 : 0;
+}
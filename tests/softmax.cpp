@@ -0,0 +1,82 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <algorithm>
+
+// Softmax forward against a double softmax of the values returned by get(), lane by lane and for the sum of
+// the outputs. Tolerances are steps of the body near one: exponents are looked up on scores one step apart,
+// which Dynamic bodies stretch over SOFTMAX_RANGE, and each probability is rounded to a step.
+
+using namespace tensorless;
+
+std::mt19937_64 rng(37);
+
+template <typename T, typename Body, int size>
+int compare(const char *name, double spread) {
+    std::normal_distribution<double> value(0, spread);
+    double limit = std::min(1.9, (double)T::sup());
+    T input;
+    for(int i=0;i<size;++i)
+        input.set(i, std::max(-limit, std::min(limit, value(rng))));
+    Softmax<T, size> softmax;
+    T output = softmax.forward(input);
+    double max = input.get(0);
+    for(int i=1;i<size;++i)
+        max = std::max(max, input.get(i));
+    double total = 0;
+    for(int i=0;i<size;++i)
+        total += std::exp(input.get(i)-max);
+    double step = Body::eps()/std::min(1.0, (double)Body::sup());
+    int failures = 0;
+    double sum = 0;
+    for(int i=0;i<size;++i) {
+        double expected = std::exp(input.get(i)-max)/total;
+        sum += output.get(i);
+        if(std::abs(output.get(i)-expected)>2*step+expected*SOFTMAX_RANGE*step && failures++<5)
+            printf("%s spread %g lane %d: %g instead of %g\n", name, spread, i, output.get(i), expected);
+        if(expected>4*step && output.get(i)<=0 && failures++<5)
+            printf("%s spread %g lane %d: no probability instead of %g\n", name, spread, i, expected);
+    }
+    for(int i=size;i<output.size();++i)
+        if(output.get(i)!=0 && failures++<5)
+            printf("%s lane %d beyond the size: %g\n", name, i, output.get(i));
+    if(std::abs(sum-1)>2*step+size*step/2 && failures++<5)
+        printf("%s spread %g: probabilities sum to %g\n", name, spread, sum);
+    return failures;
+}
+
+template <typename T, typename Body>
+int check(const char *name) {
+    int failures = 0;
+    for(int round=0;round<10;++round)
+        for(double spread : {0.3, 1.0}) {
+            failures += compare<T, Body, 10>(name, spread);
+            failures += compare<T, Body, 40>(name, spread);
+        }
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+// Dynamic differences beyond the range of the lookup table are clamped to its lowest weight
+template <typename T, typename Body>
+int checkWide(const char *name) {
+    int failures = 0;
+    for(int round=0;round<10;++round)
+        failures += compare<T, Body, 10>(name, 6.0);
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += check<sfloat9, sfloat9>("sfloat9");
+    failures += check<sfloat7, sfloat7>("sfloat7");
+    failures += check<dfloat10, sfloat9>("dfloat10");
+    failures += check<dfloat7, sfloat7>("dfloat7");
+    failures += checkWide<dfloat10, sfloat9>("dfloat10");
+    failures += check<float8, sfloat4>("float8");
+    failures += check<float10, sfloat6>("float10");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,77 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// SparseDense outputs against its biases plus its weights times the input values returned by get(), for sparse
+// enough weights that every row is summed lane by lane, before and after training.
+
+using namespace tensorless;
+
+std::mt19937_64 rng(29);
+
+template <typename T>
+T randomInput() {
+    std::uniform_real_distribution<double> value(-0.5, 0.5);
+    T ret;
+    for(int j=0;j<64;++j)
+        ret.set(j, value(rng));
+    return ret;
+}
+
+// lane-wise rows add the products of get() values in lane order, so setting the same sums in the same order
+// must reproduce the output exactly
+template <typename T, typename Layer>
+int compare(const char *name, const char *stage, Layer &layer, const T &input) {
+    int failures = 0;
+    T output = layer.forward(input);
+    T expected;
+    for(int i=0;i<128;++i) {
+        double sum = layer.bias(i);
+        int nonzeros = 0;
+        for(int j=0;j<64;++j) {
+            double weight = layer.weight(i, j);
+            if(weight==0)
+                continue;
+            sum += weight*input.get(j);
+            nonzeros++;
+        }
+        if(nonzeros>SPARSEDENSE_LANEWISE_NONZEROS && failures++<5)
+            printf("%s output %d %s: %d nonzeros are too many for lane-wise sums\n", name, i, stage, nonzeros);
+        if(sum>0) // relu
+            expected.set(i, sum);
+    }
+    for(int i=0;i<128;++i)
+        if(output.get(i)!=expected.get(i) && failures++<5)
+            printf("%s output %d %s: %g instead of %g\n", name, i, stage, output.get(i), expected.get(i));
+    return failures;
+}
+
+// backward updates the packed weights, which lane-wise rows copy
+template <typename T>
+int check(const char *name) {
+    int failures = 0;
+    for(double density : {0.02, 0.05, 0.1}) {
+        SparseDense<T, 64, 128> layer(density);
+        T input = randomInput<T>();
+        failures += compare(name, "before training", layer, input);
+        SGD<T> optimizer(0.5);
+        T error = randomInput<T>();
+        for(int step=0;step<5;++step) {
+            layer.forward(input);
+            layer.backward(error, optimizer);
+        }
+        failures += compare(name, "after training", layer, input);
+        failures += compare(name, "on new inputs", layer, randomInput<T>());
+    }
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += check<dfloat9>("dfloat9");
+    failures += check<float12>("float12");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,73 @@
+#define TELEMETRY
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// Layered telemetry of one model shared by several threads against the counters of the same passes run on one
+// thread: every pass must be counted once, whichever thread ran it.
+
+using namespace tensorless;
+
+#define THREADS 4
+#define PASSES 200000
+
+// stateless, so that threads can share it, and overflows in the lanes whose inputs exceed half the range
+template <typename T>
+class Doubler: public Neural<T> {
+public:
+    virtual T forward(const T &input) {
+        return input+input;
+    }
+    virtual T backward(const T &error, Optimizer<T> &optimizer) {
+        return error;
+    }
+    virtual void zerograd() {
+    }
+    virtual std::string describe() const {
+        return "Doubler\n";
+    }
+};
+
+template <typename T>
+int check(const char *name) {
+    int failures = 0;
+    Layered<T> model;
+    model.add(std::make_shared<Doubler<T>>()).add(std::make_shared<Doubler<T>>());
+    T input;
+    for(int i=0;i<input.size();++i)
+        input.set(i, i%3 ? 0.75*T::sup() : 0.1);
+    for(int pass=0;pass<PASSES;++pass)
+        model.forward(input);
+    std::vector<Telemetry> single = model.layerTelemetry();
+    if(single[0].overflows==0 && failures++<5)
+        printf("%s: no overflows counted\n", name);
+    model.resetTelemetry();
+    std::vector<std::thread> threads;
+    for(int t=0;t<THREADS;++t)
+        threads.emplace_back([&]() {
+            for(int pass=0;pass<PASSES;++pass)
+                model.forward(input);
+        });
+    for(std::thread &thread : threads)
+        thread.join();
+    std::vector<Telemetry> shared = model.layerTelemetry();
+    for(int layer=0;layer<model.num_layers();++layer) {
+        if(shared[layer].overflows!=THREADS*single[layer].overflows && failures++<5)
+            printf("%s layer %d: %lld overflows instead of %lld\n", name, layer, shared[layer].overflows, THREADS*single[layer].overflows);
+        if(shared[layer].lanes!=THREADS*single[layer].lanes && failures++<5)
+            printf("%s layer %d: %lld lanes instead of %lld\n", name, layer, shared[layer].lanes, THREADS*single[layer].lanes);
+        if(shared[layer].zeros!=THREADS*single[layer].zeros && failures++<5)
+            printf("%s layer %d: %lld zeros instead of %lld\n", name, layer, shared[layer].zeros, THREADS*single[layer].zeros);
+    }
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += check<sfloat9>("sfloat9");
+    failures += check<int5>("int5");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// TernaryDense outputs against 1/ins times the sum of the signs of the input values returned by get() above the
+// input threshold times the ternarized weights, before and after training, and the error it propagates against
+// the same sum of output errors, which must be zero for inputs beyond the straight-through clip.
+
+using namespace tensorless;
+
+#define INS 64
+#define OUTS 100
+
+std::mt19937_64 rng(47);
+
+#define INPUT_THRESHOLD 0.1
+
+template <typename T>
+T randomInput(double scale) {
+    std::uniform_real_distribution<double> value(-scale, scale);
+    T ret;
+    // inputs within a step of the threshold compare against its rounded broadcast, so none are drawn there
+    for(int j=0;j<INS;++j) {
+        double lane = value(rng);
+        while(std::abs(std::abs(lane)-INPUT_THRESHOLD)<0.02)
+            lane = value(rng);
+        ret.set(j, lane);
+    }
+    return ret;
+}
+
+// outputs are multiples of 1/ins, so they must recover the count of agreeing signs less the disagreeing ones
+template <typename T, typename Layer>
+int compare(const char *name, const char *stage, Layer &layer, const T &input) {
+    int failures = 0;
+    T output = layer.forward(input);
+    for(int i=0;i<output.size();++i) {
+        int dot = 0;
+        for(int j=0;j<INS && i<OUTS;++j)
+            if(std::abs(input.get(j))>INPUT_THRESHOLD)
+                dot += (input.get(j)<0 ? -1 : 1)*layer.weight(i, j);
+        double expected = (double)dot/INS;
+        if(std::abs(output.get(i)-expected)>0.5/INS && failures++<5)
+            printf("%s output %d %s: %g instead of %g\n", name, i, stage, output.get(i), expected);
+    }
+    return failures;
+}
+
+template <typename T>
+int checkBackward(const char *name, TernaryDense<T, INS, OUTS> &layer, double clip, double tolerance) {
+    int failures = 0;
+    T input = randomInput<T>(2*clip);
+    layer.forward(input);
+    std::vector<double> errors(OUTS);
+    T error = randomInput<T>(0.5);
+    for(int i=0;i<OUTS;++i)
+        errors[i] = error.get(i);
+    double weights[OUTS][INS];
+    for(int i=0;i<OUTS;++i)
+        for(int j=0;j<INS;++j)
+            weights[i][j] = layer.weight(i, j);
+    SGD<T> optimizer(0.1);
+    T propagated = layer.backward(error, optimizer);
+    for(int j=0;j<INS;++j) {
+        double expected = 0;
+        if(std::abs(input.get(j))<=clip)
+            for(int i=0;i<OUTS;++i)
+                expected += errors[i]*weights[i][j]/INS;
+        if(std::abs(input.get(j))>clip && propagated.get(j)!=0 && failures++<5)
+            printf("%s input %d beyond the clip: error %g\n", name, j, propagated.get(j));
+        if(std::abs(propagated.get(j)-expected)>tolerance && failures++<5)
+            printf("%s input %d: error %g instead of %g\n", name, j, propagated.get(j), expected);
+    }
+    return failures;
+}
+
+// each output adds its error over ins rounded to a step of the type, which Signed types floor and Dynamic sums
+// round to a step of their growing mantisa
+template <typename T>
+int check(const char *name, double tolerance) {
+    int failures = 0;
+    TernaryDense<T, INS, OUTS> layer(0.25, INPUT_THRESHOLD, 0.5);
+    T input = randomInput<T>(1);
+    failures += compare(name, "before training", layer, input);
+    for(int step=0;step<5;++step)
+        failures += checkBackward(name, layer, 0.5, tolerance);
+    failures += compare(name, "after training", layer, input);
+    failures += compare(name, "on new inputs", layer, randomInput<T>(1));
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += check<sfloat9>("sfloat9", OUTS*sfloat9::eps());
+    failures += check<dfloat10>("dfloat10", 0.1);
+    failures += check<float12>("float12", 0.05);
+    return failures ? 1 : 0;
+}
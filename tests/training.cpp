@@ -0,0 +1,210 @@
+#include "../tensorless/types/all.h"
+#include "../tensorless/layers/all.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// Optimizer updates, error propagation through Layered and mini-batch steps of Trainer, against the values
+// returned by get().
+
+using namespace tensorless;
+
+std::mt19937_64 rng(17);
+
+template <typename T>
+T randomLanes(double low, double high) {
+    std::uniform_real_distribution<double> value(low, high);
+    T ret;
+    for(int i=0;i<ret.size();++i)
+        ret.set(i, value(rng)*(rng()%2 ? -1 : 1));
+    return ret;
+}
+
+// errors point towards lower losses, so SGD adds lr times the error to each lane
+template <typename T>
+int checkSGD(const char *name) {
+    int failures = 0;
+    SGD<T> optimizer(0.5);
+    for(int round=0;round<20;++round) {
+        T param = randomLanes<T>(0, 0.5);
+        T grads = randomLanes<T>(0.25, 0.5);
+        T updated = param;
+        optimizer.update(updated, grads);
+        for(int i=0;i<param.size();++i) {
+            double step = updated.get(i)-param.get(i);
+            double expected = 0.5*grads.get(i);
+            if((step*expected<=0 || std::abs(step-expected)>std::abs(expected)/2) && failures++<5)
+                printf("%s SGD lane %d: %g moves by %g instead of %g\n", name, i, param.get(i), step, expected);
+        }
+    }
+    double scalar = 1;
+    optimizer.update(scalar, 0.25, 2);
+    if(scalar!=1.25 && failures++<5)
+        printf("%s SGD scalar: %g instead of 1.25\n", name, scalar);
+    return failures;
+}
+
+// runs an optimizer for a number of steps on random gradients next to a double implementation fed with the
+// values of the same gradients, where reference(lane state, gradient, step) returns the lane's step; each step
+// may differ by a step of the parameter, where it is rounded, and by a fraction of its size, from rounding the
+// optimizer state
+template <typename T, typename Optimizer, typename Reference>
+int compareSteps(const char *name, const char *method, Optimizer &optimizer, Reference reference) {
+    int failures = 0;
+    T param = randomLanes<T>(0, 0.5);
+    std::vector<std::vector<double>> states(param.size(), std::vector<double>(2, 0));
+    for(int step=1;step<=20;++step) {
+        T grads = randomLanes<T>(0.05, 0.2);
+        T updated = param;
+        optimizer.update(updated, grads);
+        for(int i=0;i<param.size();++i) {
+            double expected = reference(states[i], grads.get(i), step);
+            double moved = updated.get(i)-param.get(i);
+            if(std::abs(moved-expected)>0.02+0.2*std::abs(expected) && failures++<5)
+                printf("%s %s step %d lane %d: %g moves by %g instead of %g\n", name, method, step, i, param.get(i), moved, expected);
+        }
+        param = updated;
+    }
+
+    // a parameter that no longer holds the value the optimizer wrote restarts, as if the optimizer were new
+    T moved = randomLanes<T>(0, 0.5);
+    T grads = randomLanes<T>(0.05, 0.2);
+    T fresh = moved;
+    Optimizer other = optimizer;
+    other.reset();
+    other.update(fresh, grads);
+    optimizer.update(moved, grads);
+    for(int i=0;i<moved.size();++i)
+        if(moved.get(i)!=fresh.get(i) && failures++<5)
+            printf("%s %s lane %d: overwritten parameter moves to %g instead of restarting at %g\n", name, method, i, moved.get(i), fresh.get(i));
+    return failures;
+}
+
+// velocities are undamped sums, so steps grow to lr/(1-beta) times a steady gradient
+template <typename T>
+int checkMomentum(const char *name) {
+    Momentum<T> optimizer(0.05, 0.9);
+    auto reference = [](std::vector<double> &state, double grad, int step) {
+        state[0] = 0.9*state[0]+grad;
+        return 0.05*state[0];
+    };
+    int failures = compareSteps<T>(name, "Momentum", optimizer, reference);
+    double scalar = 1;
+    optimizer.update(scalar, 0.25);
+    optimizer.update(scalar, 0.25);
+    if(std::abs(scalar-(1+0.05*0.25+0.05*0.475))>1.E-12 && failures++<5)
+        printf("%s Momentum scalar: %g instead of %g\n", name, scalar, 1+0.05*0.25+0.05*0.475);
+    return failures;
+}
+
+// steps are about lr per lane, and the second moment is damped, so gradients near the top of the range do
+// not saturate it
+template <typename T>
+int checkAdam(const char *name) {
+    Adam<T> optimizer(0.02);
+    auto reference = [](std::vector<double> &state, double grad, int step) {
+        state[0] = 0.9*state[0]+0.1*grad;
+        state[1] = 0.999*state[1]+0.001*grad*grad;
+        return 0.02*state[0]/(1-std::pow(0.9, step))/std::sqrt(state[1]/(1-std::pow(0.999, step)));
+    };
+    int failures = compareSteps<T>(name, "Adam", optimizer, reference);
+    T param;
+    T grads = T::broadcast(std::min(1.5, 0.9*T::sup()));
+    for(int step=0;step<20;++step)
+        optimizer.update(param, grads);
+    for(int i=0;i<param.size();++i)
+        if(std::abs(param.get(i)-0.4)>0.1 && failures++<5)
+            printf("%s Adam lane %d: steady large gradients move by %g instead of 0.4\n", name, i, param.get(i));
+    return failures;
+}
+
+// passes values through and keeps the last error it received
+template <typename T>
+class Recorder: public Neural<T> {
+public:
+    T received;
+    virtual T forward(const T &input) {return input;}
+    virtual T backward(const T &error, Optimizer<T> &optimizer) {received = error; return error;}
+    virtual void zerograd() {}
+    virtual std::string describe() const {return "Recorder\n";}
+};
+
+// Layered::backward hands the given error to its last layer and returns what the first one propagates
+template <typename T>
+int checkLayered(const char *name) {
+    int failures = 0;
+    auto first = std::make_shared<Recorder<T>>();
+    auto last = std::make_shared<Recorder<T>>();
+    Layered<T> model;
+    model.add(first).add(last);
+    SGD<T> optimizer(0.5);
+    T error = randomLanes<T>(0.25, 0.5);
+    T propagated = model.backward(error, optimizer);
+    for(int i=0;i<error.size();++i)
+        if((last->received.get(i)!=error.get(i) || first->received.get(i)!=error.get(i) || propagated.get(i)!=error.get(i)) && failures++<5)
+            printf("%s Layered lane %d: error %g reaches the layers as %g and %g and returns %g\n",
+                   name, i, error.get(i), last->received.get(i), first->received.get(i), propagated.get(i));
+    return failures;
+}
+
+// adds a trainable bias, whose gradient is the error itself
+template <typename T>
+class Shift: public Neural<T> {
+public:
+    T bias;
+    virtual T forward(const T &input) {return input+bias;}
+    virtual T backward(const T &error, Optimizer<T> &optimizer) {optimizer.update(bias, error); return error;}
+    virtual void zerograd() {}
+    virtual std::string describe() const {return "Shift\n";}
+};
+
+// one batched step moves parameters by the mean of the per-sample steps, also for batches whose summed
+// gradients exceed the range of the type and whose mean is below one step when divided as a broadcast
+template <typename T>
+int checkTrainer(const char *name) {
+    int failures = 0;
+    for(int threads : {1, 3})
+        for(int batch : {4, 100, 300}) {
+            SGD<T> optimizer(0.5);
+            Trainer<T> trainer([]() {return std::make_shared<Shift<T>>();}, optimizer, threads);
+            std::vector<T> inputs(batch);
+            std::vector<T> targets;
+            for(int i=0;i<batch;++i)
+                targets.push_back(randomLanes<T>(0.05, 0.15));
+            std::vector<double> expected(T().size(), 0);
+            for(int i=0;i<batch;++i) {
+                T param;
+                optimizer.update(param, targets[i]);
+                for(int lane=0;lane<param.size();++lane)
+                    expected[lane] += param.get(lane)/batch;
+            }
+            trainer.step(inputs, targets);
+            const T &bias = std::dynamic_pointer_cast<Shift<T>>(trainer.model())->bias;
+            // rounding the mean and halving it lose about a step of sfloat9 each
+            for(int lane=0;lane<bias.size();++lane)
+                if(std::abs(bias.get(lane)-expected[lane])>0.016 && failures++<5)
+                    printf("%s Trainer with %d threads, batch %d, lane %d: %g instead of %g\n",
+                           name, threads, batch, lane, bias.get(lane), expected[lane]);
+        }
+    return failures;
+}
+
+template <typename T>
+int check(const char *name) {
+    int failures = 0;
+    failures += checkSGD<T>(name);
+    failures += checkMomentum<T>(name);
+    failures += checkAdam<T>(name);
+    failures += checkLayered<T>(name);
+    failures += checkTrainer<T>(name);
+    printf("%-8s %s\n", name, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+int main() {
+    int failures = 0;
+    failures += check<sfloat9>("sfloat9");
+    failures += check<dfloat10>("dfloat10");
+    failures += check<float12>("float12");
+    return failures ? 1 : 0;
+}